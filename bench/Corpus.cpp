@@ -0,0 +1,220 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Corpus.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "Corpus.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-cpp/Exception.hpp"
+
+
+namespace {
+
+using clangxx::bench::CorpusOptions;
+
+/*!
+  Writes the contents of one file.  Only the raw output of std::mt19937
+  is used: the standard distributions differ between libraries, which
+  would make the corpus differ between platforms.
+*/
+class FileWriter
+{
+  private:
+	const CorpusOptions	&m_options;
+	std::mt19937		&m_random;
+	const std::string	m_prefix;
+	std::ostringstream	m_out;
+	std::size_t			m_functions{0};
+	//! first function of the innermost scope being written; calls stay within it.
+	std::size_t			m_scope_functions{0};
+
+  public:
+	FileWriter(const CorpusOptions &options, std::mt19937 &random, std::string prefix)
+		: m_options(options)
+		, m_random(random)
+		, m_prefix(std::move(prefix))
+	{}
+
+  public:
+	std::string write(const std::vector<std::string> &includes, bool is_header) {
+		if ( is_header ) {
+			m_out << "#pragma once\n";
+		}
+		for ( const auto &include : includes ) {
+			m_out << "#include \"" << include << "\"\n";
+		}
+		m_out << '\n';
+
+		std::size_t remaining = m_options.declarations;
+		std::size_t scope = 0;
+		while ( remaining > 0 ) {
+			const std::size_t count = std::min<std::size_t>(remaining, 1 + uniform(16));
+			write_scope(m_prefix + "_n" + std::to_string(scope++), m_options.depth, count);
+			remaining -= count;
+		}
+		return m_out.str();
+	}
+
+  private:
+	std::uint32_t uniform(std::uint32_t bound) {
+		return bound ? static_cast<std::uint32_t>(m_random() % bound) : 0;
+	}
+
+	std::string indent(std::size_t level) const {
+		return std::string(m_options.depth - level, '\t');
+	}
+
+	void write_scope(const std::string &name, std::size_t level, std::size_t declarations) {
+		if ( level == 0 ) {
+			m_scope_functions = m_functions;
+			for ( std::size_t i = 0; i < declarations; ++i ) {
+				write_declaration(name, i);
+			}
+			return;
+		}
+		m_out << indent(level) << "namespace " << name << " {\n";
+		write_scope(name + "_" + std::to_string(level), level - 1, declarations);
+		m_out << indent(level) << "} // namespace " << name << "\n";
+	}
+
+	void write_declaration(const std::string &scope, std::size_t index) {
+		const std::string tab(indent(0));
+		const std::string name(scope + "_d" + std::to_string(index));
+		switch ( uniform(4) ) {
+		  case 0:
+			m_out << tab << "struct " << name << " {\n"
+				  << tab << "\tint m_value;\n"
+				  << tab << "\tdouble m_ratio[" << 1 + uniform(8) << "];\n"
+				  << tab << "\tvirtual ~" << name << "() {}\n"
+				  << tab << "\tvirtual int get() const { return m_value * " << uniform(100) << "; }\n"
+				  << tab << "\tstatic " << name << " make(int value) { " << name << " r{}; r.m_value = value; return r; }\n"
+				  << tab << "};\n";
+			break;
+		  case 1:
+			m_out << tab << "template<typename T, int N = " << uniform(10) << ">\n"
+				  << tab << "struct " << name << " {\n"
+				  << tab << "\tT m_items[N + 1];\n"
+				  << tab << "\tT sum() const { T s{}; for ( int i = 0; i <= N; ++i ) { s += m_items[i]; } return s; }\n"
+				  << tab << "};\n";
+			break;
+		  case 2:
+			m_out << tab << "enum class " << name << " { A, B = " << uniform(50) << ", C };\n";
+			break;
+		  default: {
+			const std::size_t function = m_functions++;
+			m_out << tab << "inline int " << m_prefix << "_f" << function << "(int x) {\n";
+			if ( function > m_scope_functions ) {
+				const std::size_t callee = m_scope_functions
+					+ uniform(static_cast<std::uint32_t>(function - m_scope_functions));
+				m_out << tab << "\tif ( x > " << uniform(1000) << " ) { return "
+					  << m_prefix << "_f" << callee << "(x - 1) + 1; }\n";
+			}
+			m_out << tab << "\treturn x * " << 1 + uniform(9) << ";\n"
+				  << tab << "}\n";
+			break;
+		  }
+		}
+	}
+}; // class FileWriter
+
+void write_file(const std::string &path, const std::string &contents)
+{
+	std::ofstream ostream(path, std::ios::binary | std::ios::trunc);
+	if ( !ostream || !ostream.write(contents.data(), contents.size()) ) {
+		CLANGXX_THROW_RuntimeError("Error writing " + path);
+	}
+}
+
+/*!
+  Writes the tree of headers, the deepest level first so that every
+  include exists.
+  @return the names of the top-level headers.
+*/
+std::vector<std::string> write_headers(const std::string &directory, const CorpusOptions &options,
+									   std::mt19937 &random, clangxx::bench::Corpus &corpus)
+{
+	std::vector<std::string> level_names;
+	for ( std::size_t level = options.include_depth; level > 0; --level ) {
+		std::vector<std::string> names;
+		for ( std::size_t i = 0; i < options.fanout; ++i ) {
+			const std::string stem("h" + std::to_string(level) + "_" + std::to_string(i));
+			std::vector<std::string> includes;
+			// each header includes a rotation of the level below
+			for ( std::size_t j = 0; j < level_names.size(); ++j ) {
+				includes.push_back(level_names[(i + j) % level_names.size()]);
+			}
+			const std::string contents(FileWriter(options, random, stem).write(includes, true));
+			const std::string path(directory + "/" + stem + ".hpp");
+			write_file(path, contents);
+			corpus.files.push_back(path);
+			corpus.bytes += contents.size();
+			names.push_back(stem + ".hpp");
+		}
+		level_names.swap(names);
+	}
+	return level_names;
+}
+
+} // namespace
+
+namespace clangxx {
+namespace bench {
+
+Corpus Corpus::generate(const std::string &directory, const CorpusOptions &options)
+{
+	std::mt19937 random(options.seed);
+	Corpus corpus;
+	corpus.bytes = 0;
+	const std::vector<std::string> includes(write_headers(directory, options, random, corpus));
+
+	const std::string contents(FileWriter(options, random, "m").write(includes, false));
+	corpus.main_file = directory + "/main.cpp";
+	write_file(corpus.main_file, contents);
+	corpus.sources.push_back(corpus.main_file);
+	corpus.files.push_back(corpus.main_file);
+	corpus.bytes += contents.size();
+	return corpus;
+}
+
+Corpus Corpus::generate_batch(const std::string &directory, const CorpusOptions &options,
+							  std::size_t count)
+{
+	std::mt19937 random(options.seed);
+	Corpus corpus;
+	corpus.bytes = 0;
+	const std::vector<std::string> headers(write_headers(directory, options, random, corpus));
+
+	for ( std::size_t i = 0; i < count; ++i ) {
+		const std::string stem("tu" + std::to_string(i));
+		CorpusOptions tu_options(options);
+		tu_options.declarations *= 1 + random() % 8;
+		// a rotation of 1 to all of the top-level headers
+		std::vector<std::string> includes;
+		const std::size_t include_count = headers.empty() ? 0 : 1 + random() % headers.size();
+		for ( std::size_t j = 0; j < include_count; ++j ) {
+			includes.push_back(headers[(i + j) % headers.size()]);
+		}
+
+		const std::string contents(FileWriter(tu_options, random, stem).write(includes, false));
+		const std::string path(directory + "/" + stem + ".cpp");
+		write_file(path, contents);
+		corpus.sources.push_back(path);
+		corpus.files.push_back(path);
+		corpus.bytes += contents.size();
+	}
+	corpus.main_file = corpus.sources.empty() ? std::string() : corpus.sources.front();
+	return corpus;
+}
+
+} // namespace bench
+} // namespace clangxx
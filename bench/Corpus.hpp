@@ -0,0 +1,61 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Corpus.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_bench_Corpus_hpp
+#define clang_cpp_bench_Corpus_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace clangxx {
+namespace bench {
+
+struct CorpusOptions
+{
+	//! declarations per file.
+	std::size_t		declarations{200};
+	//! nesting of namespaces around the declarations.
+	std::size_t		depth{3};
+	//! headers included by each file.
+	std::size_t		fanout{4};
+	//! levels of headers below the main file.
+	std::size_t		include_depth{2};
+	std::uint32_t	seed{1};
+}; // struct CorpusOptions
+
+/*!
+  Synthetic translation unit: a main file including a tree of headers,
+  each holding nested namespaces, classes, templates and functions that
+  call each other.  The same options and seed always give the same files.
+*/
+struct Corpus
+{
+	std::string					main_file;
+	//! the main files: main_file alone, or those of a batch.
+	std::vector<std::string>	sources;
+	std::vector<std::string>	files;
+	std::size_t					bytes;
+
+	//! Writes the corpus into the existing directory @a directory.
+	static Corpus generate(const std::string &directory, const CorpusOptions &options);
+
+	/*!
+	  Writes @a count main files sharing the headers of generate().  Each
+	  includes a different subset of the top-level headers and holds 1 to 8
+	  times @a options.declarations, so that their parse times differ.
+	*/
+	static Corpus generate_batch(const std::string &directory, const CorpusOptions &options,
+								 std::size_t count);
+}; // struct Corpus
+
+} // namespace bench
+} // namespace clangxx
+
+
+#endif // clang_cpp_bench_Corpus_hpp
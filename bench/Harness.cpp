@@ -0,0 +1,120 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Harness.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "Harness.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+void write_json_string(std::ostream &ostream, const std::string &string)
+{
+	static const char hex[] = "0123456789abcdef";
+	ostream << '"';
+	for ( const char c : string ) {
+		const unsigned char u = static_cast<unsigned char>(c);
+		if ( c == '"' || c == '\\' ) {
+			ostream << '\\' << c;
+		}
+		else if ( u < 0x20 ) {
+			ostream << "\\u00" << hex[u >> 4] << hex[u & 0xf];
+		}
+		else {
+			ostream << c;
+		}
+	}
+	ostream << '"';
+}
+
+} // namespace
+
+namespace clangxx {
+namespace bench {
+
+void Harness::run(const std::string &name, const Setup &setup, const Body &body)
+{
+	if ( !selected(name) ) {
+		return;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	std::vector<std::int64_t> times;
+	times.reserve(m_repetitions);
+	std::size_t items = 0;
+	for ( std::size_t i = 0; i <= m_repetitions; ++i ) {
+		if ( setup ) {
+			setup();
+		}
+		const auto begin = Clock::now();
+		items = body();
+		const auto end = Clock::now();
+		// the first run is a warm-up
+		if ( i > 0 ) {
+			times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+	Result result;
+	result.name = name;
+	result.repetitions = times.size();
+	result.items = items;
+	result.min_nanoseconds = times.front();
+	result.median_nanoseconds = times[times.size() / 2];
+	result.mean_nanoseconds = std::accumulate(times.begin(), times.end(), std::int64_t(0))
+		/ static_cast<std::int64_t>(times.size());
+	result.max_nanoseconds = times.back();
+	m_results.push_back(result);
+}
+
+void Harness::write_text(std::ostream &ostream) const
+{
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-36s %12s %12s %12s %10s\n",
+				  "benchmark", "median us", "min us", "max us", "items");
+	ostream << line;
+	for ( const auto &result : m_results ) {
+		std::snprintf(line, sizeof(line), "%-36s %12.1f %12.1f %12.1f %10zu\n",
+					  result.name.c_str(), result.median_nanoseconds / 1e3,
+					  result.min_nanoseconds / 1e3, result.max_nanoseconds / 1e3, result.items);
+		ostream << line;
+	}
+}
+
+void Harness::write_json(std::ostream &ostream,
+						 const std::vector<std::pair<std::string, std::string>> &context) const
+{
+	ostream << "{\n  \"context\": {";
+	for ( std::size_t i = 0; i < context.size(); ++i ) {
+		ostream << (i ? ", " : "");
+		write_json_string(ostream, context[i].first);
+		ostream << ": ";
+		write_json_string(ostream, context[i].second);
+	}
+	ostream << "},\n  \"benchmarks\": [";
+	for ( std::size_t i = 0; i < m_results.size(); ++i ) {
+		const Result &result = m_results[i];
+		ostream << (i ? "," : "") << "\n    {\"name\": ";
+		write_json_string(ostream, result.name);
+		ostream << ", \"repetitions\": " << result.repetitions
+				<< ", \"items\": " << result.items
+				<< ", \"min_ns\": " << result.min_nanoseconds
+				<< ", \"median_ns\": " << result.median_nanoseconds
+				<< ", \"mean_ns\": " << result.mean_nanoseconds
+				<< ", \"max_ns\": " << result.max_nanoseconds << '}';
+	}
+	ostream << "\n  ]\n}\n";
+}
+
+} // namespace bench
+} // namespace clangxx
@@ -0,0 +1,85 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Harness.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_bench_Harness_hpp
+#define clang_cpp_bench_Harness_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace clangxx {
+namespace bench {
+
+struct Result
+{
+	std::string		name;
+	std::size_t		repetitions;
+	//! items processed by one repetition (cursors, kinds, bytes...).
+	std::size_t		items;
+	std::int64_t	min_nanoseconds;
+	std::int64_t	median_nanoseconds;
+	std::int64_t	mean_nanoseconds;
+	std::int64_t	max_nanoseconds;
+}; // struct Result
+
+/*!
+  Runs each benchmark once to warm up, then @a repetitions times, and
+  keeps the distribution of the wall times.  The body returns the number
+  of items it processed.
+*/
+class Harness
+{
+  public:
+	using Setup	= std::function<void()>;
+	using Body	= std::function<std::size_t()>;
+
+  private:
+	const std::string	m_filter;
+	const std::size_t	m_repetitions;
+	std::vector<Result>	m_results;
+
+  public:
+	//! @param filter	only the benchmarks whose name contains it run.
+	Harness(std::string filter, std::size_t repetitions)
+		: m_filter(std::move(filter))
+		, m_repetitions(repetitions ? repetitions : 1)
+	{}
+
+  public:
+	//! @return whether a benchmark named @a name would run.
+	bool selected(const std::string &name) const {
+		return name.find(m_filter) != std::string::npos;
+	}
+
+	//! Runs @a body, calling @a setup untimed before each repetition.
+	void run(const std::string &name, const Setup &setup, const Body &body);
+
+	void run(const std::string &name, const Body &body) {
+		run(name, Setup(), body);
+	}
+
+	const std::vector<Result> &results() const noexcept {
+		return m_results;
+	}
+
+	void write_text(std::ostream &ostream) const;
+
+	//! @param context	string fields describing the run (corpus, options...).
+	void write_json(std::ostream &ostream,
+					const std::vector<std::pair<std::string, std::string>> &context) const;
+}; // class Harness
+
+} // namespace bench
+} // namespace clangxx
+
+
+#endif // clang_cpp_bench_Harness_hpp
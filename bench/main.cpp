@@ -0,0 +1,335 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file main.cpp
+
+   Copyright (c) 2015 pegacorn
+
+   clang++-bench: micro- and macro-benchmarks of the library over a
+   synthetic corpus.
+
+   usage: clang++-bench [--filter TEXT] [--repetitions N] [--json PATH]
+                        [--corpus-dir DIR] [--declarations N] [--depth N]
+                        [--fanout N] [--include-depth N] [--seed N]
+                        [--batch N] [--threads N]
+
+   --batch sets the translation units of the BatchParser benchmarks, and
+   --threads their workers (0: one per hardware thread).
+*/
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/BatchParser.hpp"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/CursorKind.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/ParseProfile.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+#include "clang-cpp/UnsavedFile.hpp"
+#include "Corpus.hpp"
+#include "Harness.hpp"
+#if defined _WIN32
+	#include <direct.h>
+#else
+	#include <sys/stat.h>
+#endif
+
+using namespace clangxx;
+using namespace std;
+
+
+namespace {
+
+struct Options
+{
+	string				filter;
+	size_t				repetitions{10};
+	string				json_path;
+	string				corpus_dir{"clang++-bench-corpus"};
+	bench::CorpusOptions	corpus;
+	size_t				batch{24};
+	unsigned int		threads{0};
+}; // struct Options
+
+Options parse_options(int argc, char *argv[])
+{
+	Options options;
+	for ( int i = 1; i < argc; ++i ) {
+		const string arg(argv[i]);
+		if ( i + 1 >= argc ) {
+			throw invalid_argument("missing value for " + arg);
+		}
+		const string value(argv[++i]);
+		const auto number = [&value]() { return static_cast<size_t>(stoul(value)); };
+		if ( arg == "--filter" ) {
+			options.filter = value;
+		}
+		else if ( arg == "--repetitions" ) {
+			options.repetitions = number();
+		}
+		else if ( arg == "--json" ) {
+			options.json_path = value;
+		}
+		else if ( arg == "--corpus-dir" ) {
+			options.corpus_dir = value;
+		}
+		else if ( arg == "--declarations" ) {
+			options.corpus.declarations = number();
+		}
+		else if ( arg == "--depth" ) {
+			options.corpus.depth = number();
+		}
+		else if ( arg == "--fanout" ) {
+			options.corpus.fanout = number();
+		}
+		else if ( arg == "--include-depth" ) {
+			options.corpus.include_depth = number();
+		}
+		else if ( arg == "--seed" ) {
+			options.corpus.seed = static_cast<uint32_t>(number());
+		}
+		else if ( arg == "--batch" ) {
+			options.batch = number();
+		}
+		else if ( arg == "--threads" ) {
+			options.threads = static_cast<unsigned int>(number());
+		}
+		else {
+			throw invalid_argument("unknown option " + arg);
+		}
+	}
+	return options;
+}
+
+void make_directory(const string &path)
+{
+#if defined _WIN32
+	const int result = _mkdir(path.c_str());
+#else
+	const int result = mkdir(path.c_str(), 0755);
+#endif
+	if ( result != 0 && errno != EEXIST ) {
+		throw runtime_error("cannot create " + path + ": " + strerror(errno));
+	}
+}
+
+string clang_version()
+{
+	UniqueCXString cx_string(clang_getClangVersion());
+	return cx_string ? clang_getCString(cx_string.get()) : string();
+}
+
+vector<UnsavedFile> unsaved_file(const string &filename, const string &contents)
+{
+	vector<UnsavedFile> unsaved_files(1);
+	unsaved_files[0].filename = filename;
+	unsaved_files[0].contents.reset(new istringstream(contents));
+	return unsaved_files;
+}
+
+size_t count_cursors(const Cursor &root)
+{
+	size_t count = 0;
+	root.visit_children([&count](const Cursor &/*cursor*/, const Cursor &/*parent*/) {
+		++count;
+		return CXChildVisit_Recurse;
+	});
+	return count;
+}
+
+size_t count_parsed(const vector<ParseResult> &results)
+{
+	size_t count = 0;
+	for ( const auto &result : results ) {
+		if ( result.translation_unit ) {
+			++count;
+		}
+	}
+	return count;
+}
+
+size_t count_children(const Cursor &cursor)
+{
+	size_t count = 0;
+	for ( const auto &child : cursor.get_children() ) {
+		count += 1 + count_children(child);
+	}
+	return count;
+}
+
+int run(const Options &options)
+{
+	make_directory(options.corpus_dir);
+	const auto corpus = bench::Corpus::generate(options.corpus_dir, options.corpus);
+	const vector<string> args{"-x", "c++", "-std=c++11"};
+	auto index = Index::create();
+	bench::Harness harness(options.filter, options.repetitions);
+	size_t sink = 0;
+
+	// micro-benchmarks
+
+	// the kinds are registered on demand, not at static initialization
+	CursorKind::s_initialize();
+	harness.run("CursorKind/from_id+name", [&sink]() {
+		size_t count = 0;
+		for ( const auto &kind : CursorKind::get_all_kinds() ) {
+			sink += CursorKind::from_id(kind.first).name().size();
+			++count;
+		}
+		return count;
+	});
+
+	{
+		const string filename(options.corpus_dir + "/unsaved.cpp");
+		ofstream(filename.c_str()) << "int unsaved;\n";
+		string contents;
+		while ( contents.size() < (1u << 20) ) {
+			contents += "// padding line to exercise UnsavedFile marshaling ...........\n";
+		}
+		contents += "int unsaved;\n";
+		const auto translation_unit = index->parse(filename, &args);
+		harness.run("UnsavedFile/reparse_1MiB", [&]() {
+			const auto unsaved_files = unsaved_file(filename, contents);
+			translation_unit->reparse(&unsaved_files);
+			return contents.size();
+		});
+	}
+
+	// macro-benchmarks
+
+	harness.run("TranslationUnit/parse", [&]() {
+		return count_cursors(index->parse(corpus.main_file, &args)->cursor()) ? corpus.bytes : 0;
+	});
+
+	if ( harness.selected("TranslationUnit/reparse") ) {
+		const auto plain = index->parse(corpus.main_file, &args);
+		harness.run("TranslationUnit/reparse", [&]() {
+			plain->reparse();
+			return corpus.bytes;
+		});
+
+		const auto with_preamble = index->parse(
+			corpus.main_file, &args, nullptr, CXTranslationUnit_PrecompiledPreamble);
+		harness.run("TranslationUnit/reparse_preamble", [&]() {
+			with_preamble->reparse();
+			return corpus.bytes;
+		});
+	}
+
+	const auto translation_unit = index->parse(corpus.main_file, &args);
+	const Cursor root(translation_unit->cursor());
+
+	harness.run("Cursor/visit_children", [&]() {
+		return count_cursors(root);
+	});
+
+	harness.run("Cursor/get_children", [&]() {
+		return count_children(root);
+	});
+
+	harness.run("Cursor/spelling+usr", [&]() {
+		size_t count = 0;
+		root.visit_children([&](const Cursor &cursor, const Cursor &/*parent*/) {
+			sink += cursor.spelling().size() + cursor.get_usr().size();
+			++count;
+			return CXChildVisit_Recurse;
+		});
+		return count;
+	});
+
+	/*
+	  Both schedules over a batch of translation units: cold starts each
+	  repetition from an empty ParseProfile, warm from the costs and include
+	  sets recorded by the previous repetitions.
+	*/
+	if ( harness.selected("BatchParser/") ) {
+		const string batch_dir(options.corpus_dir + "/batch");
+		make_directory(batch_dir);
+		const auto batch = bench::Corpus::generate_batch(batch_dir, options.corpus, options.batch);
+		vector<ParseJob> jobs(batch.sources.size());
+		for ( size_t i = 0; i < jobs.size(); ++i ) {
+			jobs[i].filename = batch.sources[i];
+			jobs[i].args = args;
+		}
+
+		const pair<const char *, BatchParser::Schedule> schedules[] = {
+			{"fifo", BatchParser::Schedule::Fifo},
+			{"locality", BatchParser::Schedule::Locality},
+		};
+		for ( const auto &schedule : schedules ) {
+			BatchParser parser(index, options.threads);
+			parser.set_schedule(schedule.second);
+			unique_ptr<ParseProfile> profile;
+			harness.run(string("BatchParser/") + schedule.first + "_cold", [&]() {
+				profile.reset(new ParseProfile());
+				parser.set_profile(profile.get());
+			}, [&]() {
+				return count_parsed(parser.parse(jobs));
+			});
+
+			profile.reset(new ParseProfile());
+			parser.set_profile(profile.get());
+			harness.run(string("BatchParser/") + schedule.first + "_warm", [&]() {
+				return count_parsed(parser.parse(jobs));
+			});
+		}
+	}
+
+	harness.write_text(cout);
+	if ( !options.json_path.empty() ) {
+		ofstream json(options.json_path.c_str());
+		harness.write_json(json, {
+			{"clang_version",	clang_version()},
+			{"declarations",	to_string(options.corpus.declarations)},
+			{"depth",			to_string(options.corpus.depth)},
+			{"fanout",			to_string(options.corpus.fanout)},
+			{"include_depth",	to_string(options.corpus.include_depth)},
+			{"seed",			to_string(options.corpus.seed)},
+			{"corpus_files",	to_string(corpus.files.size())},
+			{"corpus_bytes",	to_string(corpus.bytes)},
+			{"repetitions",		to_string(options.repetitions)},
+			{"batch",			to_string(options.batch)},
+			{"threads",			to_string(options.threads)},
+		});
+		if ( !json ) {
+			cerr << "clang++-bench: cannot write " << options.json_path << endl;
+			return 1;
+		}
+	}
+	// keeps the extracted strings from being optimized away
+	return sink == size_t(-1) ? 1 : 0;
+}
+
+} // namespace
+
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	try {
+		options = parse_options(argc, argv);
+	}
+	catch ( const exception &e ) {
+		cerr << "clang++-bench: " << e.what() << endl;
+		return 2;
+	}
+
+	try {
+		return run(options);
+	}
+	catch ( const exception &e ) {
+		cerr << "clang++-bench: " << e.what() << endl;
+		return 1;
+	}
+}
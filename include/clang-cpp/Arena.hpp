@@ -0,0 +1,152 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Arena.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Arena_hpp
+#define clang_cpp_Arena_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Monotonic bump allocator: memory is handed out from large blocks and
+  only given back all at once, by reset() or the destructor.
+
+  Meant for the intermediate results of one request or pass: allocate
+  them through ArenaAllocator, drop them, and reset().  Destructors of the
+  objects are not run by the arena; containers using it are destroyed
+  as usual, only their deallocations become no-ops.  Not thread-safe:
+  use one arena per thread.
+*/
+class CLANGXX_API Arena
+{
+  private:
+	struct Block
+	{
+		Block		*next;
+		std::size_t	size;
+	}; // struct Block
+
+  public:
+	static const std::size_t	default_block_size	= 64 * 1024;
+
+  private:
+	const std::size_t	m_initial_block_size;
+	std::size_t			m_next_block_size;
+	//! current block first, older blocks after it.
+	Block				*m_blocks{nullptr};
+	char				*m_position{nullptr};
+	char				*m_end{nullptr};
+	std::size_t			m_allocated{0};
+
+  public:
+	explicit Arena(std::size_t block_size = default_block_size);
+	~Arena();
+
+	Arena(const Arena &) = delete;
+	Arena &operator=(const Arena &) = delete;
+
+  public:
+	void *allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t)) {
+		const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(m_end);
+		const std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(m_position) + alignment - 1)
+			& ~std::uintptr_t(alignment - 1);
+		if ( m_position && aligned <= end && size <= end - aligned ) {
+			m_position = reinterpret_cast<char *>(aligned + size);
+			m_allocated += size;
+			return reinterpret_cast<void *>(aligned);
+		}
+		return allocate_block(size, alignment);
+	}
+
+	/*!
+	  Releases every allocation at once.  The current block, the largest,
+	  is kept for the next round; the older ones are freed.
+	*/
+	void reset() noexcept;
+
+	//! @return the bytes handed out since the last reset().
+	std::size_t allocated() const noexcept {
+		return m_allocated;
+	}
+
+	//! @return the bytes held in blocks.
+	std::size_t capacity() const noexcept;
+
+  private:
+	void *allocate_block(std::size_t size, std::size_t alignment);
+}; // class Arena
+
+//! Standard allocator drawing from an Arena; deallocate() does nothing.
+template<typename T>
+class ArenaAllocator
+{
+	template<typename U> friend class ArenaAllocator;
+
+  public:
+	using value_type	= T;
+
+	template<typename U>
+	struct rebind
+	{
+		using other	= ArenaAllocator<U>;
+	}; // struct rebind
+
+  private:
+	Arena	*m_arena;
+
+  public:
+	explicit ArenaAllocator(Arena &arena) noexcept
+		: m_arena(&arena)
+	{}
+
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+		: m_arena(other.m_arena)
+	{}
+
+  public:
+	T *allocate(std::size_t count) {
+		if ( count > std::numeric_limits<std::size_t>::max() / sizeof(T) ) {
+			throw std::bad_alloc();
+		}
+		return static_cast<T *>(m_arena->allocate(count * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T * /*pointer*/, std::size_t /*count*/) noexcept {
+	}
+
+	Arena &arena() const noexcept {
+		return *m_arena;
+	}
+
+	template<typename U>
+	bool operator==(const ArenaAllocator<U> &other) const noexcept {
+		return m_arena == other.m_arena;
+	}
+
+	template<typename U>
+	bool operator!=(const ArenaAllocator<U> &other) const noexcept {
+		return m_arena != other.m_arena;
+	}
+}; // class ArenaAllocator
+
+template<typename T>
+using ArenaVector	= std::vector<T, ArenaAllocator<T>>;
+
+using ArenaString	= std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Arena_hpp
@@ -0,0 +1,106 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file AstDumper.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_AstDumper_hpp
+#define clang_cpp_AstDumper_hpp
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+
+
+namespace clangxx {
+
+class TranslationUnit;
+
+/*!
+  Writes the AST of a translation unit as JSON while walking it, through a
+  fixed-size buffer; memory use grows with the depth of the tree, not its
+  size.
+
+  JSON is one nested object per node, children in a "children" array.
+  NDJSON is one object per line, in preorder, with "id", "parent" and
+  "depth" members.  Nodes whose kind is filtered out are not written; their
+  children are attached to the nearest written ancestor.
+*/
+class CLANGXX_API AstDumper
+{
+  public:
+	enum class Format
+	{
+		JSON,
+		NDJSON,
+	};
+
+	enum Field: unsigned int
+	{
+		Kind		= 1u << 0,
+		Spelling	= 1u << 1,
+		Location	= 1u << 2,
+		Type		= 1u << 3,
+		USR			= 1u << 4,
+		AllFields	= Kind | Spelling | Location | Type | USR,
+	};
+
+	struct Options
+	{
+		Format							format{Format::JSON};
+		unsigned int					fields{Kind | Spelling | Location};
+		//! if not empty, only nodes of these kinds are written.
+		std::unordered_set<int>			kinds;
+		TraversalOptions				traversal;
+		std::size_t						buffer_size{64 * 1024};
+	}; // struct Options
+
+	using Sink	= std::function<void(const char *data, std::size_t size)>;
+
+  public:
+	/*!
+	  Dumps @a translation_units[i] to @a paths[i], one translation unit per
+	  thread.
+	*/
+	static void dump(const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+					 const std::vector<std::string> &paths, const Options &options,
+					 unsigned int thread_count = 0);
+
+  private:
+	Options	m_options;
+
+  public:
+	AstDumper();
+	explicit AstDumper(Options options);
+	~AstDumper();
+
+	AstDumper(const AstDumper &other);
+	AstDumper(AstDumper &&other) noexcept;
+
+	AstDumper &operator=(const AstDumper &other);
+	AstDumper &operator=(AstDumper &&other) noexcept;
+
+  public:
+	const Options &options() const noexcept {
+		return m_options;
+	}
+
+	//! An exception thrown by @a sink stops the dump and is rethrown; output buffered so far is dropped.
+	void dump(const TranslationUnit &translation_unit, const Sink &sink) const;
+
+	void dump(const TranslationUnit &translation_unit, std::ostream &ostream) const;
+
+	void dump(const TranslationUnit &translation_unit, const std::string &path) const;
+}; // class AstDumper
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_AstDumper_hpp
@@ -0,0 +1,276 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file AstFile.hpp
+
+   Copyright (c) 2015 pegacorn
+
+   Reader of the files written by TranslationUnit::export_binary().
+   Header-only and independent of libclang; the file is mapped and read in
+   place.
+
+   Layout (native byte order, every section 8-byte aligned):
+	 AstFileHeader
+	 AstFileNode[node_count]		preorder; node 0 is the translation unit
+	 AstFileEntry[file_count]
+	 AstFileKind[kind_count]		names of the cursor kinds in use
+	 uint64_t[string_count + 1]	offsets of the strings; string 0 is ""
+	 char[string_bytes]			NUL-terminated strings
+*/
+#ifndef clang_cpp_AstFile_hpp
+#define clang_cpp_AstFile_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "clang-cpp/MappedFile.hpp"
+
+
+namespace clangxx {
+
+const char			ast_file_magic[8]		= {'C', 'X', 'X', 'A', 'S', 'T', 'F', '\0'};
+const std::uint32_t	ast_file_version		= 1;
+const std::uint32_t	ast_file_byte_order		= 0x01020304;
+const std::uint32_t	ast_file_invalid		= 0xffffffffu;
+
+struct AstFileHeader
+{
+	char			magic[8];
+	std::uint32_t	version;
+	std::uint32_t	byte_order;
+	std::uint64_t	node_count;
+	std::uint64_t	file_count;
+	std::uint64_t	kind_count;
+	std::uint64_t	string_count;
+	std::uint64_t	string_bytes;
+}; // struct AstFileHeader
+
+struct AstFileNode
+{
+	std::uint32_t	kind;			//!< CXCursorKind
+	std::uint32_t	parent;
+	std::uint32_t	first_child;
+	std::uint32_t	next_sibling;
+	std::uint32_t	spelling;		//!< string id
+	std::uint32_t	usr;			//!< string id; 0 unless a declaration
+	std::uint64_t	location;		//!< see AstFile::location_file() etc.
+}; // struct AstFileNode
+
+struct AstFileEntry
+{
+	std::uint32_t	name;			//!< string id
+	std::uint32_t	reserved;
+	std::int64_t	time;
+}; // struct AstFileEntry
+
+struct AstFileKind
+{
+	std::uint32_t	kind;
+	std::uint32_t	name;			//!< string id
+}; // struct AstFileKind
+
+class AstFile
+{
+  public:
+	static const std::uint32_t	s_file_bits		= 20;
+	static const std::uint32_t	s_line_bits		= 28;
+	static const std::uint32_t	s_column_bits	= 16;
+
+	static std::uint64_t pack_location(std::uint32_t file, std::uint32_t line,
+									   std::uint32_t column) noexcept {
+		const std::uint64_t max_file = (1u << s_file_bits) - 1;
+		const std::uint64_t max_line = (1u << s_line_bits) - 1;
+		const std::uint64_t max_column = (1u << s_column_bits) - 1;
+		return ((file < max_file ? file : max_file) << (s_line_bits + s_column_bits))
+			| ((line < max_line ? line : max_line) << s_column_bits)
+			| (column < max_column ? column : max_column);
+	}
+
+	//! @return the file index of @a location, or ast_file_invalid.
+	static std::uint32_t location_file(std::uint64_t location) noexcept {
+		const std::uint32_t file = static_cast<std::uint32_t>(location >> (s_line_bits + s_column_bits));
+		return (file == (1u << s_file_bits) - 1) ? ast_file_invalid : file;
+	}
+
+	static std::uint32_t location_line(std::uint64_t location) noexcept {
+		return static_cast<std::uint32_t>(location >> s_column_bits) & ((1u << s_line_bits) - 1);
+	}
+
+	static std::uint32_t location_column(std::uint64_t location) noexcept {
+		return static_cast<std::uint32_t>(location) & ((1u << s_column_bits) - 1);
+	}
+
+	static std::size_t align8(std::size_t size) noexcept {
+		return (size + 7) & ~static_cast<std::size_t>(7);
+	}
+
+  private:
+	MappedFile			m_mapped_file;
+	AstFileHeader		m_header{};
+	const AstFileNode	*m_nodes{nullptr};
+	const AstFileEntry	*m_files{nullptr};
+	const AstFileKind	*m_kinds{nullptr};
+	const std::uint64_t	*m_string_offsets{nullptr};
+	const char			*m_strings{nullptr};
+
+  public:
+	AstFile() = default;
+
+	explicit AstFile(const std::string &path) {
+		open(path);
+	}
+
+	AstFile(const AstFile &) = delete;
+	AstFile(AstFile &&other) noexcept = default;
+
+	AstFile &operator=(const AstFile &) = delete;
+	AstFile &operator=(AstFile &&other) noexcept = default;
+
+  public:
+	void open(const std::string &path) {
+		MappedFile mapped_file(path);
+		const char *data = mapped_file.data();
+		const std::size_t size = mapped_file.size();
+
+		AstFileHeader header;
+		if ( size < sizeof(header) ) {
+			throw std::runtime_error("Truncated AST file: " + path);
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if ( std::memcmp(header.magic, ast_file_magic, sizeof(ast_file_magic)) != 0
+			 || header.version != ast_file_version
+			 || header.byte_order != ast_file_byte_order )
+		{
+			throw std::runtime_error("Not an AST file of this version: " + path);
+		}
+
+		// the counts are untrusted: check each section against the bytes left
+		// before multiplying, so that a corrupt header cannot overflow
+		std::size_t remaining = size - align8(sizeof(header));
+		auto section_size = [&remaining, &path](std::uint64_t count, std::size_t element_size) {
+			if ( count > remaining / element_size ) {
+				throw std::runtime_error("Truncated AST file: " + path);
+			}
+			const std::size_t bytes = std::min(align8(static_cast<std::size_t>(count) * element_size),
+											   remaining);
+			remaining -= bytes;
+			return bytes;
+		};
+		const std::size_t nodes_size = section_size(header.node_count, sizeof(AstFileNode));
+		const std::size_t files_size = section_size(header.file_count, sizeof(AstFileEntry));
+		const std::size_t kinds_size = section_size(header.kind_count, sizeof(AstFileKind));
+		if ( header.string_count == 0 || header.string_count >= remaining / sizeof(std::uint64_t) ) {
+			throw std::runtime_error("Truncated AST file: " + path);
+		}
+		const std::size_t offsets_size = section_size(header.string_count + 1, sizeof(std::uint64_t));
+		if ( header.string_bytes == 0 || header.string_bytes > remaining ) {
+			throw std::runtime_error("Truncated AST file: " + path);
+		}
+
+		const char *p = data + align8(sizeof(header));
+		m_nodes = reinterpret_cast<const AstFileNode *>(p);
+		p += nodes_size;
+		m_files = reinterpret_cast<const AstFileEntry *>(p);
+		p += files_size;
+		m_kinds = reinterpret_cast<const AstFileKind *>(p);
+		p += kinds_size;
+		m_string_offsets = reinterpret_cast<const std::uint64_t *>(p);
+		p += offsets_size;
+		m_strings = p;
+		// every string then ends inside the table, whatever its offset
+		if ( m_string_offsets[header.string_count] != header.string_bytes
+			 || m_strings[header.string_bytes - 1] != '\0' )
+		{
+			throw std::runtime_error("Corrupt string table in AST file: " + path);
+		}
+		m_header = header;
+		m_mapped_file = std::move(mapped_file);
+	}
+
+	std::size_t node_count() const noexcept {
+		return static_cast<std::size_t>(m_header.node_count);
+	}
+
+	const AstFileNode &node(std::uint32_t index) const {
+		if ( index >= m_header.node_count ) {
+			throw std::out_of_range("AST file node index out of range.");
+		}
+		return m_nodes[index];
+	}
+
+	const AstFileNode *nodes() const noexcept {
+		return m_nodes;
+	}
+
+	/*!
+	  Calls @a function with the index of every child of @a index, in order.
+	  @throw std::runtime_error if a link leaves the node table or loops.
+	*/
+	template<typename Function>
+	void for_each_child(std::uint32_t index, Function function) const {
+		std::uint64_t visited = 0;
+		for ( std::uint32_t child = node(index).first_child; child != ast_file_invalid;
+			  child = m_nodes[child].next_sibling )
+		{
+			if ( child >= m_header.node_count || ++visited > m_header.node_count ) {
+				throw std::runtime_error("Corrupt node links in AST file.");
+			}
+			function(child);
+		}
+	}
+
+	std::size_t string_count() const noexcept {
+		return static_cast<std::size_t>(m_header.string_count);
+	}
+
+	//! @return string @a id, or "" if @a id or its offset is out of range.
+	const char *string(std::uint32_t id) const noexcept {
+		if ( id >= m_header.string_count || m_string_offsets[id] >= m_header.string_bytes ) {
+			return m_strings + m_header.string_bytes - 1;
+		}
+		return m_strings + m_string_offsets[id];
+	}
+
+	std::size_t string_size(std::uint32_t id) const noexcept {
+		if ( id >= m_header.string_count
+			 || m_string_offsets[id] >= m_string_offsets[id + 1]
+			 || m_string_offsets[id + 1] > m_header.string_bytes )
+		{
+			return 0;
+		}
+		return static_cast<std::size_t>(m_string_offsets[id + 1] - m_string_offsets[id] - 1);
+	}
+
+	std::size_t file_count() const noexcept {
+		return static_cast<std::size_t>(m_header.file_count);
+	}
+
+	const AstFileEntry &file(std::uint32_t index) const {
+		if ( index >= m_header.file_count ) {
+			throw std::out_of_range("AST file file index out of range.");
+		}
+		return m_files[index];
+	}
+
+	const char *file_name(std::uint32_t index) const {
+		return string(file(index).name);
+	}
+
+	//! @return the spelling of cursor kind @a kind, or "" if no node has it.
+	const char *kind_name(std::uint32_t kind) const noexcept {
+		for ( std::size_t i = 0; i < m_header.kind_count; ++i ) {
+			if ( m_kinds[i].kind == kind ) {
+				return string(m_kinds[i].name);
+			}
+		}
+		return string(0);
+	}
+}; // class AstFile
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_AstFile_hpp
@@ -0,0 +1,97 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file AstSnapshot.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_AstSnapshot_hpp
+#define clang_cpp_AstSnapshot_hpp
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/CursorMap.hpp"
+#include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+
+
+namespace clangxx {
+
+class Cursor;
+class TranslationUnit;
+
+struct AstDiff
+{
+	std::vector<std::string>	added;
+	std::vector<std::string>	removed;
+	std::vector<std::string>	changed;
+
+	bool empty() const noexcept {
+		return added.empty() && removed.empty() && changed.empty();
+	}
+}; // struct AstDiff
+
+/*!
+  Structural hashes of one parse of a translation unit.
+
+  The hash of a subtree combines the kind and spelling of its root with the
+  hashes of its children, in order; source locations are ignored, so edits
+  that only move code do not change it.  Declarations outside function
+  bodies are recorded by USR and survive reparsing, so two snapshots of the
+  same translation unit can be compared with diff().  The recorded hash of
+  a namespace or class covers the USRs of the declarations nested in it,
+  not their contents: editing a method changes the method alone.
+*/
+class CLANGXX_API AstSnapshot
+{
+  public:
+	using Hash			= std::uint64_t;
+	using Declarations	= std::unordered_map<std::string, Hash>;
+
+  public:
+	/*!
+	  Hashes the whole translation unit in one pass.  @a options is applied
+	  to the top-level declarations only.
+	*/
+	static AstSnapshot capture(const TranslationUnit &translation_unit,
+							   const TraversalOptions &options = TraversalOptions());
+
+	static AstDiff diff(const AstSnapshot &old_snapshot, const AstSnapshot &new_snapshot);
+
+  private:
+	Declarations		m_declarations;
+	CursorMap<Hash>		m_subtrees;
+
+  public:
+	AstSnapshot();
+	~AstSnapshot();
+
+	AstSnapshot(const AstSnapshot &other);
+	AstSnapshot(AstSnapshot &&other) noexcept;
+
+	AstSnapshot &operator=(const AstSnapshot &other);
+	AstSnapshot &operator=(AstSnapshot &&other) noexcept;
+
+  public:
+	const Declarations &declarations() const noexcept {
+		return m_declarations;
+	}
+
+	//! @return the hash of the declarations with USR @a usr, or 0.
+	Hash declaration_hash(const std::string &usr) const;
+
+	/*!
+	  @return the hash of the subtree rooted at @a cx_cursor, or 0.
+	  Only valid until the translation unit is reparsed.
+	*/
+	Hash subtree_hash(CXCursor cx_cursor) const noexcept;
+
+	Hash subtree_hash(const Cursor &cursor) const noexcept;
+}; // class AstSnapshot
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_AstSnapshot_hpp
@@ -0,0 +1,122 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file BatchParser.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_BatchParser_hpp
+#define clang_cpp_BatchParser_hpp
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class Index;
+class ParseProfile;
+class PchManager;
+class TranslationUnit;
+
+struct ParseJob
+{
+	std::string					filename;
+	std::vector<std::string>	args;
+	CXTranslationUnit_Flags		options{CXTranslationUnit_None};
+}; // struct ParseJob
+
+struct ParseResult
+{
+	std::shared_ptr<TranslationUnit>	translation_unit;
+	//! set instead of translation_unit when the job failed.
+	std::exception_ptr					error;
+}; // struct ParseResult
+
+struct BatchStats
+{
+	std::size_t	jobs{};
+	std::size_t	failures{};
+	//! of the whole BatchParser::parse() call, PCH preparation included.
+	double		wall_seconds{};
+	//! sum of the parse times of the jobs.
+	double		parse_seconds{};
+}; // struct BatchStats
+
+/*!
+  Parses many translation units on a pool of threads.
+
+  With Schedule::Locality, jobs start in decreasing order of the parse time
+  recorded in the ParseProfile, so the longest ones do not end up in the
+  tail.  Among the next few jobs, a worker takes the one whose include set
+  is most similar to the job it parsed last, so consecutive parses on a
+  thread touch the same headers.
+*/
+class CLANGXX_API BatchParser
+{
+  public:
+	enum class Schedule
+	{
+		Fifo,
+		Locality,
+	};
+
+  private:
+	std::shared_ptr<Index>	m_index;
+	unsigned int			m_thread_count;
+	PchManager				*m_pch_manager{nullptr};
+	ParseProfile			*m_profile{nullptr};
+	Schedule				m_schedule{Schedule::Locality};
+	std::size_t				m_window{8};
+	BatchStats				m_last_stats;
+
+  public:
+	explicit BatchParser(std::shared_ptr<Index> index = nullptr, unsigned int thread_count = 0);
+	~BatchParser();
+
+	BatchParser(const BatchParser &) = delete;
+	BatchParser &operator=(const BatchParser &) = delete;
+
+  public:
+	std::shared_ptr<Index> index() const {
+		return m_index;
+	}
+
+	//! Shares precompiled headers between the jobs of each batch; not owned.
+	void set_pch_manager(PchManager *pch_manager) noexcept {
+		m_pch_manager = pch_manager;
+	}
+
+	/*!
+	  Reads costs and include sets from @a profile and records them for the
+	  jobs parsed; not owned.
+	*/
+	void set_profile(ParseProfile *profile) noexcept {
+		m_profile = profile;
+	}
+
+	void set_schedule(Schedule schedule) noexcept {
+		m_schedule = schedule;
+	}
+
+	//! Number of upcoming jobs a worker chooses from by similarity.
+	void set_window(std::size_t window) noexcept {
+		m_window = (window == 0) ? 1 : window;
+	}
+
+	const BatchStats &last_stats() const noexcept {
+		return m_last_stats;
+	}
+
+	//! @return one result per job, in the order of @a jobs.
+	std::vector<ParseResult> parse(const std::vector<ParseJob> &jobs);
+}; // class BatchParser
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_BatchParser_hpp
@@ -0,0 +1,111 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file CallGraph.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_CallGraph_hpp
+#define clang_cpp_CallGraph_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-cpp/MappedFile.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class TranslationUnit;
+
+/*!
+  Caller to callee graph over functions identified by USR, stored in
+  compressed sparse row form.  A call to a virtual method also gets edges to
+  every method overriding it in the analyzed translation units.
+*/
+class CLANGXX_API CallGraph
+{
+  public:
+	using NodeId	= std::uint32_t;
+	using EdgeIndex	= std::uint64_t;
+	using Callees	= std::pair<const NodeId *, const NodeId *>;
+
+	static const NodeId	invalid_node	= static_cast<NodeId>(-1);
+
+  public:
+	static CallGraph build(
+	  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+	  unsigned int thread_count = 0);
+
+	//! @param edges (caller, callee) pairs of indices into @a usrs.
+	static CallGraph from_edges(const std::vector<std::string> &usrs,
+								std::vector<std::pair<NodeId, NodeId>> edges);
+
+	//! Maps a file written by save(); the graph stays backed by the mapping.
+	static CallGraph load(const std::string &path);
+
+  private:
+	// owned storage of a built graph; empty when the graph is mapped
+	std::vector<EdgeIndex>		m_offset_storage;
+	std::vector<NodeId>			m_target_storage;
+	std::vector<std::uint64_t>	m_name_offset_storage;
+	std::vector<NodeId>			m_sorted_storage;
+	std::vector<char>			m_name_storage;
+	std::shared_ptr<MappedFile>	m_mapped_file;
+
+	NodeId				m_node_count{0};
+	const EdgeIndex		*m_offsets{nullptr};
+	const NodeId		*m_targets{nullptr};
+	const std::uint64_t	*m_name_offsets{nullptr};
+	const NodeId		*m_sorted{nullptr};
+	const char			*m_names{nullptr};
+
+  public:
+	CallGraph();
+	~CallGraph();
+
+	CallGraph(const CallGraph &other);
+	CallGraph(CallGraph &&other) noexcept;
+
+	CallGraph &operator=(const CallGraph &other);
+	CallGraph &operator=(CallGraph &&other) noexcept;
+
+  public:
+	std::size_t node_count() const noexcept {
+		return m_node_count;
+	}
+
+	std::size_t edge_count() const noexcept {
+		return m_node_count ? static_cast<std::size_t>(m_offsets[m_node_count]) : 0;
+	}
+
+	//! @return the node of @a usr, or invalid_node.
+	NodeId find(const std::string &usr) const;
+
+	const char *usr(NodeId node) const {
+		return m_names + m_name_offsets[node];
+	}
+
+	Callees callees(NodeId node) const {
+		return Callees(m_targets + m_offsets[node], m_targets + m_offsets[node + 1]);
+	}
+
+	//! @return the graph with every edge reversed (callee to caller).
+	CallGraph reversed() const;
+
+	//! @return every node reachable from @a roots, including the roots.
+	std::vector<NodeId> reachable(const std::vector<NodeId> &roots) const;
+
+	void save(const std::string &path) const;
+
+  private:
+	void adopt_storage();
+}; // class CallGraph
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_CallGraph_hpp
@@ -0,0 +1,142 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ClassHierarchy.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_ClassHierarchy_hpp
+#define clang_cpp_ClassHierarchy_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-cpp/SymbolTable.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class TranslationUnit;
+
+/*!
+  Inheritance and override relations of classes and methods, identified by
+  USR and merged over many translation units.  Each relation is stored as
+  an adjacency array in both directions.
+*/
+class CLANGXX_API ClassHierarchy
+{
+  public:
+	using NodeId	= SymbolTable::Id;
+	using Edge		= std::pair<NodeId, NodeId>;
+	using Range		= std::pair<const NodeId *, const NodeId *>;
+
+	static const NodeId	invalid_node	= SymbolTable::invalid_id;
+
+  private:
+	struct Adjacency
+	{
+		std::vector<std::uint32_t>	offsets;
+		std::vector<NodeId>			targets;
+
+		void assign(std::size_t node_count, const std::vector<Edge> &edges, bool reverse);
+
+		Range operator[](NodeId node) const {
+			if ( node + 1 >= offsets.size() ) {
+				return Range(nullptr, nullptr);
+			}
+			return Range(targets.data() + offsets[node], targets.data() + offsets[node + 1]);
+		}
+	}; // struct Adjacency
+
+  public:
+	static ClassHierarchy build(
+	  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+	  unsigned int thread_count = 0);
+
+  private:
+	SymbolTable			m_symbols;
+	std::vector<Edge>	m_inheritances;	// (derived, base)
+	std::vector<Edge>	m_overrides;	// (overrider, overridden)
+	Adjacency			m_bases;
+	Adjacency			m_derived;
+	Adjacency			m_overridden;
+	Adjacency			m_overriders;
+
+  public:
+	ClassHierarchy();
+	~ClassHierarchy();
+
+	ClassHierarchy(const ClassHierarchy &other);
+	ClassHierarchy(ClassHierarchy &&other) noexcept;
+
+	ClassHierarchy &operator=(const ClassHierarchy &other);
+	ClassHierarchy &operator=(ClassHierarchy &&other) noexcept;
+
+  public:
+	std::size_t node_count() const noexcept {
+		return m_symbols.size();
+	}
+
+	NodeId find(const std::string &usr) const {
+		return m_symbols.find(usr);
+	}
+
+	const std::string &usr(NodeId node) const {
+		return m_symbols.name(node);
+	}
+
+	//! Direct base classes.
+	Range bases(NodeId class_node) const {
+		return m_bases[class_node];
+	}
+
+	//! Direct subclasses.
+	Range derived(NodeId class_node) const {
+		return m_derived[class_node];
+	}
+
+	//! Methods directly overridden by @a method_node.
+	Range overridden(NodeId method_node) const {
+		return m_overridden[method_node];
+	}
+
+	//! Methods directly overriding @a method_node.
+	Range overriders(NodeId method_node) const {
+		return m_overriders[method_node];
+	}
+
+	std::vector<NodeId> all_bases(NodeId class_node) const {
+		return closure(m_bases, class_node);
+	}
+
+	std::vector<NodeId> all_subclasses(NodeId class_node) const {
+		return closure(m_derived, class_node);
+	}
+
+	std::vector<NodeId> all_overridden(NodeId method_node) const {
+		return closure(m_overridden, method_node);
+	}
+
+	std::vector<NodeId> all_overriders(NodeId method_node) const {
+		return closure(m_overriders, method_node);
+	}
+
+	//! Adds the relations of @a other (e.g. built from another batch of TUs).
+	void merge(const ClassHierarchy &other);
+
+  private:
+	void add(const std::vector<std::string> &usrs,
+			 const std::vector<Edge> &inheritances, const std::vector<Edge> &overrides);
+
+	void finish();
+
+	static std::vector<NodeId> closure(const Adjacency &adjacency, NodeId node);
+}; // class ClassHierarchy
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_ClassHierarchy_hpp
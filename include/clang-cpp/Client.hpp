@@ -0,0 +1,63 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Client.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Client_hpp
+#define clang_cpp_Client_hpp
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "clang-cpp/ServerProtocol.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Synchronous connection to a Server.  Calls may be made from several
+  threads; they are serialized.  An error reply is thrown as RuntimeError.
+*/
+class CLANGXX_API Client
+{
+  private:
+	int				m_descriptor;
+	std::uint32_t	m_next_request_id;
+	std::mutex		m_mutex;
+
+  public:
+	explicit Client(const std::string &socket_path);
+	~Client();
+
+	Client(const Client &) = delete;
+	Client &operator=(const Client &) = delete;
+
+  public:
+	void parse(const std::string &filename, const std::vector<std::string> &args = {},
+			   const protocol::UnsavedContents &unsaved = {});
+
+	void reparse(const std::string &filename, const protocol::UnsavedContents &unsaved = {});
+
+	//! @param file	file of the position; empty: @a filename itself.
+	protocol::CursorInfo cursor_at(const std::string &filename, const std::string &file,
+								   unsigned int line, unsigned int column);
+
+	//! @return locations in @a filename referring to the declaration @a usr.
+	std::vector<protocol::Location> references(const std::string &filename, const std::string &usr);
+
+	//! @return completions sorted by priority.
+	std::vector<protocol::Completion> complete(const std::string &filename,
+											   unsigned int line, unsigned int column,
+											   const protocol::UnsavedContents &unsaved = {});
+
+  private:
+	std::string request(protocol::MessageType type, const std::string &payload);
+}; // class Client
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Client_hpp
@@ -0,0 +1,159 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Comment.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Comment_hpp
+#define clang_cpp_Comment_hpp
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-c/Documentation.h"
+#include "clang-c/Index.h"
+#include "clang-cpp/Reader.hpp"
+#include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+
+
+namespace clangxx {
+
+class Cursor;
+class TranslationUnit;
+
+//! Node of a parsed documentation comment; children are decoded on access.
+class CLANGXX_API Comment
+{
+  public:
+	using Children		= RandomAccessReader<Comment, unsigned int, std::function<Comment(unsigned int)>>;
+	using Arguments		= RandomAccessReader<std::string, unsigned int, std::function<std::string(unsigned int)>>;
+	using Attribute		= std::pair<std::string, std::string>;
+	using Attributes	= RandomAccessReader<Attribute, unsigned int, std::function<Attribute(unsigned int)>>;
+
+  public:
+	static Comment from_cursor(const Cursor &cursor);
+
+  private:
+	std::shared_ptr<const TranslationUnit>	m_translation_unit;
+	// warning: define m_translation_unit before m_cx_comment
+	CXComment	m_cx_comment;
+
+  private:
+	Comment(CXComment cx_comment, std::shared_ptr<const TranslationUnit> translation_unit) noexcept;
+
+  public:
+	~Comment();
+
+	Comment(const Comment &other);
+	Comment(Comment &&other) noexcept;
+
+	Comment &operator=(const Comment &other);
+	Comment &operator=(Comment &&other) noexcept;
+
+  public:
+	explicit operator bool() const noexcept {
+		return kind() != CXComment_Null;
+	}
+
+	CXComment native_handle() const noexcept {
+		return m_cx_comment;
+	}
+
+	CXCommentKind kind() const noexcept {
+		return clang_Comment_getKind(m_cx_comment);
+	}
+
+	Children children() const;
+
+	bool is_whitespace() const noexcept {
+		return clang_Comment_isWhitespace(m_cx_comment) != 0;
+	}
+
+	bool has_trailing_newline() const noexcept {
+		return clang_InlineContentComment_hasTrailingNewline(m_cx_comment) != 0;
+	}
+
+	//! Text of a Text, VerbatimBlockLine or VerbatimLine node.
+	std::string text() const;
+
+	//! Command name of an InlineCommand or BlockCommand node.
+	std::string command_name() const;
+
+	//! Arguments of an InlineCommand or BlockCommand node.
+	Arguments arguments() const;
+
+	CXCommentInlineCommandRenderKind render_kind() const noexcept {
+		return clang_InlineCommandComment_getRenderKind(m_cx_comment);
+	}
+
+	//! Paragraph of a BlockCommand, ParamCommand or TParamCommand node.
+	Comment paragraph() const;
+
+	//! Parameter name of a ParamCommand or TParamCommand node.
+	std::string param_name() const;
+
+	bool is_param_index_valid() const noexcept {
+		return clang_ParamCommandComment_isParamIndexValid(m_cx_comment) != 0;
+	}
+
+	unsigned int param_index() const noexcept {
+		return clang_ParamCommandComment_getParamIndex(m_cx_comment);
+	}
+
+	bool is_direction_explicit() const noexcept {
+		return clang_ParamCommandComment_isDirectionExplicit(m_cx_comment) != 0;
+	}
+
+	CXCommentParamPassDirection direction() const noexcept {
+		return clang_ParamCommandComment_getDirection(m_cx_comment);
+	}
+
+	//! Tag name of an HTMLStartTag or HTMLEndTag node.
+	std::string tag_name() const;
+
+	bool is_self_closing() const noexcept {
+		return clang_HTMLStartTagComment_isSelfClosing(m_cx_comment) != 0;
+	}
+
+	Attributes attributes() const;
+
+	//! HTML of an HTML tag node, as written.
+	std::string str() const;
+
+	//! Rendering of a FullComment node.
+	std::string html() const;
+
+	std::string xml() const;
+}; // class Comment
+
+enum class CommentFormat
+{
+	HTML,
+	XML,
+};
+
+/*!
+  Receives the rendering of one documented declaration.  Calls for the same
+  translation unit come from one thread, in traversal order; calls for
+  different translation units may be concurrent.  @a data is only valid
+  during the call.
+*/
+using CommentSink	= std::function<void(std::size_t translation_unit_index,
+										 const char *data, std::size_t size)>;
+
+//! Renders the documentation of every documented declaration of
+//! @a translation_units, one translation unit per thread.
+CLANGXX_API void render_comments(
+  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+  CommentFormat format, const CommentSink &sink,
+  const TraversalOptions &options = TraversalOptions(),
+  unsigned int thread_count = 0);
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Comment_hpp
@@ -14,26 +14,36 @@
 #include <utility>
 #include <vector>
 #include "clang-c/Index.h"
+#include "clang-cpp/Arena.hpp"
+#include "clang-cpp/CursorHash.hpp"
 #include "clang-cpp/CursorKind.hpp"
 #include "clang-cpp/Reader.hpp"
+#include "clang-cpp/Result.hpp"
 #include "clang-cpp/switch_port.hpp"
 #include "clang-cpp/UniqueCXObject.hpp"
 
 
 namespace clangxx {
 
+class Comment;
+class LocationFilter;
 class TranslationUnit;
+struct TraversalOptions;
 
 class CLANGXX_API Cursor
 {
   public:
 	using Arguments	= RandomAccessReader<Cursor, unsigned int, std::function<Cursor(unsigned int)>>;
+	using Visitor	= std::function<CXChildVisitResult(const Cursor &cursor, const Cursor &parent)>;
 
   public:
 //	static Cursor from_location(std::shared_ptr<const TranslationUnit> translation_unit, const SourceLocation &location);
 
 	static Cursor from_result(std::shared_ptr<const TranslationUnit> translation_unit);
 
+	static Cursor from_native_handle(CXCursor cx_cursor,
+									 std::shared_ptr<const TranslationUnit> translation_unit);
+
   private:
 	mutable std::shared_ptr<const TranslationUnit>	m_translation_unit;
 	// warning: define m_translation_unit before m_cx_cursor
@@ -42,6 +52,7 @@ class CLANGXX_API Cursor
 	mutable std::string				m_displayname;
 	mutable std::shared_ptr<Cursor>	m_canonical;
 	mutable unsigned int			m_hash{0};
+	mutable bool					m_has_hash{false};
 	mutable std::shared_ptr<Cursor>	m_semantic_parent;
 	mutable std::shared_ptr<Cursor>	m_lexical_parent;
 	mutable std::shared_ptr<Cursor>	m_referenced;
@@ -51,6 +62,15 @@ class CLANGXX_API Cursor
 
 	Cursor(CXCursor &&cx_cursor, std::shared_ptr<const TranslationUnit> &translation_unit);
 
+	void visit_children(const Visitor &visitor, LocationFilter *filter) const;
+
+	/*!
+	  Fetches with @a cx_function into @a memo once; @return the memoized cursor.
+	  @param memoize_null	whether a null result is memoized too, as referenced() does.
+	*/
+	Result<Cursor> try_memoized(std::shared_ptr<Cursor> &memo, CXCursor (*cx_function)(CXCursor),
+								bool memoize_null) const noexcept;
+
   public:
 	~Cursor();
 
@@ -65,12 +85,18 @@ class CLANGXX_API Cursor
 		return !is_null(m_cx_cursor);
 	}
 
-	bool operator==(const Cursor &other) const;
+	bool operator==(const Cursor &other) const noexcept {
+		return CXCursorEqual()(m_cx_cursor, other.m_cx_cursor);
+	}
 
-	bool operator!=(const Cursor &other) const {
+	bool operator!=(const Cursor &other) const noexcept {
 		return !(*this == other);
 	}
 
+	CXCursor native_handle() const noexcept {
+		return m_cx_cursor;
+	}
+
 	bool is_definition() const;
 
 	bool is_static_method() const;
@@ -79,14 +105,23 @@ class CLANGXX_API Cursor
 
 	std::string get_usr() const;
 
+	//! get_usr() into @a arena.
+	ArenaString get_usr(Arena &arena) const;
+
 	CursorKind kind() const {
 		return CursorKind::from_id(m_cx_cursor.kind);
 	}
 
 	std::string spelling() const;
 
+	//! spelling() into @a arena; the result is not memoized.
+	ArenaString spelling(Arena &arena) const;
+
 	std::string displayname() const;
 
+	//! displayname() into @a arena; the result is not memoized.
+	ArenaString displayname(Arena &arena) const;
+
 //	SourceLocation location() const;
 
 //	SourceRange extent() const;
@@ -111,6 +146,10 @@ class CLANGXX_API Cursor
 
 	Cursor semantic_parent() const;
 
+	std::string qualified_name() const;
+
+	std::vector<std::string> scope_path() const;
+
 	Cursor lexical_parent() const;
 
 	std::shared_ptr<const TranslationUnit> translation_unit() const {
@@ -123,10 +162,50 @@ class CLANGXX_API Cursor
 
 	std::string raw_comment() const;
 
+	Comment parsed_comment() const;
+
 	Arguments get_arguments() const;
 
 	std::vector<Cursor> get_children() const;
 
+	std::vector<Cursor> get_children(const TraversalOptions &options) const;
+
+	//! get_children() into @a arena, to be dropped with it at the end of a request.
+	ArenaVector<Cursor> get_children(Arena &arena) const;
+
+	ArenaVector<Cursor> get_children(Arena &arena, const TraversalOptions &options) const;
+
+	void visit_children(const Visitor &visitor) const;
+
+	void visit_children(const Visitor &visitor, const TraversalOptions &options) const;
+
+	/*!
+	  @name Non-throwing accessors
+	  For hot loops: the routine failures (null cursor, no definition,
+	  no string...) are reported in the Status instead of thrown.
+	  @{
+	*/
+	Result<CursorKind> try_kind() const noexcept;
+
+	//! The string is memoized in this cursor; it lives as long as the cursor.
+	Result<const std::string *> try_spelling() const noexcept;
+
+	Result<const std::string *> try_displayname() const noexcept;
+
+	//! Not memoized, like get_usr(): the string is built once and moved out.
+	Result<std::string> try_get_usr() const noexcept;
+
+	Result<Cursor> try_get_definition() const noexcept;
+
+	Result<Cursor> try_canonical() const noexcept;
+
+	Result<Cursor> try_semantic_parent() const noexcept;
+
+	Result<Cursor> try_lexical_parent() const noexcept;
+
+	Result<Cursor> try_referenced() const noexcept;
+	//! @}
+
 //	walk_preorder() const;
 
 //	get_tokens() const;
@@ -138,5 +217,17 @@ class CLANGXX_API Cursor
 
 } // namespace clangxx
 
+namespace std {
+
+template<>
+struct hash<clangxx::Cursor>
+{
+	size_t operator()(const clangxx::Cursor &cursor) const noexcept {
+		return clangxx::CXCursorHash()(cursor.native_handle());
+	}
+};
+
+} // namespace std
+
 
 #endif // clang_cpp_Cursor_hpp
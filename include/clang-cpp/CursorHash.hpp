@@ -0,0 +1,57 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file CursorHash.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_CursorHash_hpp
+#define clang_cpp_CursorHash_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include "clang-c/Index.h"
+
+
+namespace clangxx {
+
+constexpr bool is_declaration_kind(CXCursorKind kind) noexcept
+{
+	return (kind >= CXCursor_FirstDecl && kind <= CXCursor_LastDecl)
+		|| (kind >= CXCursor_FirstExtraDecl && kind <= CXCursor_LastExtraDecl);
+}
+
+//! Same relation as clang_equalCursors(), without the library call.
+struct CXCursorEqual
+{
+	bool operator()(const CXCursor &lhs, const CXCursor &rhs) const noexcept {
+		// the "FirstInDeclGroup" bit of a declaration cursor lives in data[1]
+		// and is not set consistently, so libclang ignores it.
+		return lhs.kind == rhs.kind
+			&& lhs.data[0] == rhs.data[0]
+			&& lhs.data[2] == rhs.data[2]
+			&& (is_declaration_kind(lhs.kind) || lhs.data[1] == rhs.data[1]);
+	}
+}; // struct CXCursorEqual
+
+//! Hashes the same fields as clang_hashCursor(), with a stronger mixer.
+struct CXCursorHash
+{
+	std::size_t operator()(const CXCursor &cx_cursor) const noexcept {
+		const bool is_statement{
+			(cx_cursor.kind >= CXCursor_FirstExpr && cx_cursor.kind <= CXCursor_LastExpr)
+			|| (cx_cursor.kind >= CXCursor_FirstStmt && cx_cursor.kind <= CXCursor_LastStmt)};
+		std::uint64_t value{reinterpret_cast<std::uintptr_t>(cx_cursor.data[is_statement ? 1 : 0])};
+		value ^= static_cast<std::uint64_t>(cx_cursor.kind) << 48;
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdULL;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ULL;
+		value ^= value >> 33;
+		return static_cast<std::size_t>(value);
+	}
+}; // struct CXCursorHash
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_CursorHash_hpp
@@ -0,0 +1,275 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file CursorMap.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_CursorMap_hpp
+#define clang_cpp_CursorMap_hpp
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/CursorHash.hpp"
+
+
+namespace clangxx {
+
+namespace detail {
+
+/*!
+  Open addressing table with linear probing, keyed by CXCursor.
+  A slot whose key has kind 0 is empty: no cursor kind has that value.
+*/
+template<typename Slot>
+class CursorTable
+{
+  private:
+	static const CXCursorKind	s_empty_kind	= static_cast<CXCursorKind>(0);
+
+  private:
+	std::vector<Slot>	m_slots;
+	std::size_t			m_size{0};
+
+  public:
+	CursorTable() = default;
+
+	explicit CursorTable(std::size_t capacity) {
+		reserve(capacity);
+	}
+
+  public:
+	std::size_t size() const noexcept {
+		return m_size;
+	}
+
+	bool empty() const noexcept {
+		return m_size == 0;
+	}
+
+	void clear() noexcept {
+		m_slots.clear();
+		m_size = 0;
+	}
+
+	void reserve(std::size_t capacity) {
+		std::size_t slot_count{16};
+		while ( slot_count < capacity * 2 ) {
+			slot_count *= 2;
+		}
+		if ( slot_count > m_slots.size() ) {
+			rehash(slot_count);
+		}
+	}
+
+	template<typename Function>
+	void for_each(Function function) const {
+		for ( const auto &slot : m_slots ) {
+			if ( !is_empty(slot) ) {
+				function(slot);
+			}
+		}
+	}
+
+  protected:
+	Slot *find_slot(const CXCursor &key) noexcept {
+		if ( m_slots.empty() ) {
+			return nullptr;
+		}
+		const std::size_t mask{m_slots.size() - 1};
+		for ( std::size_t i{CXCursorHash()(key) & mask}; ; i = (i + 1) & mask ) {
+			Slot &slot = m_slots[i];
+			if ( is_empty(slot) ) {
+				return nullptr;
+			}
+			if ( CXCursorEqual()(slot.key, key) ) {
+				return &slot;
+			}
+		}
+	}
+
+	const Slot *find_slot(const CXCursor &key) const noexcept {
+		return const_cast<CursorTable *>(this)->find_slot(key);
+	}
+
+	//! @return the slot of @a key and whether it has just been inserted.
+	std::pair<Slot *, bool> insert_slot(const CXCursor &key) {
+		if ( (m_size + 1) * 2 > m_slots.size() ) {
+			rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+		}
+		const std::size_t mask{m_slots.size() - 1};
+		for ( std::size_t i{CXCursorHash()(key) & mask}; ; i = (i + 1) & mask ) {
+			Slot &slot = m_slots[i];
+			if ( is_empty(slot) ) {
+				slot.key = key;
+				++m_size;
+				return std::make_pair(&slot, true);
+			}
+			if ( CXCursorEqual()(slot.key, key) ) {
+				return std::make_pair(&slot, false);
+			}
+		}
+	}
+
+	bool erase_slot(const CXCursor &key) {
+		Slot *slot = find_slot(key);
+		if ( !slot ) {
+			return false;
+		}
+
+		// backward shift deletion keeps probe sequences intact without tombstones
+		const std::size_t mask{m_slots.size() - 1};
+		std::size_t hole{static_cast<std::size_t>(slot - m_slots.data())};
+		for ( std::size_t i{(hole + 1) & mask}; !is_empty(m_slots[i]); i = (i + 1) & mask ) {
+			const std::size_t home{CXCursorHash()(m_slots[i].key) & mask};
+			if ( ((i - home) & mask) >= ((i - hole) & mask) ) {
+				m_slots[hole] = std::move(m_slots[i]);
+				hole = i;
+			}
+		}
+		m_slots[hole] = Slot();
+		--m_size;
+		return true;
+	}
+
+  private:
+	static bool is_empty(const Slot &slot) noexcept {
+		return slot.key.kind == s_empty_kind;
+	}
+
+	void rehash(std::size_t slot_count) {
+		std::vector<Slot> slots(slot_count);
+		std::swap(m_slots, slots);
+		const std::size_t mask{slot_count - 1};
+		for ( auto &slot : slots ) {
+			if ( is_empty(slot) ) {
+				continue;
+			}
+			std::size_t i{CXCursorHash()(slot.key) & mask};
+			while ( !is_empty(m_slots[i]) ) {
+				i = (i + 1) & mask;
+			}
+			m_slots[i] = std::move(slot);
+		}
+	}
+}; // class CursorTable
+
+template<typename T>
+struct CursorMapSlot
+{
+	CXCursor	key{};
+	T			value{};
+}; // struct CursorMapSlot
+
+struct CursorSetSlot
+{
+	CXCursor	key{};
+}; // struct CursorSetSlot
+
+} // namespace detail
+
+template<typename T>
+class CursorMap: public detail::CursorTable<detail::CursorMapSlot<T>>
+{
+  private:
+	using Base	= detail::CursorTable<detail::CursorMapSlot<T>>;
+
+  public:
+	using Slot	= detail::CursorMapSlot<T>;
+
+  public:
+	using Base::Base;
+
+  public:
+	T *find(const CXCursor &key) noexcept {
+		Slot *slot = this->find_slot(key);
+		return slot ? &slot->value : nullptr;
+	}
+
+	const T *find(const CXCursor &key) const noexcept {
+		const Slot *slot = this->find_slot(key);
+		return slot ? &slot->value : nullptr;
+	}
+
+	T *find(const Cursor &key) noexcept {
+		return find(key.native_handle());
+	}
+
+	const T *find(const Cursor &key) const noexcept {
+		return find(key.native_handle());
+	}
+
+	//! @return the value mapped to @a key and whether @a value has been inserted.
+	std::pair<T *, bool> insert(const CXCursor &key, T value) {
+		const auto result = this->insert_slot(key);
+		if ( result.second ) {
+			result.first->value = std::move(value);
+		}
+		return std::make_pair(&result.first->value, result.second);
+	}
+
+	std::pair<T *, bool> insert(const Cursor &key, T value) {
+		return insert(key.native_handle(), std::move(value));
+	}
+
+	T &operator[](const CXCursor &key) {
+		return this->insert_slot(key).first->value;
+	}
+
+	T &operator[](const Cursor &key) {
+		return (*this)[key.native_handle()];
+	}
+
+	bool erase(const CXCursor &key) {
+		return this->erase_slot(key);
+	}
+
+	bool erase(const Cursor &key) {
+		return erase(key.native_handle());
+	}
+}; // class CursorMap
+
+class CursorSet: public detail::CursorTable<detail::CursorSetSlot>
+{
+  private:
+	using Base	= detail::CursorTable<detail::CursorSetSlot>;
+
+  public:
+	using Slot	= detail::CursorSetSlot;
+
+  public:
+	using Base::Base;
+
+  public:
+	bool contains(const CXCursor &key) const noexcept {
+		return find_slot(key) != nullptr;
+	}
+
+	bool contains(const Cursor &key) const noexcept {
+		return contains(key.native_handle());
+	}
+
+	//! @return true if @a key was not in the set yet.
+	bool insert(const CXCursor &key) {
+		return insert_slot(key).second;
+	}
+
+	bool insert(const Cursor &key) {
+		return insert(key.native_handle());
+	}
+
+	bool erase(const CXCursor &key) {
+		return erase_slot(key);
+	}
+
+	bool erase(const Cursor &key) {
+		return erase(key.native_handle());
+	}
+}; // class CursorSet
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_CursorMap_hpp
@@ -19,13 +19,14 @@ namespace clangxx {
 class CLANGXX_API Exception: public std::exception
 {
   public:
+	//! Throw site; @a file and @a function point to static strings (__FILE__, __func__).
 	struct Where
 	{
-		std::string	file;
-		std::string	function;
+		const char	*file;
+		const char	*function;
 		std::size_t	line{0};
 
-		Where(const std::string &file, const std::string &function, std::size_t line)
+		constexpr Where(const char *file, const char *function, std::size_t line) noexcept
 			: file(file)
 			, function(function)
 			, line(line)
@@ -55,6 +56,15 @@ class CLANGXX_API LogicError: public std::logic_error, public Exception
 	{}
 }; // class LogicError
 
+class CLANGXX_API QuerySyntaxError: public LogicError
+{
+  private:
+	using Base	= LogicError;
+
+  public:
+	using Base::Base;
+}; // class QuerySyntaxError
+
 class CLANGXX_API RuntimeError: public std::runtime_error, public Exception
 {
   public:
@@ -111,11 +121,14 @@ class CLANGXX_API LibclangError: public Exception
 
 
 #define CLANGXX_CONSTRUCT_Exception_Where \
-	Exception::Where(__FILE__, __func__, __LINE__)
+	clangxx::Exception::Where(__FILE__, __func__, __LINE__)
 
 #define CLANGXX_THROW_LogicError(d_what) \
 	throw clangxx::LogicError((d_what), CLANGXX_CONSTRUCT_Exception_Where)
 
+#define CLANGXX_THROW_QuerySyntaxError(d_what) \
+	throw clangxx::QuerySyntaxError((d_what), CLANGXX_CONSTRUCT_Exception_Where)
+
 #define CLANGXX_THROW_RuntimeError(d_what) \
 	throw clangxx::RuntimeError((d_what), CLANGXX_CONSTRUCT_Exception_Where)
 
@@ -7,12 +7,17 @@
 #ifndef clang_cpp_File_hpp
 #define clang_cpp_File_hpp
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <time.h>
 #include <utility>
 #include "clang-c/Index.h"
+#include "clang-cpp/FileTable.hpp"
+#include "clang-cpp/FileUniqueID.hpp"
+#include "clang-cpp/Result.hpp"
 #include "clang-cpp/switch_port.hpp"
 
 
@@ -26,15 +31,21 @@ class CLANGXX_API File
 	static File from_name(std::shared_ptr<const TranslationUnit> translation_unit,
 						  const std::string &file_name);
 
+	static File from_native_handle(CXFile cx_file,
+								   std::shared_ptr<const TranslationUnit> translation_unit);
+
 //	static File from_cursor_result(Cursor cursor);
 
   private:
 	std::shared_ptr<const TranslationUnit>	m_translation_unit;
 	// warning: define m_translation_unit before m_cx_file
-	CXFile	m_cx_file;
+	CXFile			m_cx_file;
+	FileTable::Id	m_id;
+	FileUniqueID	m_unique_id;
 
   private:
-	File(CXFile &&cx_file, std::shared_ptr<const TranslationUnit> &translation_unit) noexcept;
+	File(CXFile &&cx_file, std::shared_ptr<const TranslationUnit> &translation_unit,
+		 FileTable::Id id, const FileUniqueID &unique_id) noexcept;
 
   public:
 	~File();
@@ -46,10 +57,41 @@ class CLANGXX_API File
 	File &operator=(File &&other) noexcept;
 
   public:
+	bool operator==(const File &other) const noexcept {
+		return m_unique_id == other.m_unique_id;
+	}
+
+	bool operator!=(const File &other) const noexcept {
+		return !(*this == other);
+	}
+
+	CXFile native_handle() const noexcept {
+		return m_cx_file;
+	}
+
+	std::shared_ptr<const TranslationUnit> translation_unit() const {
+		return m_translation_unit;
+	}
+
+	FileTable::Id id() const noexcept {
+		return m_id;
+	}
+
 	std::string name() const;
 
+	//! name() without throwing.
+	Result<std::string> try_name() const noexcept;
+
 	time_t time() const;
 
+	const FileUniqueID &unique_id() const noexcept {
+		return m_unique_id;
+	}
+
+	bool is_multiple_include_guarded() const;
+
+	Result<bool> try_is_multiple_include_guarded() const noexcept;
+
 	std::string str() const {
 		return name();
 	}
@@ -64,5 +106,17 @@ inline std::ostream &operator<<(std::ostream &os, const File &file)
 
 } //namespace clangxx
 
+namespace std {
+
+template<>
+struct hash<clangxx::File>
+{
+	size_t operator()(const clangxx::File &file) const noexcept {
+		return hash<clangxx::FileUniqueID>()(file.unique_id());
+	}
+};
+
+} // namespace std
+
 
 #endif // clang_cpp_File_hpp
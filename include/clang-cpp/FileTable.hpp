@@ -0,0 +1,87 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file FileTable.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_FileTable_hpp
+#define clang_cpp_FileTable_hpp
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <time.h>
+#include <unordered_map>
+#include "clang-c/Index.h"
+#include "clang-cpp/FileUniqueID.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Dense ids for the files of one translation unit, with their metadata
+  cached at first sight.  A reparse invalidates the CXFile handles, so the
+  table is cleared then and rebuilt lazily; ids are valid until the next
+  reparse, like the handles they cache.  Entries are handed out by copy,
+  since the table may be cleared concurrently.
+*/
+class CLANGXX_API FileTable
+{
+  public:
+	using Id	= unsigned int;
+
+	static const Id	invalid_id	= static_cast<Id>(-1);
+
+	struct Entry
+	{
+		CXFile			cx_file;
+		FileUniqueID	unique_id;
+		std::string		name;
+		time_t			time;
+		bool			is_multiple_include_guarded;
+	}; // struct Entry
+
+  private:
+	CXTranslationUnit						m_cx_translation_unit;
+	mutable std::mutex						m_mutex;
+	std::deque<Entry>						m_entries;
+	std::unordered_map<CXFile, Id>			m_ids;
+	std::unordered_map<FileUniqueID, Id>	m_unique_ids;
+	std::unordered_map<std::string, Id>		m_names;
+
+  public:
+	explicit FileTable(CXTranslationUnit cx_translation_unit);
+	~FileTable();
+
+	FileTable(const FileTable &) = delete;
+	FileTable &operator=(const FileTable &) = delete;
+
+  public:
+	//! @return the id of @a cx_file, assigning a new one on first sight.
+	Id id_of(CXFile cx_file);
+
+	//! @return the id of the file named @a file_name, or invalid_id.
+	Id find(const std::string &file_name);
+
+	//! @return the id of the file with @a unique_id, or invalid_id.
+	Id find(const FileUniqueID &unique_id) const;
+
+	Entry entry(Id id) const;
+
+	//! @return false if @a id is not valid; otherwise sets @a entry.
+	bool find_entry(Id id, Entry &entry) const;
+
+	std::size_t size() const;
+
+	void clear();
+
+  private:
+	Id insert(CXFile cx_file);
+}; // class FileTable
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_FileTable_hpp
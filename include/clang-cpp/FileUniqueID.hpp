@@ -0,0 +1,59 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file FileUniqueID.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_FileUniqueID_hpp
+#define clang_cpp_FileUniqueID_hpp
+
+#include <cstddef>
+#include <functional>
+#include "clang-c/Index.h"
+
+
+namespace clangxx {
+
+struct FileUniqueID
+{
+	unsigned long long	data[3];
+
+	FileUniqueID() noexcept
+		: data{}
+	{}
+
+	explicit FileUniqueID(const CXFileUniqueID &cx_file_unique_id) noexcept
+		: data{cx_file_unique_id.data[0], cx_file_unique_id.data[1], cx_file_unique_id.data[2]}
+	{}
+
+	friend bool operator==(const FileUniqueID &lhs, const FileUniqueID &rhs) noexcept {
+		return lhs.data[0] == rhs.data[0]
+			&& lhs.data[1] == rhs.data[1]
+			&& lhs.data[2] == rhs.data[2];
+	}
+
+	friend bool operator!=(const FileUniqueID &lhs, const FileUniqueID &rhs) noexcept {
+		return !(lhs == rhs);
+	}
+}; // struct FileUniqueID
+
+} // namespace clangxx
+
+namespace std {
+
+template<>
+struct hash<clangxx::FileUniqueID>
+{
+	size_t operator()(const clangxx::FileUniqueID &unique_id) const noexcept {
+		const hash<unsigned long long> hasher;
+		size_t seed{hasher(unique_id.data[0])};
+		seed ^= hasher(unique_id.data[1]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		seed ^= hasher(unique_id.data[2]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		return seed;
+	}
+};
+
+} // namespace std
+
+
+#endif // clang_cpp_FileUniqueID_hpp
@@ -0,0 +1,65 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file HeaderDeduplicator.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_HeaderDeduplicator_hpp
+#define clang_cpp_HeaderDeduplicator_hpp
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "clang-c/Index.h"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/FileUniqueID.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Set of headers already visited in a session, shared by the traversals of
+  many translation units (possibly on several threads).  Only headers with
+  an include guard are deduplicated, keyed by their file unique ID.
+*/
+class CLANGXX_API HeaderDeduplicator
+{
+  public:
+	using FileDecisions	= std::unordered_map<CXFile, bool>;
+
+  private:
+	mutable std::mutex					m_mutex;
+	std::unordered_set<FileUniqueID>	m_processed;
+
+  public:
+	HeaderDeduplicator();
+	~HeaderDeduplicator();
+
+	HeaderDeduplicator(const HeaderDeduplicator &) = delete;
+	HeaderDeduplicator &operator=(const HeaderDeduplicator &) = delete;
+
+  public:
+	//! @return true if the caller is the first one to claim @a unique_id.
+	bool claim(const FileUniqueID &unique_id);
+
+	bool is_processed(const FileUniqueID &unique_id) const;
+
+	std::size_t size() const;
+
+	void clear();
+
+	//! @return whether the top-level declaration @a cx_cursor has to be visited.
+	bool should_visit(CXTranslationUnit cx_translation_unit, CXCursor cx_cursor,
+					  FileDecisions &decisions);
+
+	//! Visits the children of @a cursor, skipping top-level declarations of
+	//! headers already processed by another traversal.
+	void visit(const Cursor &cursor, const Cursor::Visitor &visitor);
+}; // class HeaderDeduplicator
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_HeaderDeduplicator_hpp
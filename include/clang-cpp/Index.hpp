@@ -19,13 +19,16 @@
 
 namespace clangxx {
 
+class ModuleCache;
+
 class CLANGXX_API Index: public std::enable_shared_from_this<Index>
 {
   public:
 	static std::shared_ptr<Index> create(bool excludeDecls = false);
 
   private:
-	UniqueCXIndex	m_cx_index;
+	UniqueCXIndex					m_cx_index;
+	std::shared_ptr<ModuleCache>	m_module_cache;
 
   private:
 	Index(UniqueCXIndex &&cx_index) noexcept;
@@ -44,6 +47,15 @@ class CLANGXX_API Index: public std::enable_shared_from_this<Index>
 		return m_cx_index.get();
 	}
 
+	//! Parses the translation units of this index with -fmodules, using @a module_cache.
+	void set_module_cache(std::shared_ptr<ModuleCache> module_cache) {
+		std::atomic_store(&m_module_cache, std::move(module_cache));
+	}
+
+	std::shared_ptr<ModuleCache> module_cache() const {
+		return std::atomic_load(&m_module_cache);
+	}
+
 	std::shared_ptr<TranslationUnit> read(const std::string &path) {
 		return TranslationUnit::from_ast_file(path, shared_from_this());
 	}
@@ -0,0 +1,139 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file MacroIndex.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_MacroIndex_hpp
+#define clang_cpp_MacroIndex_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/SymbolTable.hpp"
+#include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/UnsavedFile.hpp"
+
+
+namespace clangxx {
+
+class Index;
+class TranslationUnit;
+
+/*!
+  Macro definitions and expansion sites of a set of translation units, keyed
+  by macro name.  Sites in headers shared by several translation units are
+  recorded once.  Thread-safe.
+*/
+class CLANGXX_API MacroIndex
+{
+  public:
+	struct Location
+	{
+		std::string		filename;
+		unsigned int	line{};
+		unsigned int	column{};
+		unsigned int	offset{};
+	}; // struct Location
+
+  private:
+	struct Site
+	{
+		SymbolTable::Id	file;
+		unsigned int	line;
+		unsigned int	column;
+		unsigned int	offset;
+	}; // struct Site
+
+	struct Entry
+	{
+		std::vector<Site>	definitions;
+		std::vector<Site>	expansions;
+	}; // struct Entry
+
+	//! A site seen before, from another translation unit sharing its file.
+	struct SiteKey
+	{
+		SymbolTable::Id	file;
+		unsigned int	offset;
+		bool			is_definition;
+
+		bool operator==(const SiteKey &other) const noexcept {
+			return file == other.file && offset == other.offset
+				&& is_definition == other.is_definition;
+		}
+	}; // struct SiteKey
+
+	struct SiteKeyHash
+	{
+		std::size_t operator()(const SiteKey &key) const noexcept {
+			std::uint64_t value{(static_cast<std::uint64_t>(key.file) << 32) ^ key.offset};
+			value ^= key.is_definition ? 0x9e3779b97f4a7c15ULL : 0;
+			value ^= value >> 33;
+			value *= 0xff51afd7ed558ccdULL;
+			value ^= value >> 33;
+			value *= 0xc4ceb9fe1a85ec53ULL;
+			value ^= value >> 33;
+			return static_cast<std::size_t>(value);
+		}
+	}; // struct SiteKeyHash
+
+  private:
+	mutable std::mutex							m_mutex;
+	SymbolTable									m_names;
+	SymbolTable									m_files;
+	std::unordered_map<SymbolTable::Id, Entry>	m_entries;
+	std::unordered_set<SiteKey, SiteKeyHash>	m_seen;
+
+  public:
+	MacroIndex();
+	~MacroIndex();
+
+	MacroIndex(const MacroIndex &) = delete;
+	MacroIndex &operator=(const MacroIndex &) = delete;
+
+  public:
+	/*!
+	  Parses @a filename with the detailed preprocessing record enabled and
+	  adds its macros.
+	*/
+	std::shared_ptr<TranslationUnit> parse(
+	  const std::string &filename, const std::vector<std::string> *args = nullptr,
+	  const std::vector<UnsavedFile> *unsaved_files = nullptr,
+	  CXTranslationUnit_Flags options = CXTranslationUnit_None,
+	  std::shared_ptr<Index> index = nullptr);
+
+	/*!
+	  Adds the macros of @a translation_unit, which must have been parsed with
+	  CXTranslationUnit_DetailedPreprocessingRecord.  Only the top-level
+	  children of the translation unit are scanned.
+	*/
+	void add(const TranslationUnit &translation_unit);
+
+	void add(const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+			 unsigned int thread_count = 0);
+
+	std::vector<Location> definitions(const std::string &name) const;
+
+	std::vector<Location> expansions(const std::string &name) const;
+
+	std::vector<std::string> names() const;
+
+	std::size_t size() const;
+
+	void clear();
+
+  private:
+	Location location(const Site &site) const;
+}; // class MacroIndex
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_MacroIndex_hpp
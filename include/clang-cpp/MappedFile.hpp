@@ -0,0 +1,153 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file MappedFile.hpp
+
+   Copyright (c) 2015 pegacorn
+
+   Read-only memory mapping of a whole file.  Header-only and independent of
+   libclang, so that readers of exported files need not link it.
+*/
+#ifndef clang_cpp_MappedFile_hpp
+#define clang_cpp_MappedFile_hpp
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#if defined _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+namespace clangxx {
+
+class MappedFile
+{
+  private:
+	const char	*m_data{nullptr};
+	std::size_t	m_size{0};
+
+  public:
+	MappedFile() = default;
+
+	explicit MappedFile(const std::string &path) {
+		open(path);
+	}
+
+	~MappedFile() {
+		close();
+	}
+
+	MappedFile(const MappedFile &) = delete;
+
+	MappedFile(MappedFile &&other) noexcept
+		: m_data(other.m_data)
+		, m_size(other.m_size)
+	{
+		other.m_data = nullptr;
+		other.m_size = 0;
+	}
+
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	MappedFile &operator=(MappedFile &&other) noexcept {
+		if ( this != &other ) {
+			close();
+			m_data = other.m_data;
+			m_size = other.m_size;
+			other.m_data = nullptr;
+			other.m_size = 0;
+		}
+		return *this;
+	}
+
+  public:
+	const char *data() const noexcept {
+		return m_data;
+	}
+
+	std::size_t size() const noexcept {
+		return m_size;
+	}
+
+	explicit operator bool() const noexcept {
+		return m_data != nullptr;
+	}
+
+#if defined _WIN32
+	void open(const std::string &path) {
+		close();
+		HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+									OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if ( file == INVALID_HANDLE_VALUE ) {
+			throw std::runtime_error("Error opening " + path);
+		}
+		LARGE_INTEGER size;
+		if ( !::GetFileSizeEx(file, &size) || size.QuadPart == 0 ) {
+			::CloseHandle(file);
+			throw std::runtime_error("Error mapping empty file " + path);
+		}
+		HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		::CloseHandle(file);
+		if ( !mapping ) {
+			throw std::runtime_error("Error mapping " + path);
+		}
+		const void *data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		::CloseHandle(mapping);
+		if ( !data ) {
+			throw std::runtime_error("Error mapping " + path);
+		}
+		m_data = static_cast<const char *>(data);
+		m_size = static_cast<std::size_t>(size.QuadPart);
+	}
+
+	void close() noexcept {
+		if ( m_data ) {
+			::UnmapViewOfFile(m_data);
+			m_data = nullptr;
+			m_size = 0;
+		}
+	}
+#else
+	void open(const std::string &path) {
+		close();
+		const int fd{::open(path.c_str(), O_RDONLY)};
+		if ( fd < 0 ) {
+			throw std::runtime_error("Error opening " + path);
+		}
+		struct stat status;
+		if ( ::fstat(fd, &status) != 0 || status.st_size == 0 ) {
+			::close(fd);
+			throw std::runtime_error("Error mapping empty file " + path);
+		}
+		void *data = ::mmap(nullptr, static_cast<std::size_t>(status.st_size),
+							PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if ( data == MAP_FAILED ) {
+			throw std::runtime_error("Error mapping " + path);
+		}
+		m_data = static_cast<const char *>(data);
+		m_size = static_cast<std::size_t>(status.st_size);
+	}
+
+	void close() noexcept {
+		if ( m_data ) {
+			::munmap(const_cast<char *>(m_data), m_size);
+			m_data = nullptr;
+			m_size = 0;
+		}
+	}
+#endif
+}; // class MappedFile
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_MappedFile_hpp
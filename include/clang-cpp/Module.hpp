@@ -0,0 +1,89 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Module.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Module_hpp
+#define clang_cpp_Module_hpp
+
+#include <functional>
+#include <memory>
+#include <string>
+#include "clang-c/Index.h"
+#include "clang-cpp/File.hpp"
+#include "clang-cpp/Reader.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class Cursor;
+class TranslationUnit;
+
+//! Module imported by a translation unit parsed with -fmodules.
+class CLANGXX_API Module
+{
+  public:
+	using Headers	= RandomAccessReader<File, unsigned int, std::function<File(unsigned int)>>;
+
+  public:
+	//! @return the module @a file belongs to; null if it is not part of one.
+	static Module from_file(const File &file);
+
+	//! @return the module imported by the ModuleImportDecl @a cursor.
+	static Module from_import(const Cursor &cursor);
+
+  private:
+	std::shared_ptr<const TranslationUnit>	m_translation_unit;
+	// warning: define m_translation_unit before m_cx_module
+	CXModule	m_cx_module;
+
+  private:
+	Module(CXModule cx_module, std::shared_ptr<const TranslationUnit> translation_unit) noexcept;
+
+  public:
+	~Module();
+
+	Module(const Module &other);
+	Module(Module &&other) noexcept;
+
+	Module &operator=(const Module &other);
+	Module &operator=(Module &&other) noexcept;
+
+  public:
+	bool operator==(const Module &other) const noexcept {
+		return m_cx_module == other.m_cx_module;
+	}
+
+	bool operator!=(const Module &other) const noexcept {
+		return !(*this == other);
+	}
+
+	explicit operator bool() const noexcept {
+		return m_cx_module != nullptr;
+	}
+
+	CXModule native_handle() const noexcept {
+		return m_cx_module;
+	}
+
+	File ast_file() const;
+
+	Module parent() const;
+
+	std::string name() const;
+
+	std::string full_name() const;
+
+	bool is_system() const noexcept {
+		return clang_Module_isSystem(m_cx_module) != 0;
+	}
+
+	Headers top_level_headers() const;
+}; // class Module
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Module_hpp
@@ -0,0 +1,90 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ModuleCache.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_ModuleCache_hpp
+#define clang_cpp_ModuleCache_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Directory of implicitly built modules shared by the translation units of
+  an Index (see Index::set_module_cache()).  Clang serializes concurrent
+  builds of a module with lock files; this class only keeps the directory
+  under a size limit, removing the least recently used module files that no
+  live translation unit has loaded.
+*/
+class CLANGXX_API ModuleCache
+{
+  private:
+	const std::string		m_directory;
+	const std::uint64_t		m_size_limit;
+	const unsigned int		m_prune_interval;
+	std::mutex				m_mutex;
+	std::atomic<unsigned int>	m_parse_count{0};
+	//! canonical paths of the module files loaded by live translation units
+	std::unordered_map<std::string, unsigned int>	m_in_use;
+
+  public:
+	/*!
+	  @param size_limit		bytes; 0 disables pruning.
+	  @param prune_interval	number of parses between two automatic prunings.
+	*/
+	explicit ModuleCache(std::string directory, std::uint64_t size_limit = 0,
+						 unsigned int prune_interval = 64);
+	~ModuleCache();
+
+	ModuleCache(const ModuleCache &) = delete;
+	ModuleCache &operator=(const ModuleCache &) = delete;
+
+  public:
+	const std::string &directory() const noexcept {
+		return m_directory;
+	}
+
+	std::uint64_t size_limit() const noexcept {
+		return m_size_limit;
+	}
+
+	//! @return the parse arguments enabling modules with this cache.
+	std::vector<std::string> arguments() const;
+
+	/*!
+	  Keeps @a module_files from being pruned until they are released.
+	  @return the files retained, to be passed to release().
+	*/
+	std::vector<std::string> retain(const std::vector<std::string> &module_files);
+
+	//! Releases module files returned by retain().
+	void release(const std::vector<std::string> &module_files) noexcept;
+
+	//! Called after each parse; prunes every prune_interval parses.
+	void note_parse();
+
+	//! @return the total size of the module files, in bytes.
+	std::uint64_t size();
+
+	/*!
+	  Removes the least recently used module files until the cache fits in
+	  the size limit.  Retained files are kept, as are files written in the
+	  last minute, which may still be in use by a concurrent build.
+	  @return the number of bytes removed.
+	*/
+	std::uint64_t prune();
+}; // class ModuleCache
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_ModuleCache_hpp
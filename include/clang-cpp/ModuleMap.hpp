@@ -0,0 +1,51 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ModuleMap.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_ModuleMap_hpp
+#define clang_cpp_ModuleMap_hpp
+
+#include <string>
+#include "clang-c/BuildSystem.h"
+#include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace clangxx {
+
+//! Builder of a framework module.map file.
+class CLANGXX_API ModuleMap
+{
+  private:
+	UniqueCXModuleMapDescriptor	m_cx_descriptor;
+
+  public:
+	ModuleMap();
+	~ModuleMap();
+
+	ModuleMap(const ModuleMap &) = delete;
+	ModuleMap(ModuleMap &&other) noexcept;
+
+	ModuleMap &operator=(const ModuleMap &) = delete;
+	ModuleMap &operator=(ModuleMap &&other) noexcept;
+
+  public:
+	CXModuleMapDescriptor native_handle() const noexcept {
+		return m_cx_descriptor.get();
+	}
+
+	ModuleMap &set_framework_module_name(const std::string &name);
+
+	ModuleMap &set_umbrella_header(const std::string &name);
+
+	std::string str() const;
+
+	void write(const std::string &path) const;
+}; // class ModuleMap
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_ModuleMap_hpp
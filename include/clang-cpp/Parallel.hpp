@@ -0,0 +1,30 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Parallel.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Parallel_hpp
+#define clang_cpp_Parallel_hpp
+
+#include <cstddef>
+#include <functional>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Calls @a function for every index in [0, @a count) on up to
+  @a thread_count threads (0: hardware concurrency).  Indices are handed
+  out one at a time, so uneven work items balance themselves.  The first
+  exception thrown by @a function is rethrown once every thread stopped.
+*/
+CLANGXX_API void parallel_for(std::size_t count,
+							  const std::function<void(std::size_t index)> &function,
+							  unsigned int thread_count = 0);
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Parallel_hpp
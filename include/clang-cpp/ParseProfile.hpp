@@ -0,0 +1,76 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ParseProfile.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_ParseProfile_hpp
+#define clang_cpp_ParseProfile_hpp
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  What earlier runs learnt about each source file: how long it took to parse
+  and a MinHash signature of the set of files it includes.  Used by
+  BatchParser to schedule jobs; can be saved and loaded between runs.
+  Thread-safe.
+*/
+class CLANGXX_API ParseProfile
+{
+  public:
+	static const std::size_t	s_signature_size	= 16;
+
+	using Signature	= std::array<std::uint32_t, s_signature_size>;
+
+	struct Entry
+	{
+		double		seconds{};
+		Signature	signature{};
+	}; // struct Entry
+
+  public:
+	static Signature signature(const std::vector<std::string> &includes);
+
+	//! @return the estimated Jaccard similarity of the include sets behind @a lhs and @a rhs.
+	static double similarity(const Signature &lhs, const Signature &rhs) noexcept;
+
+  private:
+	mutable std::mutex						m_mutex;
+	std::unordered_map<std::string, Entry>	m_entries;
+
+  public:
+	ParseProfile();
+	~ParseProfile();
+
+	ParseProfile(const ParseProfile &) = delete;
+	ParseProfile &operator=(const ParseProfile &) = delete;
+
+  public:
+	//! @return false if @a path could not be read; the profile is then left empty.
+	bool load(const std::string &path);
+
+	void save(const std::string &path) const;
+
+	void record(const std::string &filename, double seconds,
+				const std::vector<std::string> &includes);
+
+	//! @return true and sets @a entry if @a filename has been parsed before.
+	bool find(const std::string &filename, Entry &entry) const;
+
+	std::size_t size() const;
+}; // class ParseProfile
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_ParseProfile_hpp
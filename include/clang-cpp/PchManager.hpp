@@ -0,0 +1,91 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file PchManager.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_PchManager_hpp
+#define clang_cpp_PchManager_hpp
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "clang-cpp/BatchParser.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class Index;
+
+/*!
+  Precompiled headers shared by the jobs of a batch.
+
+  Jobs whose sources start with the same #include lines, and that are parsed
+  with the same arguments, form a group.  The shared lines are written to a
+  generated header in the manager's directory; the header is parsed, saved
+  as a PCH and passed to each job of the group with -include-pch.  Since the
+  sources still include those headers, the shared lines end before the first
+  header without include guards or #pragma once.  A PCH is rebuilt when one
+  of the files it includes is not older than it; different arguments give a
+  different PCH.  Concurrent prepare() calls build a given PCH once, and the
+  generated files are written under temporary names then renamed into place,
+  so a parse never reads a partly written one.
+*/
+class CLANGXX_API PchManager
+{
+  private:
+	struct Pch
+	{
+		std::string					path;
+		std::vector<std::string>	dependencies;
+	}; // struct Pch
+
+  private:
+	const std::string						m_directory;
+	const std::size_t						m_min_group_size;
+	std::mutex								m_mutex;
+	std::unordered_map<std::string, Pch>	m_pchs;
+	//! keys of the PCHs being built; m_built is notified when one is done
+	std::unordered_set<std::string>			m_building;
+	std::condition_variable					m_built;
+
+  public:
+	/*!
+	  @param directory		where generated headers and PCHs are kept; must exist.
+	  @param min_group_size	smallest number of jobs worth a PCH.
+	*/
+	explicit PchManager(std::string directory, std::size_t min_group_size = 2);
+	~PchManager();
+
+	PchManager(const PchManager &) = delete;
+	PchManager &operator=(const PchManager &) = delete;
+
+  public:
+	//! @return the #include lines at the top of @a filename, before any other code.
+	static std::vector<std::string> leading_includes(const std::string &filename);
+
+	//! Builds or reuses the PCHs of @a jobs and adds -include-pch to their args.
+	void prepare(std::vector<ParseJob> &jobs, std::shared_ptr<Index> index,
+				 unsigned int thread_count = 0);
+
+	//! Forgets the PCHs built so far; they are rebuilt on the next prepare().
+	void invalidate();
+
+  private:
+	std::string build(const std::string &key, const std::vector<std::string> &includes,
+					  const std::vector<std::string> &args, const std::string &language,
+					  std::shared_ptr<Index> &index);
+
+	bool is_up_to_date(const Pch &pch) const;
+}; // class PchManager
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_PchManager_hpp
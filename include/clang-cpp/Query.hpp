@@ -0,0 +1,83 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Query.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Query_hpp
+#define clang_cpp_Query_hpp
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "clang-cpp/Arena.hpp"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class TranslationUnit;
+
+/*!
+  Cursor query compiled from a selector such as
+  @code ClassDecl > CXXMethod[static][name^="get"] @endcode
+
+  A selector is a chain of steps joined by ' ' (descendant) or '>' (child).
+  A step is a cursor kind name (e.g. ClassDecl, CLASS_DECL) or '*',
+  followed by attributes:
+  - flags: [definition] [static] [virtual] [pure] [const] [bitfield]
+	[variadic] [public] [protected] [private]
+  - strings: [name OP "value"], [displayname OP "value"], [usr OP "value"]
+	with OP one of = ^= $= *=
+
+  When no step can match a statement or an expression, statement and
+  expression subtrees (function bodies) are not searched.
+*/
+class CLANGXX_API Query
+{
+	class Plan;
+
+  public:
+	using Callback	= std::function<void(const Cursor &cursor)>;
+
+  public:
+	static Query compile(const std::string &selector);
+
+  private:
+	std::shared_ptr<const Plan>	m_plan;
+
+  private:
+	explicit Query(std::shared_ptr<const Plan> plan) noexcept;
+
+  public:
+	~Query();
+
+	Query(const Query &other);
+	Query(Query &&other) noexcept;
+
+	Query &operator=(const Query &other);
+	Query &operator=(Query &&other) noexcept;
+
+  public:
+	const std::string &selector() const noexcept;
+
+	//! Calls @a callback for every matching descendant of @a root, in preorder.
+	void match(const Cursor &root, const Callback &callback) const;
+
+	std::vector<Cursor> match(const Cursor &root) const;
+
+	//! match() into @a arena, to be dropped with it at the end of a request.
+	ArenaVector<Cursor> match(const Cursor &root, Arena &arena) const;
+
+	//! Matches every translation unit on its own thread.
+	std::vector<std::vector<Cursor>> match(
+	  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+	  unsigned int thread_count = 0) const;
+}; // class Query
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Query_hpp
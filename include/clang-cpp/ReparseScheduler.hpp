@@ -0,0 +1,144 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ReparseScheduler.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_ReparseScheduler_hpp
+#define clang_cpp_ReparseScheduler_hpp
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "clang-cpp/UnsavedFile.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class TranslationUnit;
+
+/*!
+  Reparses one translation unit in the background from a stream of
+  unsaved-buffer updates, as an editor produces them.
+
+  Only the latest update is kept: one arriving before the pending one
+  has been started replaces it.  A reparse starts once no update has
+  arrived for a delay adapted to the measured reparse cost (a moving
+  average scaled by Options::cost_factor, clamped to
+  [Options::min_delay, Options::max_delay]), and at the latest
+  Options::max_delay after the oldest update it covers.  Cheap
+  translation units are thus reparsed right away, while expensive ones
+  wait for a pause in typing instead of being reparsed for contents
+  already outdated.
+
+  Every update gets a version number; consumers are called back, or
+  can wait(), when a version is ready, and read the translation unit
+  through access() so that it is never observed in the middle of a
+  reparse.  A version whose reparse failed never becomes ready; it is
+  reported through the callback and failed_version() instead.
+*/
+class CLANGXX_API ReparseScheduler
+{
+  public:
+	using Version	= std::uint64_t;
+	using Duration	= std::chrono::steady_clock::duration;
+
+	struct Options
+	{
+		std::chrono::milliseconds	min_delay{0};
+		std::chrono::milliseconds	max_delay{500};
+		double						cost_factor{0.5};
+		//! weight of the latest reparse in the moving average of the cost.
+		double						smoothing{0.3};
+	}; // struct Options
+
+	struct Stats
+	{
+		std::size_t	updates;
+		std::size_t	reparses;
+		//! updates replaced by a newer one before being parsed.
+		std::size_t	superseded;
+		std::size_t	failures;
+	}; // struct Stats
+
+	//! Called on the scheduler thread after the reparse of @a version; @a error is null on success.
+	using Callback	= std::function<void(Version version, std::exception_ptr error)>;
+
+  private:
+	using Clock	= std::chrono::steady_clock;
+
+	const std::shared_ptr<TranslationUnit>	m_translation_unit;
+	const Options				m_options;
+
+	mutable std::mutex			m_mutex;
+	std::condition_variable		m_updated;
+	std::condition_variable		m_ready;
+	Callback					m_callback;
+	std::vector<UnsavedFile>	m_pending;
+	bool						m_has_pending{false};
+	Version						m_pending_version{0};
+	Version						m_ready_version{0};
+	Version						m_failed_version{0};
+	Clock::time_point			m_first_update;
+	Clock::time_point			m_last_update;
+	//! moving average of the reparse cost, in seconds; negative until measured.
+	double						m_cost{-1.0};
+	Stats						m_stats{0, 0, 0, 0};
+	bool						m_stopping{false};
+
+	//! held during reparses and access().
+	std::mutex					m_translation_unit_mutex;
+	std::thread					m_thread;
+
+  public:
+	explicit ReparseScheduler(std::shared_ptr<TranslationUnit> translation_unit);
+	ReparseScheduler(std::shared_ptr<TranslationUnit> translation_unit, Options options);
+	//! Drops the pending update and waits for the reparse in progress.
+	~ReparseScheduler();
+
+	ReparseScheduler(const ReparseScheduler &) = delete;
+	ReparseScheduler &operator=(const ReparseScheduler &) = delete;
+
+  public:
+	void set_callback(Callback callback);
+
+	//! Schedules a reparse with @a unsaved_files; @return the version of the update.
+	Version update(std::vector<UnsavedFile> unsaved_files);
+
+	/*!
+	  Blocks until @a version, or a later one, is ready or has failed.
+	  @return the ready version, lower than @a version if the reparse failed.
+	*/
+	Version wait(Version version);
+
+	//! @return the version the translation unit reflects; 0 before the first successful reparse.
+	Version ready_version() const;
+
+	//! @return the latest version whose reparse failed; 0 if none did.
+	Version failed_version() const;
+
+	//! Calls @a function with the translation unit and its version, while no reparse runs.
+	void access(const std::function<void(TranslationUnit &translation_unit, Version version)> &function);
+
+	//! @return the debounce delay currently applied.
+	Duration delay() const;
+
+	Stats stats() const;
+
+  private:
+	Duration delay_locked() const;
+	void run();
+}; // class ReparseScheduler
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_ReparseScheduler_hpp
@@ -0,0 +1,136 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Result.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Result_hpp
+#define clang_cpp_Result_hpp
+
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+//! Outcome of a non-throwing (`try_*`) accessor.
+enum class Status: std::uint8_t
+{
+	OK,
+	//! the cursor or file queried is null.
+	Null,
+	//! the entity asked for does not exist (no definition, no parent...).
+	NotFound,
+	//! libclang returned no string.
+	NoString,
+	//! the kind or id is not known to the library.
+	Unknown,
+	OutOfMemory,
+};
+
+CLANGXX_API const char *name(Status status) noexcept;
+
+/*!
+  Value of type T, or the Status explaining why there is none.
+
+  Accessing the value of a failed Result is undefined, as for a null
+  pointer: check it first.
+*/
+template<typename T>
+class Result
+{
+  private:
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type	m_storage;
+	Status	m_status;
+
+  public:
+	Result(const T &value) noexcept(std::is_nothrow_copy_constructible<T>::value)
+		: m_status(Status::OK)
+	{
+		new(&m_storage) T(value);
+	}
+
+	Result(T &&value) noexcept(std::is_nothrow_move_constructible<T>::value)
+		: m_status(Status::OK)
+	{
+		new(&m_storage) T(std::move(value));
+	}
+
+	Result(Status status) noexcept
+		: m_status(status)
+	{}
+
+	Result(const Result &other) noexcept(std::is_nothrow_copy_constructible<T>::value)
+		: m_status(other.m_status)
+	{
+		if ( other ) {
+			new(&m_storage) T(*other);
+		}
+	}
+
+	Result(Result &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+		: m_status(other.m_status)
+	{
+		if ( other ) {
+			new(&m_storage) T(std::move(*other));
+		}
+	}
+
+	~Result() {
+		reset();
+	}
+
+	Result &operator=(Result other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+		reset();
+		m_status = other.m_status;
+		if ( other ) {
+			new(&m_storage) T(std::move(*other));
+		}
+		return *this;
+	}
+
+  public:
+	explicit operator bool() const noexcept {
+		return m_status == Status::OK;
+	}
+
+	Status status() const noexcept {
+		return m_status;
+	}
+
+	T &operator*() noexcept {
+		return *reinterpret_cast<T *>(&m_storage);
+	}
+
+	const T &operator*() const noexcept {
+		return *reinterpret_cast<const T *>(&m_storage);
+	}
+
+	T *operator->() noexcept {
+		return &**this;
+	}
+
+	const T *operator->() const noexcept {
+		return &**this;
+	}
+
+	T value_or(T fallback) const {
+		return *this ? **this : std::move(fallback);
+	}
+
+  private:
+	void reset() noexcept {
+		if ( m_status == Status::OK ) {
+			(**this).~T();
+			m_status = Status::Null;
+		}
+	}
+}; // class Result
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Result_hpp
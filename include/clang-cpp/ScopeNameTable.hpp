@@ -0,0 +1,66 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ScopeNameTable.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_ScopeNameTable_hpp
+#define clang_cpp_ScopeNameTable_hpp
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/CursorMap.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Memo of the fully qualified names of the scopes (semantic parents) of one
+  translation unit.  Each scope is named once and shared by every
+  declaration it contains.  Cleared when the translation unit is reparsed.
+*/
+class CLANGXX_API ScopeNameTable
+{
+  private:
+	struct Scope
+	{
+		std::string	qualified_name;
+		std::string	name;
+		CXCursor	parent{};
+	}; // struct Scope
+
+  public:
+	static const char	s_separator[];
+
+  private:
+	mutable std::mutex	m_mutex;
+	CursorMap<Scope>	m_scopes;
+
+  public:
+	ScopeNameTable();
+	~ScopeNameTable();
+
+	ScopeNameTable(const ScopeNameTable &) = delete;
+	ScopeNameTable &operator=(const ScopeNameTable &) = delete;
+
+  public:
+	std::string qualified_name(CXCursor cx_cursor);
+
+	//! @return the names of the scopes enclosing @a cx_cursor, outermost first.
+	std::vector<std::string> scope_path(CXCursor cx_cursor);
+
+	void clear();
+
+  private:
+	const Scope *scope(CXCursor cx_scope);
+
+	static std::string name_of(CXCursor cx_cursor);
+}; // class ScopeNameTable
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_ScopeNameTable_hpp
@@ -0,0 +1,73 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Server.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Server_hpp
+#define clang_cpp_Server_hpp
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class Index;
+
+/*!
+  Keeps translation units parsed and serves requests about them over a Unix
+  domain socket (see ServerProtocol.hpp and Client).
+
+  Requests are queued per translation unit and handled in batches on a pool
+  of workers: a translation unit is only touched by one worker at a time,
+  and consecutive reparses of a batch are coalesced into the last one.
+  Above max_translation_units, the least recently used idle translation
+  unit is dropped; requests for it fail until it is parsed again.
+  POSIX only; on other systems start() throws.
+*/
+class CLANGXX_API Server
+{
+	class Impl;
+
+  public:
+	static const std::size_t	default_max_translation_units	= 64;
+
+  private:
+	std::unique_ptr<Impl>	m_impl;
+
+  public:
+	/*!
+	  @param socket_path	path of the socket; an existing socket file is replaced.
+	  @param worker_count	0: hardware concurrency.
+	  @param max_translation_units	0: no limit.
+	*/
+	explicit Server(std::string socket_path, std::shared_ptr<Index> index = nullptr,
+					unsigned int worker_count = 0,
+					std::size_t max_translation_units = default_max_translation_units);
+	~Server();
+
+	Server(const Server &) = delete;
+	Server &operator=(const Server &) = delete;
+
+  public:
+	const std::string &socket_path() const noexcept;
+
+	//! Starts listening and returns.
+	void start();
+
+	//! Stops listening, closes the connections and waits for the workers.
+	void stop();
+
+	//! Blocks until stop() is called from another thread.
+	void wait();
+
+	std::size_t translation_unit_count() const;
+}; // class Server
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Server_hpp
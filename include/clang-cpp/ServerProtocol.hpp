@@ -0,0 +1,230 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ServerProtocol.hpp
+
+   Copyright (c) 2015 pegacorn
+
+   Messages exchanged by Server and Client over a local socket.
+
+   Each frame is a FrameHeader followed by `size` bytes of payload, in the
+   byte order of the host.  Integers are fixed-size; a string is its
+   uint32_t length followed by its bytes; a list is its uint32_t count
+   followed by its elements.  A reply carries the id of its request and a
+   Status byte before the payload (an error message if not Status::OK).
+*/
+#ifndef clang_cpp_ServerProtocol_hpp
+#define clang_cpp_ServerProtocol_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+namespace protocol {
+
+const std::uint32_t	max_frame_size	= 256u * 1024 * 1024;
+
+enum class MessageType: std::uint8_t
+{
+	Parse		= 1,	//!< filename, args, unsaved files
+	Reparse		= 2,	//!< filename, unsaved files
+	CursorAt	= 3,	//!< filename, file, line, column
+	References	= 4,	//!< filename, usr
+	Complete	= 5,	//!< filename, line, column, unsaved files
+	Reply		= 0x80,
+};
+
+enum class Status: std::uint8_t
+{
+	OK		= 0,
+	Error	= 1,
+};
+
+struct FrameHeader
+{
+	std::uint32_t	size;
+	std::uint32_t	request_id;
+	MessageType		type;
+	std::uint8_t	reserved[3];
+}; // struct FrameHeader
+
+struct Location
+{
+	std::string		filename;
+	std::uint32_t	line{};
+	std::uint32_t	column{};
+}; // struct Location
+
+struct CursorInfo
+{
+	std::string		kind;
+	std::string		spelling;
+	std::string		usr;
+	Location		location;
+	//! declaration the cursor refers to; empty usr if none.
+	std::string		referenced_usr;
+	Location		definition;
+}; // struct CursorInfo
+
+struct Completion
+{
+	std::string		typed_text;
+	std::string		text;
+	std::uint32_t	priority{};
+}; // struct Completion
+
+using UnsavedContents	= std::vector<std::pair<std::string, std::string>>;
+
+class Encoder
+{
+  private:
+	std::string	m_data;
+
+  public:
+	const std::string &data() const noexcept {
+		return m_data;
+	}
+
+	void put(std::uint8_t value) {
+		m_data += static_cast<char>(value);
+	}
+
+	void put(std::uint32_t value) {
+		m_data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+	}
+
+	void put(const std::string &value) {
+		put(static_cast<std::uint32_t>(value.size()));
+		m_data += value;
+	}
+
+	void put(const std::vector<std::string> &values) {
+		put(static_cast<std::uint32_t>(values.size()));
+		for ( const auto &value : values ) {
+			put(value);
+		}
+	}
+
+	void put(const UnsavedContents &values) {
+		put(static_cast<std::uint32_t>(values.size()));
+		for ( const auto &value : values ) {
+			put(value.first);
+			put(value.second);
+		}
+	}
+
+	void put(const Location &value) {
+		put(value.filename);
+		put(value.line);
+		put(value.column);
+	}
+}; // class Encoder
+
+//! Reads a payload; throws std::runtime_error if it is malformed.
+class Decoder
+{
+  private:
+	const char	*m_data;
+	std::size_t	m_size;
+
+  public:
+	Decoder(const char *data, std::size_t size) noexcept
+		: m_data(data)
+		, m_size(size)
+	{}
+
+  public:
+	std::uint8_t get_u8() {
+		std::uint8_t value;
+		read(&value, sizeof(value));
+		return value;
+	}
+
+	std::uint32_t get_u32() {
+		std::uint32_t value;
+		read(&value, sizeof(value));
+		return value;
+	}
+
+	std::string get_string() {
+		const std::uint32_t size = get_u32();
+		check(size);
+		std::string value(m_data, size);
+		skip(size);
+		return value;
+	}
+
+	std::vector<std::string> get_strings() {
+		std::vector<std::string> values(get_count());
+		for ( auto &value : values ) {
+			value = get_string();
+		}
+		return values;
+	}
+
+	UnsavedContents get_unsaved() {
+		UnsavedContents values(get_count());
+		for ( auto &value : values ) {
+			value.first = get_string();
+			value.second = get_string();
+		}
+		return values;
+	}
+
+	Location get_location() {
+		Location value;
+		value.filename = get_string();
+		value.line = get_u32();
+		value.column = get_u32();
+		return value;
+	}
+
+  private:
+	std::uint32_t get_count() {
+		const std::uint32_t count = get_u32();
+		// every element takes at least four bytes
+		check(static_cast<std::size_t>(count) * sizeof(std::uint32_t));
+		return count;
+	}
+
+	void check(std::size_t size) const {
+		if ( size > m_size ) {
+			throw std::runtime_error("Malformed message.");
+		}
+	}
+
+	void skip(std::size_t size) noexcept {
+		m_data += size;
+		m_size -= size;
+	}
+
+	void read(void *value, std::size_t size) {
+		check(size);
+		std::memcpy(value, m_data, size);
+		skip(size);
+	}
+}; // class Decoder
+
+#if !defined _WIN32
+/*!
+  Reads one frame from socket @a descriptor.
+  @return false at end of stream; throws RuntimeError on errors.
+*/
+CLANGXX_API bool read_frame(int descriptor, FrameHeader &header, std::string &payload);
+
+//! Writes one frame to socket @a descriptor; throws RuntimeError on errors.
+CLANGXX_API void write_frame(int descriptor, MessageType type, std::uint32_t request_id,
+							 const std::string &payload);
+#endif
+
+} // namespace protocol
+} // namespace clangxx
+
+
+#endif // clang_cpp_ServerProtocol_hpp
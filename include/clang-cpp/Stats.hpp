@@ -0,0 +1,134 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Stats.hpp
+
+   Copyright (c) 2015 pegacorn
+
+   Per-API call counters, memo hit rates and latency histograms.
+
+   Recording is compiled in only when the library is built with the
+   CLANGXX_ENABLE_STATS CMake option; otherwise the CLANGXX_STATS_* macros
+   expand to nothing and snapshot() returns no entry.  Counts are kept in
+   per-thread, cache-line-aligned slots and summed by snapshot().
+*/
+#ifndef clang_cpp_Stats_hpp
+#define clang_cpp_Stats_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+namespace stats {
+
+enum class Counter: unsigned int
+{
+	Cursor_spelling,
+	Cursor_displayname,
+	Cursor_get_usr,
+	Cursor_get_definition,
+	Cursor_canonical,
+	Cursor_hash,
+	Cursor_semantic_parent,
+	Cursor_lexical_parent,
+	Cursor_referenced,
+	Cursor_qualified_name,
+	Cursor_scope_path,
+	Cursor_get_children,
+	Cursor_visit_children,
+	File_name,
+	File_time,
+	TranslationUnit_from_source,
+	TranslationUnit_from_ast_file,
+	TranslationUnit_reparse,
+	TranslationUnit_save,
+	count,
+};
+
+//! bucket i counts the calls that took [2^i, 2^(i+1)) nanoseconds.
+const std::size_t	histogram_size	= 32;
+
+struct Entry
+{
+	const char		*name;
+	std::uint64_t	calls;
+	//! memoized results reused, and computed.
+	std::uint64_t	hits;
+	std::uint64_t	misses;
+	std::uint64_t	total_nanoseconds;
+	std::uint64_t	histogram[histogram_size];
+}; // struct Entry
+
+constexpr bool enabled() noexcept
+{
+#if defined CLANGXX_ENABLE_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+CLANGXX_API const char *name(Counter counter) noexcept;
+
+//! @return the counts of every counter, summed over the threads; empty if not enabled().
+CLANGXX_API std::vector<Entry> snapshot();
+
+//! Writes a table of the counters that were called.
+CLANGXX_API void write(std::ostream &ostream);
+
+//! Zeroes the counts; not synchronized with threads recording meanwhile.
+CLANGXX_API void reset();
+
+namespace detail {
+
+CLANGXX_API void record_call(Counter counter, std::uint64_t nanoseconds) noexcept;
+
+CLANGXX_API void record_memo(Counter counter, bool hit) noexcept;
+
+class ScopedCall
+{
+  private:
+	const Counter								m_counter;
+	const std::chrono::steady_clock::time_point	m_begin;
+
+  public:
+	explicit ScopedCall(Counter counter) noexcept
+		: m_counter(counter)
+		, m_begin(std::chrono::steady_clock::now())
+	{}
+
+	~ScopedCall() {
+		record_call(m_counter, static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - m_begin).count()));
+	}
+
+	ScopedCall(const ScopedCall &) = delete;
+	ScopedCall &operator=(const ScopedCall &) = delete;
+}; // class ScopedCall
+
+} // namespace detail
+
+} // namespace stats
+} // namespace clangxx
+
+
+#if defined CLANGXX_ENABLE_STATS
+	//! Counts a call of the enclosing function and times it until the end of the scope.
+	#define CLANGXX_STATS_CALL(counter) \
+		const ::clangxx::stats::detail::ScopedCall clangxx_stats_call_( \
+			::clangxx::stats::Counter::counter)
+	//! Counts whether a memoized result is reused.
+	#define CLANGXX_STATS_MEMO(counter, hit) \
+		::clangxx::stats::detail::record_memo(::clangxx::stats::Counter::counter, (hit))
+#else
+	#define CLANGXX_STATS_CALL(counter)			static_cast<void>(0)
+	#define CLANGXX_STATS_MEMO(counter, hit)	static_cast<void>(0)
+#endif
+
+
+#endif // clang_cpp_Stats_hpp
@@ -0,0 +1,65 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file SymbolTable.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_SymbolTable_hpp
+#define clang_cpp_SymbolTable_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+//! Interns strings (typically USRs) into dense ids.
+class CLANGXX_API SymbolTable
+{
+  public:
+	using Id	= std::uint32_t;
+
+	static const Id	invalid_id	= static_cast<Id>(-1);
+
+  private:
+	std::vector<std::string>				m_names;
+	std::unordered_map<std::string, Id>		m_ids;
+
+  public:
+	SymbolTable();
+	~SymbolTable();
+
+	SymbolTable(const SymbolTable &other);
+	SymbolTable(SymbolTable &&other) noexcept;
+
+	SymbolTable &operator=(const SymbolTable &other);
+	SymbolTable &operator=(SymbolTable &&other) noexcept;
+
+  public:
+	Id intern(const std::string &name);
+
+	Id find(const std::string &name) const;
+
+	const std::string &name(Id id) const {
+		return m_names[id];
+	}
+
+	const std::vector<std::string> &names() const noexcept {
+		return m_names;
+	}
+
+	std::size_t size() const noexcept {
+		return m_names.size();
+	}
+
+	void reserve(std::size_t size);
+}; // class SymbolTable
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_SymbolTable_hpp
@@ -0,0 +1,66 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ThreadPool.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_ThreadPool_hpp
+#define clang_cpp_ThreadPool_hpp
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Fixed set of threads running submitted tasks in submission order.  Tasks
+  should handle their own exceptions; one escaping a task is discarded.
+  The destructor runs the tasks still queued, then joins the threads.
+*/
+class CLANGXX_API ThreadPool
+{
+  public:
+	using Task	= std::function<void()>;
+
+  private:
+	std::mutex					m_mutex;
+	std::condition_variable		m_task_ready;
+	std::condition_variable		m_idle;
+	std::deque<Task>			m_tasks;
+	std::size_t					m_running{0};
+	bool						m_stopping{false};
+	std::vector<std::thread>	m_threads;
+
+  public:
+	//! @param thread_count	0: hardware concurrency.
+	explicit ThreadPool(unsigned int thread_count = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+  public:
+	std::size_t thread_count() const noexcept {
+		return m_threads.size();
+	}
+
+	void submit(Task task);
+
+	//! Blocks until no task is queued or running.
+	void wait_idle();
+
+  private:
+	void work();
+}; // class ThreadPool
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_ThreadPool_hpp
@@ -0,0 +1,81 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Trace.hpp
+
+   Copyright (c) 2015 pegacorn
+
+   Opt-in timeline of the library's parse and traversal phases, written as
+   Chrome trace-event JSON (viewable in Perfetto or about:tracing).
+
+   Spans are recorded into per-thread buffers without locking; while
+   tracing is disabled a Span costs one atomic load.
+*/
+#ifndef clang_cpp_Trace_hpp
+#define clang_cpp_Trace_hpp
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+namespace trace {
+
+CLANGXX_API void enable(bool enabled = true) noexcept;
+
+CLANGXX_API bool enabled() noexcept;
+
+//! Writes the spans recorded so far.
+CLANGXX_API void write(std::ostream &ostream);
+
+CLANGXX_API void write(const std::string &path);
+
+/*!
+  Discards the spans recorded so far.
+  No Span may be alive and tracing should be disabled meanwhile.
+*/
+CLANGXX_API void clear();
+
+/*!
+  Records the time between its construction and its destruction, if
+  tracing is enabled at construction.
+  @a category and @a name must outlive the trace (string literals).
+*/
+class CLANGXX_API Span
+{
+  private:
+	const char		*m_category;
+	const char		*m_name;
+	std::string		m_argument;
+	std::int64_t	m_begin;
+	bool			m_active;
+
+  public:
+	Span(const char *category, const char *name) noexcept;
+	//! @param argument	shown as the `name` argument of the span, e.g. a file name.
+	Span(const char *category, const char *name, const std::string &argument);
+	~Span();
+
+	Span(const Span &) = delete;
+	Span &operator=(const Span &) = delete;
+
+  public:
+	//! @return whether the span is being recorded.
+	explicit operator bool() const noexcept {
+		return m_active;
+	}
+
+	void set_argument(std::string argument) {
+		if ( m_active ) {
+			m_argument = std::move(argument);
+		}
+	}
+}; // class Span
+
+} // namespace trace
+} // namespace clangxx
+
+
+#endif // clang_cpp_Trace_hpp
@@ -13,8 +13,11 @@
 #include "clang-c/Index.h"
 #include "clang-cpp/Cursor.hpp"
 #include "clang-cpp/File.hpp"
+#include "clang-cpp/FileTable.hpp"
+#include "clang-cpp/ScopeNameTable.hpp"
 //#include "clang-cpp/SourceLocation.hpp"
 #include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
 #include "clang-cpp/UniqueCXObject.hpp"
 #include "clang-cpp/UnsavedFile.hpp"
 
@@ -66,6 +69,10 @@ class CLANGXX_API TranslationUnit: public std::enable_shared_from_this<Translati
 	File get_file(const std::string &filename) const {
 		return File::from_name(shared_from_this(), filename);
 	}
+
+	FileTable &file_table() const;
+
+	ScopeNameTable &scope_names() const;
 #if 0
 	std::unique_ptr<SourceLocation> get_location(
 	  const std::string &filename, unsigned offset) const
@@ -90,6 +97,13 @@ class CLANGXX_API TranslationUnit: public std::enable_shared_from_this<Translati
 
 	void save(const std::string &filename);
 
+	/*!
+	  Writes the AST to @a path in the compact format read by AstFile, which
+	  does not need libclang.  @a options selects the exported subtrees.
+	*/
+	void export_binary(const std::string &path,
+					   const TraversalOptions &options = TraversalOptions()) const;
+
 #if 0
 	CodeCompletionResults codeComplete(path, line, column, unsaved_files=None,
 				 include_macros=False, include_code_patterns=False,
@@ -0,0 +1,62 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file TraversalOptions.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_TraversalOptions_hpp
+#define clang_cpp_TraversalOptions_hpp
+
+#include <unordered_map>
+#include <unordered_set>
+#include "clang-c/Index.h"
+#include "clang-cpp/FileUniqueID.hpp"
+#include "clang-cpp/HeaderDeduplicator.hpp"
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+struct TraversalOptions
+{
+	bool								main_file_only{false};
+	bool								exclude_system_headers{false};
+	//! if not empty, only cursors located in one of these files are visited.
+	std::unordered_set<FileUniqueID>	allowed_files;
+	//! if set, top-level declarations of already processed headers are skipped.
+	HeaderDeduplicator					*header_deduplicator{nullptr};
+
+	bool filters_locations() const noexcept {
+		return main_file_only || exclude_system_headers || !allowed_files.empty();
+	}
+}; // struct TraversalOptions
+
+/*!
+  Evaluates TraversalOptions against cursors of one translation unit.
+  Decisions are cached per file, so a rejected subtree costs one location
+  lookup for its root.
+*/
+class CLANGXX_API LocationFilter
+{
+  private:
+	const TraversalOptions				&m_options;
+	CXTranslationUnit					m_cx_translation_unit;
+	std::unordered_map<CXFile, bool>	m_decisions;
+	CXFile								m_last_file{nullptr};
+	bool								m_last_decision{true};
+	HeaderDeduplicator::FileDecisions	m_header_decisions;
+
+  public:
+	LocationFilter(const TraversalOptions &options, CXTranslationUnit cx_translation_unit);
+
+  public:
+	bool accepts(CXCursor cx_cursor, CXCursor cx_parent);
+
+  private:
+	bool accepts_file(CXFile cx_file, const CXSourceLocation &location);
+}; // class LocationFilter
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_TraversalOptions_hpp
@@ -0,0 +1,80 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file VirtualFileSystem.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_VirtualFileSystem_hpp
+#define clang_cpp_VirtualFileSystem_hpp
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-c/BuildSystem.h"
+#include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+#include "clang-cpp/UnsavedFile.hpp"
+
+
+namespace clangxx {
+
+/*!
+  Virtual file system for parsing: virtual paths mapped to real files through
+  a clang VFS overlay, and virtual paths with in-memory contents passed as
+  unsaved files.
+
+  Pass arguments() and unsaved_files() to Index::parse().  On Linux the
+  overlay is handed to clang through an anonymous memory file, elsewhere
+  through a temporary file.  Keep the object alive while translation units
+  parsed with it may be reparsed.
+*/
+class CLANGXX_API VirtualFileSystem
+{
+  private:
+	UniqueCXVirtualFileOverlay						m_cx_overlay;
+	std::vector<std::pair<std::string, std::string>>	m_contents;
+	std::string										m_overlay_path;
+	std::vector<int>								m_descriptors;
+	std::vector<std::string>						m_temporary_files;
+	std::size_t										m_mapping_count{0};
+
+  public:
+	VirtualFileSystem();
+	~VirtualFileSystem();
+
+	VirtualFileSystem(const VirtualFileSystem &) = delete;
+	VirtualFileSystem(VirtualFileSystem &&other) noexcept;
+
+	VirtualFileSystem &operator=(const VirtualFileSystem &) = delete;
+	VirtualFileSystem &operator=(VirtualFileSystem &&other) noexcept;
+
+  public:
+	CXVirtualFileOverlay native_handle() const noexcept {
+		return m_cx_overlay.get();
+	}
+
+	//! Maps absolute @a virtual_path to the absolute @a real_path.
+	void map_file(const std::string &virtual_path, const std::string &real_path);
+
+	//! Serves @a contents for @a virtual_path without touching disk.
+	void add_file(const std::string &virtual_path, std::string contents);
+
+	void set_case_sensitive(bool case_sensitive);
+
+	//! @return the overlay in the YAML format of -ivfsoverlay.
+	std::string yaml() const;
+
+	//! @return the parse arguments attaching the overlay, empty if nothing is mapped.
+	std::vector<std::string> arguments();
+
+	std::vector<UnsavedFile> unsaved_files() const;
+
+  private:
+	std::string materialize(const std::string &yaml);
+}; // class VirtualFileSystem
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_VirtualFileSystem_hpp
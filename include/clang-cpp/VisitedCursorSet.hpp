@@ -0,0 +1,60 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file VisitedCursorSet.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_VisitedCursorSet_hpp
+#define clang_cpp_VisitedCursorSet_hpp
+
+#include "clang-c/Index.h"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/switch_port.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace clangxx {
+
+//! Cursor set maintained by libclang itself (CXCursorSet).
+class CLANGXX_API VisitedCursorSet
+{
+  private:
+	UniqueCXCursorSet	m_cx_cursor_set;
+
+  public:
+	VisitedCursorSet();
+	~VisitedCursorSet();
+
+	VisitedCursorSet(const VisitedCursorSet &) = delete;
+	VisitedCursorSet(VisitedCursorSet &&other) noexcept;
+
+	VisitedCursorSet &operator=(const VisitedCursorSet &) = delete;
+	VisitedCursorSet &operator=(VisitedCursorSet &&other) noexcept;
+
+  public:
+	CXCursorSet native_handle() const noexcept {
+		return m_cx_cursor_set.get();
+	}
+
+	bool contains(const CXCursor &cx_cursor) const noexcept {
+		return clang_CXCursorSet_contains(m_cx_cursor_set.get(), cx_cursor) != 0;
+	}
+
+	bool contains(const Cursor &cursor) const noexcept {
+		return contains(cursor.native_handle());
+	}
+
+	//! @return true if @a cx_cursor was not visited yet.
+	bool insert(const CXCursor &cx_cursor) noexcept {
+		return clang_CXCursorSet_insert(m_cx_cursor_set.get(), cx_cursor) != 0;
+	}
+
+	bool insert(const Cursor &cursor) noexcept {
+		return insert(cursor.native_handle());
+	}
+}; // class VisitedCursorSet
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_VisitedCursorSet_hpp
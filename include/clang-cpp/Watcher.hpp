@@ -0,0 +1,94 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Watcher.hpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#ifndef clang_cpp_Watcher_hpp
+#define clang_cpp_Watcher_hpp
+
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include "clang-cpp/switch_port.hpp"
+
+
+namespace clangxx {
+
+class TranslationUnit;
+
+/*!
+  Watches project directories and reparses the translation units that
+  include a changed file.
+
+  Events are collected until none has arrived for Options::debounce (or
+  Options::max_delay has passed since the first one), then each affected
+  translation unit is reparsed once on a background pool.  A translation
+  unit is never reparsed by two workers at a time; changes arriving
+  during a reparse schedule one more.  The watched translation units must
+  not be used by other threads while the watcher may reparse them.
+
+  Directory events come from inotify on Linux; elsewhere add_directory()
+  throws and changes can still be reported with notify().
+*/
+class CLANGXX_API Watcher
+{
+	class Impl;
+
+  public:
+	struct Options
+	{
+		std::chrono::milliseconds	debounce{100};
+		std::chrono::milliseconds	max_delay{2000};
+		//! 0: hardware concurrency.
+		unsigned int				thread_count{0};
+	}; // struct Options
+
+	//! Called on a worker after each reparse; @a error is null on success.
+	using Callback	= std::function<void(const std::shared_ptr<TranslationUnit> &translation_unit,
+										 std::exception_ptr error)>;
+
+  private:
+	std::unique_ptr<Impl>	m_impl;
+
+  public:
+	Watcher();
+	explicit Watcher(Options options);
+	~Watcher();
+
+	Watcher(const Watcher &) = delete;
+	Watcher &operator=(const Watcher &) = delete;
+
+  public:
+	//! Watches @a path, and its subdirectories (present and future) if @a recursive.
+	void add_directory(const std::string &path, bool recursive = true);
+
+	//! Reparses @a translation_unit when a file it includes changes.
+	void watch(std::shared_ptr<TranslationUnit> translation_unit);
+
+	void unwatch(const std::shared_ptr<TranslationUnit> &translation_unit);
+
+	void set_callback(Callback callback);
+
+	//! Starts the event and debounce threads.
+	void start();
+
+	//! Stops the threads, drops the changes not handled yet and waits for the reparses in progress.
+	void stop();
+
+	//! Reports a change of @a path as if it had come from the file system.
+	void notify(const std::string &path);
+
+	//! Blocks until every reported change has been handled; the watcher must be started.
+	void wait_idle();
+
+	std::size_t watched_count() const;
+}; // class Watcher
+
+} // namespace clangxx
+
+
+#endif // clang_cpp_Watcher_hpp
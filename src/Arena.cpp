@@ -0,0 +1,87 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Arena.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Arena.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+
+//! blocks grow geometrically up to this multiple of the initial size.
+const std::size_t	max_growth	= 64;
+
+} // namespace
+
+namespace clangxx {
+
+const std::size_t	Arena::default_block_size;
+
+Arena::Arena(std::size_t block_size/* = default_block_size*/)
+	: m_initial_block_size(std::max<std::size_t>(block_size, 256))
+	, m_next_block_size(m_initial_block_size)
+{}
+
+Arena::~Arena()
+{
+	while ( m_blocks ) {
+		Block *next = m_blocks->next;
+		std::free(m_blocks);
+		m_blocks = next;
+	}
+}
+
+void Arena::reset() noexcept
+{
+	if ( !m_blocks ) {
+		return;
+	}
+	Block *older = m_blocks->next;
+	while ( older ) {
+		Block *next = older->next;
+		std::free(older);
+		older = next;
+	}
+	m_blocks->next = nullptr;
+	m_position = reinterpret_cast<char *>(m_blocks + 1);
+	m_end = m_position + m_blocks->size;
+	m_allocated = 0;
+}
+
+std::size_t Arena::capacity() const noexcept
+{
+	std::size_t capacity = 0;
+	for ( const Block *block = m_blocks; block; block = block->next ) {
+		capacity += block->size;
+	}
+	return capacity;
+}
+
+void *Arena::allocate_block(std::size_t size, std::size_t alignment)
+{
+	const std::size_t needed = size + alignment;
+	if ( needed < size ) {
+		throw std::bad_alloc();
+	}
+	const std::size_t block_size = std::max(m_next_block_size, needed);
+	Block *block = static_cast<Block *>(std::malloc(sizeof(Block) + block_size));
+	if ( !block ) {
+		throw std::bad_alloc();
+	}
+	block->next = m_blocks;
+	block->size = block_size;
+	m_blocks = block;
+	m_position = reinterpret_cast<char *>(block + 1);
+	m_end = m_position + block_size;
+	m_next_block_size = std::min(m_next_block_size * 2, m_initial_block_size * max_growth);
+
+	return allocate(size, alignment);
+}
+
+} // namespace clangxx
@@ -0,0 +1,351 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file AstDumper.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/AstDumper.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+using clangxx::AstDumper;
+
+//! Output buffer handed to the sink whenever it fills up.
+class Buffer
+{
+  private:
+	const AstDumper::Sink	&m_sink;
+	const std::size_t		m_capacity;
+	std::string				m_data;
+
+  public:
+	Buffer(const AstDumper::Sink &sink, std::size_t capacity)
+		: m_sink(sink)
+		, m_capacity(capacity ? capacity : 1)
+	{
+		m_data.reserve(m_capacity);
+	}
+
+  public:
+	void append(char c) {
+		m_data += c;
+		if ( m_data.size() >= m_capacity ) {
+			flush();
+		}
+	}
+
+	void append(const char *data, std::size_t size) {
+		m_data.append(data, size);
+		if ( m_data.size() >= m_capacity ) {
+			flush();
+		}
+	}
+
+	void append(const char *c_string) {
+		append(c_string, std::char_traits<char>::length(c_string));
+	}
+
+	void append_number(std::uint64_t value) {
+		char digits[24];
+		const int size = std::snprintf(digits, sizeof(digits), "%llu",
+									   static_cast<unsigned long long>(value));
+		append(digits, static_cast<std::size_t>(size));
+	}
+
+	void append_string(const char *c_string) {
+		static const char hex[] = "0123456789abcdef";
+		append('"');
+		for ( const char *p = c_string; *p; ++p ) {
+			const unsigned char c = static_cast<unsigned char>(*p);
+			switch ( c ) {
+			  case '"':		append("\\\"", 2);	break;
+			  case '\\':	append("\\\\", 2);	break;
+			  case '\n':	append("\\n", 2);	break;
+			  case '\r':	append("\\r", 2);	break;
+			  case '\t':	append("\\t", 2);	break;
+			  default:
+				if ( c < 0x20 ) {
+					const char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+					append(escape, sizeof(escape));
+				}
+				else {
+					append(static_cast<char>(c));
+				}
+				break;
+			}
+		}
+		append('"');
+	}
+
+	void flush() {
+		m_sink(m_data.data(), m_data.size());
+		m_data.clear();
+	}
+}; // class Buffer
+
+class Dumper
+{
+  private:
+	struct Frame
+	{
+		Dumper			*dumper;
+		std::uint64_t	parent;		//!< NDJSON id of the nearest written ancestor
+		unsigned int	depth;
+		bool			has_children;
+	}; // struct Frame
+
+  private:
+	const AstDumper::Options				&m_options;
+	const bool								m_ndjson;
+	CXTranslationUnit						m_cx_translation_unit;
+	clangxx::LocationFilter					m_filter;
+	const bool								m_filters;
+	Buffer									m_buffer;
+	std::uint64_t							m_next_id{0};
+	std::unordered_map<int, std::string>	m_kind_names;
+	CXFile									m_last_file{nullptr};
+	std::string								m_last_file_name;
+	std::exception_ptr						m_exception;
+
+  public:
+	Dumper(const AstDumper::Options &options, CXTranslationUnit cx_translation_unit,
+		   const AstDumper::Sink &sink)
+		: m_options(options)
+		, m_ndjson(options.format == AstDumper::Format::NDJSON)
+		, m_cx_translation_unit(cx_translation_unit)
+		, m_filter(options.traversal, cx_translation_unit)
+		, m_filters(options.traversal.filters_locations() || options.traversal.header_deduplicator)
+		, m_buffer(sink, options.buffer_size)
+	{}
+
+  public:
+	void run() {
+		const CXCursor root(clang_getTranslationUnitCursor(m_cx_translation_unit));
+		const std::uint64_t id(m_next_id++);
+		open_node(root, id, 0, 0, true);
+
+		Frame frame{this, id, 1, false};
+		clang_visitChildren(root, &Dumper::visit, &frame);
+		if ( m_exception ) {
+			std::rethrow_exception(m_exception);
+		}
+		close_node(frame.has_children);
+		m_buffer.flush();
+	}
+
+  private:
+	static CXChildVisitResult visit(CXCursor cursor, CXCursor parent, CXClientData client_data) {
+		const auto frame = static_cast<Frame *>(client_data);
+		try {
+			return visit_node(cursor, parent, frame);
+		}
+		catch ( ... ) {
+			// the sink may throw; never unwind through libclang
+			frame->dumper->m_exception = std::current_exception();
+			return CXChildVisit_Break;
+		}
+	}
+
+	static CXChildVisitResult visit_node(CXCursor cursor, CXCursor parent, Frame *frame) {
+		Dumper &dumper = *frame->dumper;
+		if ( dumper.m_filters && !dumper.m_filter.accepts(cursor, parent) ) {
+			return CXChildVisit_Continue;
+		}
+
+		const auto &kinds = dumper.m_options.kinds;
+		if ( !kinds.empty() && kinds.find(cursor.kind) == kinds.end() ) {
+			// children go to the nearest written ancestor
+			clang_visitChildren(cursor, &Dumper::visit, frame);
+			return dumper.m_exception ? CXChildVisit_Break : CXChildVisit_Continue;
+		}
+
+		if ( !dumper.m_ndjson ) {
+			dumper.m_buffer.append(frame->has_children ? "," : ",\"children\":[");
+		}
+		frame->has_children = true;
+
+		const std::uint64_t id(dumper.m_next_id++);
+		dumper.open_node(cursor, id, frame->parent, frame->depth, false);
+		Frame child_frame{&dumper, id, frame->depth + 1, false};
+		clang_visitChildren(cursor, &Dumper::visit, &child_frame);
+		if ( dumper.m_exception ) {
+			return CXChildVisit_Break;
+		}
+		dumper.close_node(child_frame.has_children);
+		return CXChildVisit_Continue;
+	}
+
+	void open_node(CXCursor cursor, std::uint64_t id, std::uint64_t parent, unsigned int depth, bool is_root) {
+		Buffer &buffer = m_buffer;
+		buffer.append('{');
+		bool first = true;
+		auto key = [&buffer, &first](const char *name) {
+			buffer.append(first ? "\"" : ",\"");
+			buffer.append(name);
+			buffer.append("\":", 2);
+			first = false;
+		};
+
+		if ( m_ndjson ) {
+			key("id");
+			buffer.append_number(id);
+			if ( !is_root ) {
+				key("parent");
+				buffer.append_number(parent);
+			}
+			key("depth");
+			buffer.append_number(depth);
+		}
+
+		const unsigned int fields = m_options.fields;
+		if ( fields & AstDumper::Kind ) {
+			key("kind");
+			buffer.append_string(kind_name(cursor.kind).c_str());
+		}
+		if ( fields & AstDumper::Spelling ) {
+			key("spelling");
+			append_cx_string(clang_getCursorSpelling(cursor));
+		}
+		if ( (fields & AstDumper::Location) && !is_root ) {
+			CXFile cx_file = nullptr;
+			unsigned int line = 0, column = 0;
+			clang_getExpansionLocation(clang_getCursorLocation(cursor), &cx_file, &line, &column, nullptr);
+			if ( cx_file ) {
+				key("file");
+				buffer.append_string(file_name(cx_file).c_str());
+				key("line");
+				buffer.append_number(line);
+				key("column");
+				buffer.append_number(column);
+			}
+		}
+		if ( (fields & AstDumper::Type) && !is_root ) {
+			const CXType cx_type(clang_getCursorType(cursor));
+			if ( cx_type.kind != CXType_Invalid ) {
+				key("type");
+				append_cx_string(clang_getTypeSpelling(cx_type));
+			}
+		}
+		if ( (fields & AstDumper::USR) && clang_isDeclaration(cursor.kind) ) {
+			key("usr");
+			append_cx_string(clang_getCursorUSR(cursor));
+		}
+
+		if ( m_ndjson ) {
+			buffer.append("}\n", 2);
+		}
+	}
+
+	void close_node(bool has_children) {
+		if ( m_ndjson ) {
+			return;
+		}
+		m_buffer.append(has_children ? "]}" : "}");
+	}
+
+	void append_cx_string(CXString cx_string) {
+		clangxx::UniqueCXString unique_cx_string(cx_string);
+		const char *c_string = unique_cx_string ? clang_getCString(unique_cx_string.get()) : nullptr;
+		m_buffer.append_string(c_string ? c_string : "");
+	}
+
+	const std::string &kind_name(CXCursorKind kind) {
+		auto found = m_kind_names.find(kind);
+		if ( found == m_kind_names.end() ) {
+			clangxx::UniqueCXString cx_string(clang_getCursorKindSpelling(kind));
+			const char *c_string = cx_string ? clang_getCString(cx_string.get()) : nullptr;
+			found = m_kind_names.insert(std::make_pair(static_cast<int>(kind),
+													   std::string(c_string ? c_string : ""))).first;
+		}
+		return found->second;
+	}
+
+	//! Consecutive nodes are mostly in the same file; only the last name is kept.
+	const std::string &file_name(CXFile cx_file) {
+		if ( cx_file != m_last_file ) {
+			clangxx::UniqueCXString cx_string(clang_getFileName(cx_file));
+			const char *c_string = cx_string ? clang_getCString(cx_string.get()) : nullptr;
+			m_last_file_name = c_string ? c_string : "";
+			m_last_file = cx_file;
+		}
+		return m_last_file_name;
+	}
+}; // class Dumper
+
+} // namespace
+
+namespace clangxx {
+
+void AstDumper::dump(const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+					 const std::vector<std::string> &paths, const Options &options,
+					 unsigned int thread_count/* = 0*/)
+{
+	if ( translation_units.size() != paths.size() ) {
+		CLANGXX_THROW_LogicError("One output path is needed per translation unit.");
+	}
+
+	const AstDumper dumper(options);
+	parallel_for(translation_units.size(), [&](std::size_t index) {
+		dumper.dump(*translation_units[index], paths[index]);
+	}, thread_count);
+}
+
+AstDumper::AstDumper() = default;
+
+AstDumper::AstDumper(Options options)
+	: m_options(std::move(options))
+{}
+
+AstDumper::~AstDumper() = default;
+
+AstDumper::AstDumper(const AstDumper &/*other*/) = default;
+AstDumper::AstDumper(AstDumper &&/*other*/) noexcept = default;
+
+AstDumper &AstDumper::operator=(const AstDumper &/*other*/) = default;
+AstDumper &AstDumper::operator=(AstDumper &&/*other*/) noexcept = default;
+
+void AstDumper::dump(const TranslationUnit &translation_unit, const Sink &sink) const
+{
+	Dumper dumper(m_options, translation_unit.native_handle(), sink);
+	dumper.run();
+}
+
+void AstDumper::dump(const TranslationUnit &translation_unit, std::ostream &ostream) const
+{
+	dump(translation_unit, [&ostream](const char *data, std::size_t size) {
+		ostream.write(data, static_cast<std::streamsize>(size));
+	});
+	if ( !ostream.flush() ) {
+		CLANGXX_THROW_RuntimeError("Error writing the AST dump.");
+	}
+}
+
+void AstDumper::dump(const TranslationUnit &translation_unit, const std::string &path) const
+{
+	std::ofstream ostream(path, std::ios::binary | std::ios::trunc);
+	if ( !ostream ) {
+		CLANGXX_THROW_RuntimeError("Error opening " + path);
+	}
+	dump(translation_unit, ostream);
+}
+
+} // namespace clangxx
@@ -0,0 +1,206 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file AstFileWriter.cpp
+
+   Copyright (c) 2015 pegacorn
+
+   TranslationUnit::export_binary(); the format is described in AstFile.hpp.
+*/
+#include "clang-cpp/TranslationUnit.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/AstFile.hpp"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/SymbolTable.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+using clangxx::AstFile;
+using clangxx::AstFileNode;
+using clangxx::ast_file_invalid;
+
+class Writer
+{
+  private:
+	struct Frame
+	{
+		Writer			*writer;
+		std::uint32_t	parent;
+		std::uint32_t	last_child;
+	}; // struct Frame
+
+  private:
+	CXTranslationUnit									m_cx_translation_unit;
+	clangxx::LocationFilter								m_filter;
+	bool												m_filters;
+	std::vector<AstFileNode>							m_nodes;
+	std::vector<clangxx::AstFileEntry>					m_files;
+	std::unordered_map<CXFile, std::uint32_t>			m_file_ids;
+	std::unordered_map<std::uint32_t, std::uint32_t>	m_kind_names;
+	clangxx::SymbolTable								m_strings;
+
+  public:
+	Writer(CXTranslationUnit cx_translation_unit, const clangxx::TraversalOptions &options)
+		: m_cx_translation_unit(cx_translation_unit)
+		, m_filter(options, cx_translation_unit)
+		, m_filters(options.filters_locations() || options.header_deduplicator)
+	{
+		m_strings.intern(std::string());
+	}
+
+  public:
+	void run() {
+		const CXCursor root(clang_getTranslationUnitCursor(m_cx_translation_unit));
+		const std::uint32_t index(add(root, ast_file_invalid));
+		Frame frame{this, index, ast_file_invalid};
+		clang_visitChildren(root, &Writer::visit, &frame);
+	}
+
+	void write(const std::string &path) const {
+		std::ofstream ostream(path, std::ios::binary | std::ios::trunc);
+		if ( !ostream ) {
+			CLANGXX_THROW_RuntimeError("Error opening " + path);
+		}
+
+		std::vector<clangxx::AstFileKind> kinds;
+		kinds.reserve(m_kind_names.size());
+		for ( const auto &kind : m_kind_names ) {
+			kinds.push_back(clangxx::AstFileKind{kind.first, kind.second});
+		}
+		// unordered_map order would make the output differ from run to run
+		std::sort(kinds.begin(), kinds.end(),
+				  [](const clangxx::AstFileKind &lhs, const clangxx::AstFileKind &rhs) {
+					  return lhs.kind < rhs.kind;
+				  });
+
+		std::vector<std::uint64_t> offsets;
+		offsets.reserve(m_strings.size() + 1);
+		std::uint64_t offset = 0;
+		for ( const auto &string : m_strings.names() ) {
+			offsets.push_back(offset);
+			offset += string.size() + 1;
+		}
+		offsets.push_back(offset);
+
+		clangxx::AstFileHeader header;
+		std::memcpy(header.magic, clangxx::ast_file_magic, sizeof(clangxx::ast_file_magic));
+		header.version = clangxx::ast_file_version;
+		header.byte_order = clangxx::ast_file_byte_order;
+		header.node_count = m_nodes.size();
+		header.file_count = m_files.size();
+		header.kind_count = kinds.size();
+		header.string_count = m_strings.size();
+		header.string_bytes = offset;
+
+		const char padding[8] = {};
+		auto write = [&ostream, &padding](const void *data, std::size_t size) {
+			ostream.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+			ostream.write(padding, static_cast<std::streamsize>(AstFile::align8(size) - size));
+		};
+		write(&header, sizeof(header));
+		write(m_nodes.data(), m_nodes.size() * sizeof(AstFileNode));
+		write(m_files.data(), m_files.size() * sizeof(clangxx::AstFileEntry));
+		write(kinds.data(), kinds.size() * sizeof(clangxx::AstFileKind));
+		write(offsets.data(), offsets.size() * sizeof(std::uint64_t));
+		for ( const auto &string : m_strings.names() ) {
+			ostream.write(string.c_str(), static_cast<std::streamsize>(string.size() + 1));
+		}
+		if ( !ostream.flush() ) {
+			CLANGXX_THROW_RuntimeError("Error writing " + path);
+		}
+	}
+
+  private:
+	static CXChildVisitResult visit(CXCursor cursor, CXCursor parent, CXClientData client_data) {
+		const auto frame = static_cast<Frame *>(client_data);
+		Writer &writer = *frame->writer;
+		if ( writer.m_filters && !writer.m_filter.accepts(cursor, parent) ) {
+			return CXChildVisit_Continue;
+		}
+
+		const std::uint32_t index(writer.add(cursor, frame->parent));
+		if ( frame->last_child == ast_file_invalid ) {
+			writer.m_nodes[frame->parent].first_child = index;
+		}
+		else {
+			writer.m_nodes[frame->last_child].next_sibling = index;
+		}
+		frame->last_child = index;
+
+		Frame child_frame{&writer, index, ast_file_invalid};
+		clang_visitChildren(cursor, &Writer::visit, &child_frame);
+		return CXChildVisit_Continue;
+	}
+
+	std::uint32_t add(CXCursor cursor, std::uint32_t parent) {
+		AstFileNode node;
+		node.kind = static_cast<std::uint32_t>(cursor.kind);
+		node.parent = parent;
+		node.first_child = ast_file_invalid;
+		node.next_sibling = ast_file_invalid;
+		node.spelling = intern(clang_getCursorSpelling(cursor));
+		node.usr = clang_isDeclaration(cursor.kind) ? intern(clang_getCursorUSR(cursor)) : 0;
+
+		CXFile cx_file = nullptr;
+		unsigned int line = 0, column = 0;
+		clang_getExpansionLocation(clang_getCursorLocation(cursor), &cx_file, &line, &column, nullptr);
+		node.location = AstFile::pack_location(file_id(cx_file), line, column);
+
+		if ( m_kind_names.find(node.kind) == m_kind_names.end() ) {
+			m_kind_names[node.kind] = intern(clang_getCursorKindSpelling(cursor.kind));
+		}
+
+		m_nodes.push_back(node);
+		return static_cast<std::uint32_t>(m_nodes.size() - 1);
+	}
+
+	std::uint32_t intern(CXString cx_string) {
+		clangxx::UniqueCXString unique_cx_string(cx_string);
+		const char *c_string = unique_cx_string ? clang_getCString(unique_cx_string.get()) : nullptr;
+		return (c_string && *c_string) ? m_strings.intern(c_string) : 0;
+	}
+
+	std::uint32_t file_id(CXFile cx_file) {
+		if ( !cx_file ) {
+			return ast_file_invalid;
+		}
+		const auto found = m_file_ids.find(cx_file);
+		if ( found != m_file_ids.end() ) {
+			return found->second;
+		}
+
+		clangxx::AstFileEntry entry;
+		entry.name = intern(clang_getFileName(cx_file));
+		entry.reserved = 0;
+		entry.time = static_cast<std::int64_t>(clang_getFileTime(cx_file));
+		m_files.push_back(entry);
+		const std::uint32_t id(static_cast<std::uint32_t>(m_files.size() - 1));
+		m_file_ids[cx_file] = id;
+		return id;
+	}
+}; // class Writer
+
+} // namespace
+
+namespace clangxx {
+
+void TranslationUnit::export_binary(const std::string &path,
+									const TraversalOptions &options/* = TraversalOptions()*/) const
+{
+	Writer writer(native_handle(), options);
+	writer.run();
+	writer.write(path);
+}
+
+} // namespace clangxx
@@ -0,0 +1,344 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file AstSnapshot.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/AstSnapshot.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/CursorMap.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+using Hash			= clangxx::AstSnapshot::Hash;
+using Declarations	= clangxx::AstSnapshot::Declarations;
+
+inline Hash rotate_left(Hash value, int shift) noexcept
+{
+	return (value << shift) | (value >> (64 - shift));
+}
+
+inline Hash combine(Hash seed, Hash value) noexcept
+{
+	value *= UINT64_C(0x87c37b91114253d5);
+	value = rotate_left(value, 31);
+	value *= UINT64_C(0x4cf5ad432745937f);
+	seed ^= value;
+	return rotate_left(seed, 27) * 5 + UINT64_C(0x52dce729);
+}
+
+inline Hash finalize(Hash hash) noexcept
+{
+	hash ^= hash >> 33;
+	hash *= UINT64_C(0xff51afd7ed558ccd);
+	hash ^= hash >> 33;
+	hash *= UINT64_C(0xc4ceb9fe1a85ec53);
+	hash ^= hash >> 33;
+	return hash;
+}
+
+Hash hash_bytes(const char *data, std::size_t size) noexcept
+{
+	Hash hash = UINT64_C(0xcbf29ce484222325);
+	for ( std::size_t i = 0; i < size; ++i ) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= UINT64_C(0x100000001b3);
+	}
+	return hash;
+}
+
+Hash hash_string(CXString cx_string) noexcept
+{
+	clangxx::UniqueCXString unique_cx_string(cx_string);
+	const char *c_string = unique_cx_string ? clang_getCString(unique_cx_string.get()) : nullptr;
+	return c_string ? hash_bytes(c_string, std::strlen(c_string)) : 0;
+}
+
+bool is_literal_kind(CXCursorKind kind) noexcept
+{
+	switch ( kind ) {
+	  case CXCursor_IntegerLiteral:
+	  case CXCursor_FloatingLiteral:
+	  case CXCursor_ImaginaryLiteral:
+	  case CXCursor_StringLiteral:
+	  case CXCursor_CharacterLiteral:
+	  case CXCursor_CXXBoolLiteralExpr:
+		return true;
+	  default:
+		return false;
+	}
+}
+
+bool is_operator_kind(CXCursorKind kind) noexcept
+{
+	switch ( kind ) {
+	  case CXCursor_UnaryOperator:
+	  case CXCursor_BinaryOperator:
+	  case CXCursor_CompoundAssignOperator:
+		return true;
+	  default:
+		return false;
+	}
+}
+
+//! Declarations whose hash belongs to their parent rather than to their own USR.
+bool is_parameter_kind(CXCursorKind kind) noexcept
+{
+	switch ( kind ) {
+	  case CXCursor_ParmDecl:
+	  case CXCursor_TemplateTypeParameter:
+	  case CXCursor_NonTypeTemplateParameter:
+	  case CXCursor_TemplateTemplateParameter:
+		return true;
+	  default:
+		return false;
+	}
+}
+
+class Hasher
+{
+  private:
+	struct Frame
+	{
+		Hasher		*hasher;
+		Hash		hash;
+		//! like hash, but with the nested declarations by identity only
+		Hash		shallow_hash;
+		std::size_t	children;
+		bool		in_body;
+	}; // struct Frame
+
+  private:
+	CXTranslationUnit			m_cx_translation_unit;
+	clangxx::LocationFilter		m_filter;
+	bool						m_filters;
+	Declarations				&m_declarations;
+	clangxx::CursorMap<Hash>	&m_subtrees;
+
+  public:
+	Hasher(const clangxx::TraversalOptions &options, CXTranslationUnit cx_translation_unit,
+		   Declarations &declarations, clangxx::CursorMap<Hash> &subtrees)
+		: m_cx_translation_unit(cx_translation_unit)
+		, m_filter(options, cx_translation_unit)
+		, m_filters(options.filters_locations() || options.header_deduplicator)
+		, m_declarations(declarations)
+		, m_subtrees(subtrees)
+	{}
+
+  public:
+	void run() {
+		const CXCursor root(clang_getTranslationUnitCursor(m_cx_translation_unit));
+		Frame frame{this, 0, 0, 0, false};
+		clang_visitChildren(root, &Hasher::visit, &frame);
+	}
+
+  private:
+	static CXChildVisitResult visit(CXCursor cursor, CXCursor parent, CXClientData client_data) {
+		const auto frame = static_cast<Frame *>(client_data);
+		Hasher &hasher = *frame->hasher;
+		if ( hasher.m_filters && parent.kind == CXCursor_TranslationUnit
+			 && !hasher.m_filter.accepts(cursor, parent) )
+		{
+			return CXChildVisit_Continue;
+		}
+
+		Hash identity;
+		frame->hash = combine(frame->hash, hasher.subtree(cursor, frame->in_body, identity));
+		frame->shallow_hash = combine(frame->shallow_hash, identity);
+		++frame->children;
+		return CXChildVisit_Continue;
+	}
+
+	/*!
+	  @return the hash of the subtree at @a cursor.
+	  @param identity	set to what its parent's declaration hash takes from
+						it: the USR hash of a recorded declaration, so that
+						editing a member does not change its class or
+						namespace, or else the subtree hash.
+	*/
+	Hash subtree(CXCursor cursor, bool in_body, Hash &identity) {
+		const CXCursorKind kind(cursor.kind);
+		const Hash own_hash(node_hash(cursor));
+		Frame frame{this, own_hash, own_hash, 0,
+					in_body || clang_isStatement(kind) || clang_isExpression(kind)};
+		clang_visitChildren(cursor, &Hasher::visit, &frame);
+		const Hash hash(finalize(combine(frame.hash, frame.children)));
+
+		m_subtrees.insert(cursor, hash);
+		identity = hash;
+		if ( !in_body && clang_isDeclaration(kind) && !is_parameter_kind(kind) ) {
+			const Hash usr_hash(record(cursor, finalize(combine(frame.shallow_hash, frame.children))));
+			if ( usr_hash ) {
+				identity = usr_hash;
+			}
+		}
+		return hash;
+	}
+
+	Hash node_hash(CXCursor cursor) {
+		const CXCursorKind kind(cursor.kind);
+		Hash hash(combine(0, static_cast<Hash>(kind)));
+		hash = combine(hash, hash_string(clang_getCursorSpelling(cursor)));
+
+		if ( clang_isDeclaration(kind) ) {
+			hash = combine(hash, hash_string(clang_getTypeSpelling(clang_getCursorType(cursor))));
+			hash = combine(hash, static_cast<Hash>(clang_getCXXAccessSpecifier(cursor)));
+			if ( kind == CXCursor_CXXMethod ) {
+				hash = combine(hash, (clang_CXXMethod_isVirtual(cursor) ? 1u : 0u)
+							   | (clang_CXXMethod_isPureVirtual(cursor) ? 2u : 0u)
+							   | (clang_CXXMethod_isStatic(cursor) ? 4u : 0u));
+			}
+		}
+		else if ( is_literal_kind(kind) ) {
+			hash = combine(hash, token_hash(clang_getCursorExtent(cursor), ~0u));
+		}
+		else if ( is_operator_kind(kind) ) {
+			hash = combine(hash, token_hash(operator_range(cursor), 1));
+		}
+		return hash;
+	}
+
+	/*!
+	  Range starting at the operator token of @a cursor: the gap between the
+	  operands, or before/after the operand of a unary operator.  Tokenizing
+	  the whole extent would retokenize the subexpression at every level.
+	*/
+	static CXSourceRange operator_range(CXCursor cursor) {
+		struct Operands
+		{
+			CXSourceRange	extents[2];
+			unsigned int	count;
+		} operands{{}, 0};
+		clang_visitChildren(cursor, [](CXCursor child, CXCursor, CXClientData client_data) {
+			auto operands = static_cast<Operands *>(client_data);
+			operands->extents[operands->count++] = clang_getCursorExtent(child);
+			return (operands->count < 2) ? CXChildVisit_Continue : CXChildVisit_Break;
+		}, &operands);
+
+		const CXSourceRange extent(clang_getCursorExtent(cursor));
+		if ( operands.count == 2 ) {
+			return clang_getRange(clang_getRangeEnd(operands.extents[0]),
+								  clang_getRangeStart(operands.extents[1]));
+		}
+		if ( operands.count == 1 ) {
+			const CXSourceLocation operand_start(clang_getRangeStart(operands.extents[0]));
+			if ( clang_equalLocations(clang_getRangeStart(extent), operand_start) ) {
+				// postfix
+				return clang_getRange(clang_getRangeEnd(operands.extents[0]),
+									  clang_getRangeEnd(extent));
+			}
+			return clang_getRange(clang_getRangeStart(extent), operand_start);
+		}
+		return extent;
+	}
+
+	//! Literal values and operators have no spelling; hash their tokens instead.
+	Hash token_hash(CXSourceRange range, unsigned int max_tokens) {
+		CXToken *tokens = nullptr;
+		unsigned int token_count = 0;
+		clang_tokenize(m_cx_translation_unit, range, &tokens, &token_count);
+
+		Hash hash = 0;
+		for ( unsigned int i = 0; i < token_count && i < max_tokens; ++i ) {
+			hash = combine(hash, hash_string(clang_getTokenSpelling(m_cx_translation_unit, tokens[i])));
+		}
+		if ( tokens ) {
+			clang_disposeTokens(m_cx_translation_unit, tokens, token_count);
+		}
+		return hash;
+	}
+
+	//! @return the hash of the USR of @a cursor, or 0 if it has none and is not recorded.
+	Hash record(CXCursor cursor, Hash hash) {
+		clangxx::UniqueCXString usr(clang_getCursorUSR(cursor));
+		const char *c_usr = usr ? clang_getCString(usr.get()) : nullptr;
+		if ( !c_usr || !*c_usr ) {
+			return 0;
+		}
+
+		// a declaration and its definition share a USR
+		Hash &declaration_hash = m_declarations[c_usr];
+		declaration_hash = declaration_hash ? finalize(combine(declaration_hash, hash)) : hash;
+		return finalize(hash_bytes(c_usr, std::strlen(c_usr)));
+	}
+}; // class Hasher
+
+} // namespace
+
+namespace clangxx {
+
+AstSnapshot AstSnapshot::capture(const TranslationUnit &translation_unit,
+								 const TraversalOptions &options/* = TraversalOptions()*/)
+{
+	AstSnapshot snapshot;
+	Hasher hasher(options, translation_unit.native_handle(),
+				  snapshot.m_declarations, snapshot.m_subtrees);
+	hasher.run();
+	return snapshot;
+}
+
+AstDiff AstSnapshot::diff(const AstSnapshot &old_snapshot, const AstSnapshot &new_snapshot)
+{
+	AstDiff result;
+	for ( const auto &declaration : new_snapshot.m_declarations ) {
+		const auto found = old_snapshot.m_declarations.find(declaration.first);
+		if ( found == old_snapshot.m_declarations.end() ) {
+			result.added.push_back(declaration.first);
+		}
+		else if ( found->second != declaration.second ) {
+			result.changed.push_back(declaration.first);
+		}
+	}
+	for ( const auto &declaration : old_snapshot.m_declarations ) {
+		if ( new_snapshot.m_declarations.find(declaration.first) == new_snapshot.m_declarations.end() ) {
+			result.removed.push_back(declaration.first);
+		}
+	}
+
+	std::sort(result.added.begin(), result.added.end());
+	std::sort(result.removed.begin(), result.removed.end());
+	std::sort(result.changed.begin(), result.changed.end());
+	return result;
+}
+
+AstSnapshot::AstSnapshot() = default;
+
+AstSnapshot::~AstSnapshot() = default;
+
+AstSnapshot::AstSnapshot(const AstSnapshot &/*other*/) = default;
+AstSnapshot::AstSnapshot(AstSnapshot &&/*other*/) noexcept = default;
+
+AstSnapshot &AstSnapshot::operator=(const AstSnapshot &/*other*/) = default;
+AstSnapshot &AstSnapshot::operator=(AstSnapshot &&/*other*/) noexcept = default;
+
+AstSnapshot::Hash AstSnapshot::declaration_hash(const std::string &usr) const
+{
+	const auto found = m_declarations.find(usr);
+	return (found != m_declarations.end()) ? found->second : 0;
+}
+
+AstSnapshot::Hash AstSnapshot::subtree_hash(CXCursor cx_cursor) const noexcept
+{
+	const Hash *hash = m_subtrees.find(cx_cursor);
+	return hash ? *hash : 0;
+}
+
+AstSnapshot::Hash AstSnapshot::subtree_hash(const Cursor &cursor) const noexcept
+{
+	return subtree_hash(cursor.native_handle());
+}
+
+} // namespace clangxx
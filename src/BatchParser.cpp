@@ -0,0 +1,233 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file BatchParser.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/BatchParser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/ParseProfile.hpp"
+#include "clang-cpp/PchManager.hpp"
+#include "clang-cpp/Trace.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+using Clock		= std::chrono::steady_clock;
+using Signature	= clangxx::ParseProfile::Signature;
+
+double seconds_since(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void collect_inclusion(CXFile included_file, CXSourceLocation * /*inclusion_stack*/,
+					   unsigned int include_len, CXClientData client_data)
+{
+	if ( include_len == 0 ) {
+		return; // the main file, which no other job shares
+	}
+	clangxx::UniqueCXString name(clang_getFileName(included_file));
+	if ( name && clang_getCString(name.get()) ) {
+		static_cast<std::vector<std::string> *>(client_data)->push_back(
+			clang_getCString(name.get()));
+	}
+}
+
+//! Hands out jobs to workers; see BatchParser.
+class Scheduler
+{
+  private:
+	struct Pending
+	{
+		std::size_t	job;
+		double		cost;
+		bool		has_signature;
+		Signature	signature;
+	}; // struct Pending
+
+  private:
+	std::mutex				m_mutex;
+	std::vector<Pending>	m_pending;
+	std::vector<bool>		m_taken;
+	std::size_t				m_head{0};
+	const std::size_t		m_window;
+	const bool				m_locality;
+
+  public:
+	Scheduler(const std::vector<clangxx::ParseJob> &jobs, const clangxx::ParseProfile *profile,
+			  bool locality, std::size_t window)
+		: m_window(window)
+		, m_locality(locality)
+	{
+		m_pending.reserve(jobs.size());
+		double known_cost = 0;
+		std::size_t known_count = 0;
+		for ( std::size_t i = 0; i < jobs.size(); ++i ) {
+			clangxx::ParseProfile::Entry entry;
+			const bool known = profile && profile->find(jobs[i].filename, entry);
+			m_pending.push_back(Pending{i, known ? entry.seconds : -1, known, entry.signature});
+			if ( known ) {
+				known_cost += entry.seconds;
+				++known_count;
+			}
+		}
+		m_taken.assign(m_pending.size(), false);
+
+		if ( m_locality ) {
+			// jobs never parsed before are assumed to be average
+			const double average = known_count ? known_cost / known_count : 0;
+			for ( auto &pending : m_pending ) {
+				if ( pending.cost < 0 ) {
+					pending.cost = average;
+				}
+			}
+			std::stable_sort(m_pending.begin(), m_pending.end(),
+							 [](const Pending &lhs, const Pending &rhs) {
+								 return lhs.cost > rhs.cost;
+							 });
+		}
+	}
+
+  public:
+	//! @return false when no job is left.
+	bool next(const Signature *last, std::size_t &job, const Signature *&signature) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		while ( m_head < m_pending.size() && m_taken[m_head] ) {
+			++m_head;
+		}
+		if ( m_head == m_pending.size() ) {
+			return false;
+		}
+
+		std::size_t chosen = m_head;
+		if ( m_locality && last ) {
+			double best = 0;
+			std::size_t seen = 0;
+			for ( std::size_t i = m_head; i < m_pending.size() && seen < m_window; ++i ) {
+				if ( m_taken[i] ) {
+					continue;
+				}
+				++seen;
+				if ( !m_pending[i].has_signature ) {
+					continue;
+				}
+				const double similarity(clangxx::ParseProfile::similarity(*last, m_pending[i].signature));
+				if ( similarity > best ) {
+					best = similarity;
+					chosen = i;
+				}
+			}
+		}
+
+		m_taken[chosen] = true;
+		job = m_pending[chosen].job;
+		signature = m_pending[chosen].has_signature ? &m_pending[chosen].signature : nullptr;
+		return true;
+	}
+}; // class Scheduler
+
+} // namespace
+
+namespace clangxx {
+
+BatchParser::BatchParser(std::shared_ptr<Index> index/* = nullptr*/,
+						 unsigned int thread_count/* = 0*/)
+	: m_index(index ? std::move(index) : Index::create())
+	, m_thread_count(thread_count)
+{}
+
+BatchParser::~BatchParser() = default;
+
+std::vector<ParseResult> BatchParser::parse(const std::vector<ParseJob> &jobs)
+{
+	trace::Span span("batch", "parse");
+	const auto start = Clock::now();
+
+	std::vector<ParseJob> prepared(jobs);
+	if ( m_pch_manager ) {
+		trace::Span pch_span("batch", "prepare_pch");
+		m_pch_manager->prepare(prepared, m_index, m_thread_count);
+	}
+
+	Scheduler scheduler(prepared, m_profile, m_schedule == Schedule::Locality, m_window);
+	std::vector<ParseResult> results(prepared.size());
+	std::vector<double> durations(prepared.size(), 0);
+
+	unsigned int thread_count = m_thread_count;
+	if ( thread_count == 0 ) {
+		thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	const bool locality = (m_schedule == Schedule::Locality);
+	parallel_for(std::min<std::size_t>(thread_count, prepared.size()), [&](std::size_t /*worker*/) {
+		Signature last;
+		bool has_last = false;
+		std::size_t index;
+		const Signature *signature;
+		for ( ;; ) {
+			{
+				trace::Span schedule_span("batch", "schedule");
+				if ( !scheduler.next(has_last ? &last : nullptr, index, signature) ) {
+					break;
+				}
+			}
+			const ParseJob &job = prepared[index];
+			trace::Span job_span("batch", "job", job.filename);
+			const auto job_start = Clock::now();
+			try {
+				results[index].translation_unit = TranslationUnit::from_source(
+					job.filename, &job.args, nullptr, job.options, m_index);
+			}
+			catch ( ... ) {
+				results[index].error = std::current_exception();
+			}
+			durations[index] = seconds_since(job_start);
+
+			has_last = false;
+			if ( results[index].translation_unit && (m_profile || (locality && !signature)) ) {
+				std::vector<std::string> includes;
+				clang_getInclusions(results[index].translation_unit->native_handle(),
+									&collect_inclusion, &includes);
+				last = ParseProfile::signature(includes);
+				has_last = true;
+				if ( m_profile ) {
+					m_profile->record(job.filename, durations[index], includes);
+				}
+			}
+			else if ( signature ) {
+				last = *signature;
+				has_last = true;
+			}
+		}
+	}, thread_count);
+
+	BatchStats stats;
+	stats.jobs = results.size();
+	for ( std::size_t i = 0; i < results.size(); ++i ) {
+		stats.parse_seconds += durations[i];
+		if ( results[i].error ) {
+			++stats.failures;
+		}
+	}
+	stats.wall_seconds = seconds_since(start);
+	m_last_stats = stats;
+	return results;
+}
+
+} // namespace clangxx
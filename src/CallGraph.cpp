@@ -0,0 +1,552 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file CallGraph.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/CallGraph.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/CursorMap.hpp"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/MappedFile.hpp"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/SymbolTable.hpp"
+#include "clang-cpp/Trace.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+using clangxx::CallGraph;
+using NodeId	= CallGraph::NodeId;
+using EdgeIndex	= CallGraph::EdgeIndex;
+using Edge		= std::pair<NodeId, NodeId>;
+
+const char			file_magic[8]	= {'C', 'X', 'X', 'C', 'G', 'R', 'F', '\0'};
+const std::uint32_t	file_version	= 1;
+const std::uint32_t	byte_order_mark	= 0x01020304;
+
+struct FileHeader
+{
+	char			magic[8];
+	std::uint32_t	version;
+	std::uint32_t	byte_order;
+	std::uint64_t	node_count;
+	std::uint64_t	edge_count;
+	std::uint64_t	name_bytes;
+}; // struct FileHeader
+
+std::size_t align8(std::size_t size)
+{
+	return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+bool is_function_kind(CXCursorKind kind)
+{
+	switch ( kind ) {
+	  case CXCursor_FunctionDecl:
+	  case CXCursor_CXXMethod:
+	  case CXCursor_Constructor:
+	  case CXCursor_Destructor:
+	  case CXCursor_ConversionFunction:
+	  case CXCursor_FunctionTemplate:
+		return true;
+	  default:
+		return false;
+	}
+}
+
+//! Edges of one translation unit, with node ids local to it.
+struct LocalGraph
+{
+	std::vector<std::string>	usrs;
+	std::vector<Edge>			calls;
+	std::vector<Edge>			dynamic_calls;
+	std::vector<Edge>			overrides;	// (method, overridden method)
+}; // struct LocalGraph
+
+class Extractor
+{
+  private:
+	struct Context
+	{
+		Extractor	*extractor;
+		NodeId		caller;
+	}; // struct Context
+
+  private:
+	LocalGraph						&m_graph;
+	clangxx::CursorMap<NodeId>		m_nodes;
+	clangxx::CursorSet				m_methods;
+
+  public:
+	explicit Extractor(LocalGraph &graph)
+		: m_graph(graph)
+	{}
+
+  public:
+	void run(CXCursor root) {
+		Context context{this, CallGraph::invalid_node};
+		clang_visitChildren(root, &Extractor::visit, &context);
+	}
+
+  private:
+	static CXChildVisitResult visit(CXCursor cursor, CXCursor /*parent*/, CXClientData client_data) {
+		auto context = static_cast<Context *>(client_data);
+		Extractor &self = *context->extractor;
+
+		if ( is_function_kind(cursor.kind) ) {
+			Context inner{&self, self.node(cursor)};
+			if ( cursor.kind == CXCursor_CXXMethod ) {
+				self.add_overrides(cursor, inner.caller);
+			}
+			clang_visitChildren(cursor, &Extractor::visit, &inner);
+			return CXChildVisit_Continue;
+		}
+
+		if ( (cursor.kind == CXCursor_CallExpr) && (context->caller != CallGraph::invalid_node) ) {
+			const CXCursor callee(clang_getCursorReferenced(cursor));
+			if ( !clangxx::is_null(callee) && is_function_kind(callee.kind) ) {
+				const NodeId callee_node{self.node(callee)};
+				if ( callee_node != CallGraph::invalid_node ) {
+					const bool is_dynamic{(callee.kind == CXCursor_CXXMethod)
+										  && clang_CXXMethod_isVirtual(callee)
+										  && clang_Cursor_isDynamicCall(cursor)};
+					(is_dynamic ? self.m_graph.dynamic_calls : self.m_graph.calls)
+						.emplace_back(context->caller, callee_node);
+				}
+			}
+		}
+		return CXChildVisit_Recurse;
+	}
+
+	NodeId node(CXCursor cursor) {
+		const CXCursor canonical(clang_getCanonicalCursor(cursor));
+		const auto result = m_nodes.insert(canonical, CallGraph::invalid_node);
+		if ( result.second ) {
+			clangxx::UniqueCXString cx_string(clang_getCursorUSR(canonical));
+			const char *usr = cx_string ? clang_getCString(cx_string.get()) : nullptr;
+			if ( usr && *usr ) {
+				*result.first = static_cast<NodeId>(m_graph.usrs.size());
+				m_graph.usrs.emplace_back(usr);
+			}
+		}
+		return *result.first;
+	}
+
+	void add_overrides(CXCursor method, NodeId method_node) {
+		if ( (method_node == CallGraph::invalid_node)
+			 || !m_methods.insert(clang_getCanonicalCursor(method)) )
+		{
+			return;
+		}
+
+		CXCursor *overridden{nullptr};
+		unsigned int num_overridden{0};
+		clang_getOverriddenCursors(method, &overridden, &num_overridden);
+		const clangxx::UniqueCXCursorPtr overridden_ptr(overridden);
+		for ( unsigned int i{0}; i < num_overridden; ++i ) {
+			const NodeId overridden_node{node(overridden[i])};
+			if ( overridden_node != CallGraph::invalid_node ) {
+				m_graph.overrides.emplace_back(method_node, overridden_node);
+			}
+		}
+	}
+}; // class Extractor
+
+//! Adds to @a out every method overriding @a method, directly or not.
+void collect_overriders(NodeId method,
+						const std::unordered_map<NodeId, std::vector<NodeId>> &overriders,
+						std::vector<NodeId> &out)
+{
+	std::vector<NodeId> stack{method};
+	while ( !stack.empty() ) {
+		const NodeId current{stack.back()};
+		stack.pop_back();
+		const auto iter = overriders.find(current);
+		if ( iter == overriders.end() ) {
+			continue;
+		}
+		for ( const NodeId overrider : iter->second ) {
+			if ( std::find(out.begin(), out.end(), overrider) == out.end() ) {
+				out.push_back(overrider);
+				stack.push_back(overrider);
+			}
+		}
+	}
+}
+
+} // namespace
+
+namespace clangxx {
+
+const CallGraph::NodeId	CallGraph::invalid_node;
+
+CallGraph CallGraph::build(
+  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+  unsigned int thread_count/* = 0*/)
+{
+	std::vector<LocalGraph> locals(translation_units.size());
+	parallel_for(translation_units.size(), [&](std::size_t index) {
+		trace::Span span("index", "call_graph");
+		if ( span ) {
+			span.set_argument(translation_units[index]->spelling());
+		}
+		Extractor extractor(locals[index]);
+		extractor.run(clang_getTranslationUnitCursor(
+			translation_units[index]->native_handle()));
+	}, thread_count);
+
+	SymbolTable symbols;
+	std::vector<Edge> edges;
+	std::vector<Edge> dynamic_calls;
+	std::unordered_map<NodeId, std::vector<NodeId>> overriders;
+	for ( auto &local : locals ) {
+		std::vector<NodeId> ids; ids.reserve(local.usrs.size());
+		for ( const auto &usr : local.usrs ) {
+			ids.push_back(symbols.intern(usr));
+		}
+		for ( const auto &edge : local.calls ) {
+			edges.emplace_back(ids[edge.first], ids[edge.second]);
+		}
+		for ( const auto &edge : local.dynamic_calls ) {
+			dynamic_calls.emplace_back(ids[edge.first], ids[edge.second]);
+		}
+		for ( const auto &edge : local.overrides ) {
+			auto &list = overriders[ids[edge.second]];
+			if ( std::find(list.begin(), list.end(), ids[edge.first]) == list.end() ) {
+				list.push_back(ids[edge.first]);
+			}
+		}
+		local = LocalGraph();
+	}
+
+	std::unordered_map<NodeId, std::vector<NodeId>> dispatch_targets;
+	for ( const auto &edge : dynamic_calls ) {
+		edges.push_back(edge);
+		auto result = dispatch_targets.emplace(edge.second, std::vector<NodeId>());
+		if ( result.second ) {
+			collect_overriders(edge.second, overriders, result.first->second);
+		}
+		for ( const NodeId target : result.first->second ) {
+			edges.emplace_back(edge.first, target);
+		}
+	}
+
+	return from_edges(symbols.names(), std::move(edges));
+}
+
+CallGraph CallGraph::from_edges(const std::vector<std::string> &usrs,
+								std::vector<std::pair<NodeId, NodeId>> edges)
+{
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	CallGraph graph;
+	const std::size_t node_count{usrs.size()};
+	graph.m_offset_storage.assign(node_count + 1, 0);
+	for ( const auto &edge : edges ) {
+		++graph.m_offset_storage[edge.first + 1];
+	}
+	for ( std::size_t i{0}; i < node_count; ++i ) {
+		graph.m_offset_storage[i + 1] += graph.m_offset_storage[i];
+	}
+	graph.m_target_storage.reserve(edges.size());
+	for ( const auto &edge : edges ) {
+		graph.m_target_storage.push_back(edge.second);
+	}
+
+	graph.m_name_offset_storage.reserve(node_count + 1);
+	for ( const auto &usr : usrs ) {
+		graph.m_name_offset_storage.push_back(graph.m_name_storage.size());
+		graph.m_name_storage.insert(graph.m_name_storage.end(), usr.begin(), usr.end());
+		graph.m_name_storage.push_back('\0');
+	}
+	graph.m_name_offset_storage.push_back(graph.m_name_storage.size());
+
+	graph.m_sorted_storage.resize(node_count);
+	for ( std::size_t i{0}; i < node_count; ++i ) {
+		graph.m_sorted_storage[i] = static_cast<NodeId>(i);
+	}
+	std::sort(graph.m_sorted_storage.begin(), graph.m_sorted_storage.end(),
+			  [&usrs](NodeId lhs, NodeId rhs) {
+				  return usrs[lhs] < usrs[rhs];
+			  });
+
+	graph.m_node_count = static_cast<NodeId>(node_count);
+	graph.adopt_storage();
+	return graph;
+}
+
+CallGraph CallGraph::load(const std::string &path)
+{
+	std::shared_ptr<MappedFile> mapped_file(new MappedFile(path));
+	const char *data = mapped_file->data();
+	const std::size_t size{mapped_file->size()};
+
+	FileHeader header;
+	if ( size < sizeof(header) ) {
+		CLANGXX_THROW_RuntimeError("Truncated call graph file: " + path);
+	}
+	std::memcpy(&header, data, sizeof(header));
+	if ( std::memcmp(header.magic, file_magic, sizeof(file_magic)) != 0
+		 || header.version != file_version
+		 || header.byte_order != byte_order_mark )
+	{
+		CLANGXX_THROW_RuntimeError("Not a call graph file of this version: " + path);
+	}
+
+	// the counts are untrusted: check each section against the bytes left
+	// before multiplying, so that a corrupt header cannot overflow
+	if ( header.node_count >= CallGraph::invalid_node ) {
+		CLANGXX_THROW_RuntimeError("Corrupt call graph file: " + path);
+	}
+	std::size_t remaining{size - sizeof(header)};
+	auto section_size = [&remaining, &path](std::uint64_t count, std::size_t element_size) {
+		if ( count > remaining / element_size ) {
+			CLANGXX_THROW_RuntimeError("Truncated call graph file: " + path);
+		}
+		const std::size_t bytes{std::min(align8(static_cast<std::size_t>(count) * element_size),
+										 remaining)};
+		remaining -= bytes;
+		return bytes;
+	};
+	const std::size_t offsets_size{section_size(header.node_count + 1, sizeof(EdgeIndex))};
+	const std::size_t name_offsets_size{section_size(header.node_count + 1, sizeof(std::uint64_t))};
+	const std::size_t targets_size{section_size(header.edge_count, sizeof(NodeId))};
+	const std::size_t sorted_size{section_size(header.node_count, sizeof(NodeId))};
+	if ( header.name_bytes > remaining ) {
+		CLANGXX_THROW_RuntimeError("Truncated call graph file: " + path);
+	}
+
+	CallGraph graph;
+	const char *cursor = data + sizeof(header);
+	graph.m_node_count = static_cast<NodeId>(header.node_count);
+	graph.m_offsets = reinterpret_cast<const EdgeIndex *>(cursor);
+	cursor += offsets_size;
+	graph.m_name_offsets = reinterpret_cast<const std::uint64_t *>(cursor);
+	cursor += name_offsets_size;
+	graph.m_targets = reinterpret_cast<const NodeId *>(cursor);
+	cursor += targets_size;
+	graph.m_sorted = reinterpret_cast<const NodeId *>(cursor);
+	cursor += sorted_size;
+	graph.m_names = cursor;
+
+	// every index and offset is checked once here, so that the accessors
+	// can trust them
+	const std::size_t node_count{graph.m_node_count};
+	bool valid = graph.m_offsets[0] == 0 && graph.m_offsets[node_count] == header.edge_count
+		&& graph.m_name_offsets[0] == 0 && graph.m_name_offsets[node_count] == header.name_bytes;
+	for ( std::size_t i{0}; valid && i < node_count; ++i ) {
+		const std::uint64_t name_end{graph.m_name_offsets[i + 1]};
+		// each name ends with a NUL inside its own slot
+		valid = graph.m_offsets[i] <= graph.m_offsets[i + 1]
+			&& graph.m_name_offsets[i] < name_end && name_end <= header.name_bytes
+			&& graph.m_names[name_end - 1] == '\0'
+			&& graph.m_sorted[i] < node_count;
+	}
+	for ( std::size_t i{0}; valid && i < header.edge_count; ++i ) {
+		valid = graph.m_targets[i] < node_count;
+	}
+	// find() bisects the sorted table
+	for ( std::size_t i{1}; valid && i < node_count; ++i ) {
+		valid = std::strcmp(graph.usr(graph.m_sorted[i - 1]), graph.usr(graph.m_sorted[i])) <= 0;
+	}
+	if ( !valid ) {
+		CLANGXX_THROW_RuntimeError("Corrupt call graph file: " + path);
+	}
+
+	graph.m_mapped_file = std::move(mapped_file);
+	return graph;
+}
+
+CallGraph::CallGraph() = default;
+
+CallGraph::~CallGraph() = default;
+
+CallGraph::CallGraph(const CallGraph &other)
+	: m_offset_storage(other.m_offset_storage)
+	, m_target_storage(other.m_target_storage)
+	, m_name_offset_storage(other.m_name_offset_storage)
+	, m_sorted_storage(other.m_sorted_storage)
+	, m_name_storage(other.m_name_storage)
+	, m_mapped_file(other.m_mapped_file)
+	, m_node_count(other.m_node_count)
+	, m_offsets(other.m_offsets)
+	, m_targets(other.m_targets)
+	, m_name_offsets(other.m_name_offsets)
+	, m_sorted(other.m_sorted)
+	, m_names(other.m_names)
+{
+	if ( !m_mapped_file ) {
+		adopt_storage();
+	}
+}
+
+CallGraph::CallGraph(CallGraph &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+CallGraph &CallGraph::operator=(const CallGraph &other)
+{
+	if ( this != &other ) {
+		CallGraph copy(other);
+		*this = std::move(copy);
+	}
+	return *this;
+}
+
+CallGraph &CallGraph::operator=(CallGraph &&other) noexcept
+{
+	if ( this != &other ) {
+		// moving a vector keeps its buffer, so the views stay valid
+		m_offset_storage = std::move(other.m_offset_storage);
+		m_target_storage = std::move(other.m_target_storage);
+		m_name_offset_storage = std::move(other.m_name_offset_storage);
+		m_sorted_storage = std::move(other.m_sorted_storage);
+		m_name_storage = std::move(other.m_name_storage);
+		m_mapped_file = std::move(other.m_mapped_file);
+		m_node_count = other.m_node_count;
+		m_offsets = other.m_offsets;
+		m_targets = other.m_targets;
+		m_name_offsets = other.m_name_offsets;
+		m_sorted = other.m_sorted;
+		m_names = other.m_names;
+
+		other.m_node_count = 0;
+		other.m_offsets = nullptr;
+		other.m_targets = nullptr;
+		other.m_name_offsets = nullptr;
+		other.m_sorted = nullptr;
+		other.m_names = nullptr;
+	}
+	return *this;
+}
+
+CallGraph::NodeId CallGraph::find(const std::string &usr) const
+{
+	const NodeId *first = m_sorted;
+	const NodeId *last = m_sorted + m_node_count;
+	const NodeId *iter = std::lower_bound(first, last, usr,
+		[this](NodeId node, const std::string &value) {
+			return std::strcmp(this->usr(node), value.c_str()) < 0;
+		});
+	if ( iter == last || usr != this->usr(*iter) ) {
+		return invalid_node;
+	}
+	return *iter;
+}
+
+CallGraph CallGraph::reversed() const
+{
+	CallGraph graph;
+	graph.m_offset_storage.assign(m_node_count + 1, 0);
+	const std::size_t edges{edge_count()};
+	for ( std::size_t i{0}; i < edges; ++i ) {
+		++graph.m_offset_storage[m_targets[i] + 1];
+	}
+	for ( std::size_t i{0}; i < m_node_count; ++i ) {
+		graph.m_offset_storage[i + 1] += graph.m_offset_storage[i];
+	}
+
+	std::vector<EdgeIndex> fill(graph.m_offset_storage.begin(), graph.m_offset_storage.end() - 1);
+	graph.m_target_storage.resize(edges);
+	for ( NodeId caller{0}; caller < m_node_count; ++caller ) {
+		const auto range = callees(caller);
+		for ( const NodeId *callee = range.first; callee != range.second; ++callee ) {
+			graph.m_target_storage[fill[*callee]++] = caller;
+		}
+	}
+
+	if ( m_node_count ) {
+		graph.m_name_offset_storage.assign(m_name_offsets, m_name_offsets + m_node_count + 1);
+		graph.m_sorted_storage.assign(m_sorted, m_sorted + m_node_count);
+		graph.m_name_storage.assign(m_names, m_names + m_name_offsets[m_node_count]);
+	}
+	graph.m_node_count = m_node_count;
+	graph.adopt_storage();
+	return graph;
+}
+
+std::vector<CallGraph::NodeId> CallGraph::reachable(const std::vector<NodeId> &roots) const
+{
+	std::vector<bool> visited(m_node_count, false);
+	std::vector<NodeId> result;
+	for ( const NodeId root : roots ) {
+		if ( root < m_node_count && !visited[root] ) {
+			visited[root] = true;
+			result.push_back(root);
+		}
+	}
+
+	for ( std::size_t i{0}; i < result.size(); ++i ) {
+		const auto range = callees(result[i]);
+		for ( const NodeId *callee = range.first; callee != range.second; ++callee ) {
+			if ( !visited[*callee] ) {
+				visited[*callee] = true;
+				result.push_back(*callee);
+			}
+		}
+	}
+	return result;
+}
+
+void CallGraph::save(const std::string &path) const
+{
+	std::ofstream ostream(path, std::ios::binary | std::ios::trunc);
+	if ( !ostream ) {
+		CLANGXX_THROW_RuntimeError("Error opening " + path);
+	}
+
+	static const std::vector<EdgeIndex> empty_offsets(1, 0);
+	static const std::vector<std::uint64_t> empty_name_offsets(1, 0);
+	const EdgeIndex *offsets = m_node_count ? m_offsets : empty_offsets.data();
+	const std::uint64_t *name_offsets = m_node_count ? m_name_offsets : empty_name_offsets.data();
+
+	FileHeader header;
+	std::memcpy(header.magic, file_magic, sizeof(file_magic));
+	header.version = file_version;
+	header.byte_order = byte_order_mark;
+	header.node_count = m_node_count;
+	header.edge_count = edge_count();
+	header.name_bytes = name_offsets[m_node_count];
+
+	const char padding[8] = {};
+	auto write = [&ostream, &padding](const void *data, std::size_t size) {
+		ostream.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+		ostream.write(padding, static_cast<std::streamsize>(align8(size) - size));
+	};
+	write(&header, sizeof(header));
+	write(offsets, (m_node_count + 1) * sizeof(EdgeIndex));
+	write(name_offsets, (m_node_count + 1) * sizeof(std::uint64_t));
+	write(m_targets, header.edge_count * sizeof(NodeId));
+	write(m_sorted, m_node_count * sizeof(NodeId));
+	write(m_names, header.name_bytes);
+	if ( !ostream.flush() ) {
+		CLANGXX_THROW_RuntimeError("Error writing " + path);
+	}
+}
+
+void CallGraph::adopt_storage()
+{
+	m_offsets = m_offset_storage.data();
+	m_targets = m_target_storage.data();
+	m_name_offsets = m_name_offset_storage.data();
+	m_sorted = m_sorted_storage.data();
+	m_names = m_name_storage.data();
+}
+
+} // namespace clangxx
@@ -0,0 +1,272 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ClassHierarchy.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ClassHierarchy.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/CursorMap.hpp"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/SymbolTable.hpp"
+#include "clang-cpp/Trace.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+using clangxx::ClassHierarchy;
+using NodeId	= ClassHierarchy::NodeId;
+using Edge		= ClassHierarchy::Edge;
+
+bool is_class_kind(CXCursorKind kind)
+{
+	switch ( kind ) {
+	  case CXCursor_StructDecl:
+	  case CXCursor_ClassDecl:
+	  case CXCursor_UnionDecl:
+	  case CXCursor_ClassTemplate:
+	  case CXCursor_ClassTemplatePartialSpecialization:
+		return true;
+	  default:
+		return false;
+	}
+}
+
+//! Relations found in one translation unit, with node ids local to it.
+struct LocalHierarchy
+{
+	std::vector<std::string>	usrs;
+	std::vector<Edge>			inheritances;
+	std::vector<Edge>			overrides;
+}; // struct LocalHierarchy
+
+class Extractor
+{
+  private:
+	struct Context
+	{
+		Extractor	*extractor;
+		NodeId		class_node;
+	}; // struct Context
+
+  private:
+	LocalHierarchy				&m_hierarchy;
+	clangxx::CursorMap<NodeId>	m_nodes;
+	clangxx::CursorSet			m_done;
+
+  public:
+	explicit Extractor(LocalHierarchy &hierarchy)
+		: m_hierarchy(hierarchy)
+	{}
+
+  public:
+	void run(CXCursor root) {
+		Context context{this, ClassHierarchy::invalid_node};
+		clang_visitChildren(root, &Extractor::visit, &context);
+	}
+
+  private:
+	static CXChildVisitResult visit(CXCursor cursor, CXCursor /*parent*/, CXClientData client_data) {
+		auto context = static_cast<Context *>(client_data);
+		Extractor &self = *context->extractor;
+
+		switch ( cursor.kind ) {
+		  case CXCursor_Namespace:
+		  case CXCursor_LinkageSpec:
+		  case CXCursor_UnexposedDecl:
+			return CXChildVisit_Recurse;
+
+		  case CXCursor_CXXBaseSpecifier:
+			if ( context->class_node != ClassHierarchy::invalid_node ) {
+				const CXCursor base(clang_getCursorReferenced(cursor));
+				const NodeId base_node{clangxx::is_null(base) ? ClassHierarchy::invalid_node
+															 : self.node(base)};
+				if ( base_node != ClassHierarchy::invalid_node ) {
+					self.m_hierarchy.inheritances.emplace_back(context->class_node, base_node);
+				}
+			}
+			return CXChildVisit_Continue;
+
+		  case CXCursor_CXXMethod:
+			self.add_overrides(cursor);
+			return CXChildVisit_Continue;
+
+		  default:
+			if ( is_class_kind(cursor.kind) && clang_isCursorDefinition(cursor) ) {
+				if ( !self.m_done.insert(clang_getCanonicalCursor(cursor)) ) {
+					return CXChildVisit_Continue;
+				}
+				Context inner{&self, self.node(cursor)};
+				clang_visitChildren(cursor, &Extractor::visit, &inner);
+			}
+			// function bodies are not searched for local classes
+			return CXChildVisit_Continue;
+		}
+	}
+
+	NodeId node(CXCursor cursor) {
+		const CXCursor canonical(clang_getCanonicalCursor(cursor));
+		const auto result = m_nodes.insert(canonical, ClassHierarchy::invalid_node);
+		if ( result.second ) {
+			clangxx::UniqueCXString cx_string(clang_getCursorUSR(canonical));
+			const char *usr = cx_string ? clang_getCString(cx_string.get()) : nullptr;
+			if ( usr && *usr ) {
+				*result.first = static_cast<NodeId>(m_hierarchy.usrs.size());
+				m_hierarchy.usrs.emplace_back(usr);
+			}
+		}
+		return *result.first;
+	}
+
+	void add_overrides(CXCursor method) {
+		if ( !clang_CXXMethod_isVirtual(method)
+			 || !m_done.insert(clang_getCanonicalCursor(method)) )
+		{
+			return;
+		}
+
+		CXCursor *overridden{nullptr};
+		unsigned int num_overridden{0};
+		clang_getOverriddenCursors(method, &overridden, &num_overridden);
+		const clangxx::UniqueCXCursorPtr overridden_ptr(overridden);
+		if ( num_overridden == 0 ) {
+			return;
+		}
+
+		const NodeId method_node{node(method)};
+		if ( method_node == ClassHierarchy::invalid_node ) {
+			return;
+		}
+		for ( unsigned int i{0}; i < num_overridden; ++i ) {
+			const NodeId overridden_node{node(overridden[i])};
+			if ( overridden_node != ClassHierarchy::invalid_node ) {
+				m_hierarchy.overrides.emplace_back(method_node, overridden_node);
+			}
+		}
+	}
+}; // class Extractor
+
+} // namespace
+
+namespace clangxx {
+
+const ClassHierarchy::NodeId	ClassHierarchy::invalid_node;
+
+void ClassHierarchy::Adjacency::assign(std::size_t node_count,
+									   const std::vector<Edge> &edges, bool reverse)
+{
+	offsets.assign(node_count + 1, 0);
+	for ( const auto &edge : edges ) {
+		++offsets[(reverse ? edge.second : edge.first) + 1];
+	}
+	for ( std::size_t i{0}; i < node_count; ++i ) {
+		offsets[i + 1] += offsets[i];
+	}
+
+	std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+	targets.resize(edges.size());
+	for ( const auto &edge : edges ) {
+		const NodeId from{reverse ? edge.second : edge.first};
+		targets[fill[from]++] = reverse ? edge.first : edge.second;
+	}
+}
+
+ClassHierarchy ClassHierarchy::build(
+  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+  unsigned int thread_count/* = 0*/)
+{
+	std::vector<LocalHierarchy> locals(translation_units.size());
+	parallel_for(translation_units.size(), [&](std::size_t index) {
+		trace::Span span("index", "class_hierarchy");
+		if ( span ) {
+			span.set_argument(translation_units[index]->spelling());
+		}
+		Extractor extractor(locals[index]);
+		extractor.run(clang_getTranslationUnitCursor(
+			translation_units[index]->native_handle()));
+	}, thread_count);
+
+	ClassHierarchy hierarchy;
+	for ( auto &local : locals ) {
+		hierarchy.add(local.usrs, local.inheritances, local.overrides);
+		local = LocalHierarchy();
+	}
+	hierarchy.finish();
+	return hierarchy;
+}
+
+ClassHierarchy::ClassHierarchy() = default;
+
+ClassHierarchy::~ClassHierarchy() = default;
+
+ClassHierarchy::ClassHierarchy(const ClassHierarchy &/*other*/) = default;
+ClassHierarchy::ClassHierarchy(ClassHierarchy &&/*other*/) noexcept = default;
+
+ClassHierarchy &ClassHierarchy::operator=(const ClassHierarchy &/*other*/) = default;
+ClassHierarchy &ClassHierarchy::operator=(ClassHierarchy &&/*other*/) noexcept = default;
+
+void ClassHierarchy::merge(const ClassHierarchy &other)
+{
+	add(other.m_symbols.names(), other.m_inheritances, other.m_overrides);
+	finish();
+}
+
+void ClassHierarchy::add(const std::vector<std::string> &usrs,
+						 const std::vector<Edge> &inheritances, const std::vector<Edge> &overrides)
+{
+	std::vector<NodeId> ids; ids.reserve(usrs.size());
+	for ( const auto &usr : usrs ) {
+		ids.push_back(m_symbols.intern(usr));
+	}
+	for ( const auto &edge : inheritances ) {
+		m_inheritances.emplace_back(ids[edge.first], ids[edge.second]);
+	}
+	for ( const auto &edge : overrides ) {
+		m_overrides.emplace_back(ids[edge.first], ids[edge.second]);
+	}
+}
+
+void ClassHierarchy::finish()
+{
+	for ( auto edges : {&m_inheritances, &m_overrides} ) {
+		std::sort(edges->begin(), edges->end());
+		edges->erase(std::unique(edges->begin(), edges->end()), edges->end());
+	}
+
+	const std::size_t count{m_symbols.size()};
+	m_bases.assign(count, m_inheritances, false);
+	m_derived.assign(count, m_inheritances, true);
+	m_overridden.assign(count, m_overrides, false);
+	m_overriders.assign(count, m_overrides, true);
+}
+
+std::vector<ClassHierarchy::NodeId> ClassHierarchy::closure(const Adjacency &adjacency, NodeId node)
+{
+	std::vector<NodeId> result;
+	std::unordered_set<NodeId> seen;
+	std::vector<NodeId> stack{node};
+	while ( !stack.empty() ) {
+		const Range range = adjacency[stack.back()];
+		stack.pop_back();
+		for ( const NodeId *next = range.first; next != range.second; ++next ) {
+			if ( seen.insert(*next).second ) {
+				result.push_back(*next);
+				stack.push_back(*next);
+			}
+		}
+	}
+	return result;
+}
+
+} // namespace clangxx
@@ -0,0 +1,166 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Client.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Client.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "clang-cpp/Exception.hpp"
+#if !defined _WIN32
+	#include <cerrno>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+
+namespace clangxx {
+
+Client::Client(const std::string &socket_path)
+	: m_descriptor(-1)
+	, m_next_request_id(1)
+	, m_mutex()
+{
+#if defined _WIN32
+	CLANGXX_THROW_RuntimeError("Client requires Unix domain sockets.");
+#else
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if ( socket_path.size() >= sizeof(address.sun_path) ) {
+		CLANGXX_THROW_LogicError("Socket path too long: " + socket_path);
+	}
+	std::strcpy(address.sun_path, socket_path.c_str());
+
+	m_descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if ( m_descriptor < 0 ) {
+		CLANGXX_THROW_RuntimeError(std::string("Error creating a socket: ") + std::strerror(errno));
+	}
+	if ( ::connect(m_descriptor, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ) {
+		const int error = errno;
+		::close(m_descriptor);
+		CLANGXX_THROW_RuntimeError("Error connecting to " + socket_path + ": " + std::strerror(error));
+	}
+#endif
+}
+
+Client::~Client()
+{
+#if !defined _WIN32
+	::close(m_descriptor);
+#endif
+}
+
+void Client::parse(const std::string &filename, const std::vector<std::string> &args/* = {}*/,
+				   const protocol::UnsavedContents &unsaved/* = {}*/)
+{
+	protocol::Encoder encoder;
+	encoder.put(filename);
+	encoder.put(args);
+	encoder.put(unsaved);
+	request(protocol::MessageType::Parse, encoder.data());
+}
+
+void Client::reparse(const std::string &filename, const protocol::UnsavedContents &unsaved/* = {}*/)
+{
+	protocol::Encoder encoder;
+	encoder.put(filename);
+	encoder.put(unsaved);
+	request(protocol::MessageType::Reparse, encoder.data());
+}
+
+protocol::CursorInfo Client::cursor_at(const std::string &filename, const std::string &file,
+									   unsigned int line, unsigned int column)
+{
+	protocol::Encoder encoder;
+	encoder.put(filename);
+	encoder.put(file);
+	encoder.put(static_cast<std::uint32_t>(line));
+	encoder.put(static_cast<std::uint32_t>(column));
+	const std::string reply(request(protocol::MessageType::CursorAt, encoder.data()));
+
+	protocol::Decoder decoder(reply.data(), reply.size());
+	protocol::CursorInfo info;
+	info.kind = decoder.get_string();
+	info.spelling = decoder.get_string();
+	info.usr = decoder.get_string();
+	info.location = decoder.get_location();
+	info.referenced_usr = decoder.get_string();
+	info.definition = decoder.get_location();
+	return info;
+}
+
+std::vector<protocol::Location> Client::references(const std::string &filename, const std::string &usr)
+{
+	protocol::Encoder encoder;
+	encoder.put(filename);
+	encoder.put(usr);
+	const std::string reply(request(protocol::MessageType::References, encoder.data()));
+
+	protocol::Decoder decoder(reply.data(), reply.size());
+	std::vector<protocol::Location> locations(decoder.get_u32());
+	for ( auto &location : locations ) {
+		location = decoder.get_location();
+	}
+	return locations;
+}
+
+std::vector<protocol::Completion> Client::complete(const std::string &filename,
+												   unsigned int line, unsigned int column,
+												   const protocol::UnsavedContents &unsaved/* = {}*/)
+{
+	protocol::Encoder encoder;
+	encoder.put(filename);
+	encoder.put(static_cast<std::uint32_t>(line));
+	encoder.put(static_cast<std::uint32_t>(column));
+	encoder.put(unsaved);
+	const std::string reply(request(protocol::MessageType::Complete, encoder.data()));
+
+	protocol::Decoder decoder(reply.data(), reply.size());
+	std::vector<protocol::Completion> completions(decoder.get_u32());
+	for ( auto &completion : completions ) {
+		completion.typed_text = decoder.get_string();
+		completion.text = decoder.get_string();
+		completion.priority = decoder.get_u32();
+	}
+	return completions;
+}
+
+std::string Client::request(protocol::MessageType type, const std::string &payload)
+{
+#if defined _WIN32
+	(void)type;
+	(void)payload;
+	CLANGXX_THROW_RuntimeError("Client requires Unix domain sockets.");
+#else
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const std::uint32_t request_id = m_next_request_id++;
+	protocol::write_frame(m_descriptor, type, request_id, payload);
+
+	protocol::FrameHeader header;
+	std::string reply;
+	if ( !protocol::read_frame(m_descriptor, header, reply) ) {
+		CLANGXX_THROW_RuntimeError("Connection closed by the server.");
+	}
+	if ( header.type != protocol::MessageType::Reply || header.request_id != request_id
+		 || reply.empty() )
+	{
+		CLANGXX_THROW_RuntimeError("Unexpected reply from the server.");
+	}
+
+	const auto status = static_cast<protocol::Status>(reply[0]);
+	reply.erase(0, 1);
+	if ( status != protocol::Status::OK ) {
+		protocol::Decoder decoder(reply.data(), reply.size());
+		CLANGXX_THROW_RuntimeError(decoder.get_string());
+	}
+	return reply;
+#endif
+}
+
+} // namespace clangxx
@@ -0,0 +1,233 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Comment.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Comment.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-c/Documentation.h"
+#include "clang-c/Index.h"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+std::string to_string(CXString cx_string)
+{
+	clangxx::UniqueCXString unique_cx_string(cx_string);
+	if ( !unique_cx_string ) {
+		return std::string();
+	}
+	return clang_getCString(unique_cx_string.get());
+}
+
+bool is_body_kind(CXCursorKind kind)
+{
+	return clang_isStatement(kind) || clang_isExpression(kind);
+}
+
+struct RenderContext
+{
+	std::size_t					index;
+	clangxx::CommentFormat		format;
+	const clangxx::CommentSink	*sink;
+	clangxx::LocationFilter		*filter;
+	std::exception_ptr			exception;
+}; // struct RenderContext
+
+CXChildVisitResult render(CXCursor cursor, CXCursor parent, RenderContext *context)
+{
+	if ( is_body_kind(cursor.kind) || !context->filter->accepts(cursor, parent) ) {
+		return CXChildVisit_Continue;
+	}
+
+	if ( clang_isDeclaration(cursor.kind) ) {
+		const CXComment cx_comment(clang_Cursor_getParsedComment(cursor));
+		if ( clang_Comment_getKind(cx_comment) == CXComment_FullComment ) {
+			clangxx::UniqueCXString cx_string(
+				(context->format == clangxx::CommentFormat::HTML)
+				? clang_FullComment_getAsHTML(cx_comment)
+				: clang_FullComment_getAsXML(cx_comment));
+			const char *data = cx_string ? clang_getCString(cx_string.get()) : nullptr;
+			if ( data && *data ) {
+				(*context->sink)(context->index, data, std::strlen(data));
+			}
+		}
+	}
+	return CXChildVisit_Recurse;
+}
+
+CXChildVisitResult render_visitor(CXCursor cursor, CXCursor parent, CXClientData client_data)
+{
+	const auto context = static_cast<RenderContext *>(client_data);
+	try {
+		return render(cursor, parent, context);
+	}
+	catch ( ... ) {
+		// the sink may throw; never unwind through libclang
+		context->exception = std::current_exception();
+		return CXChildVisit_Break;
+	}
+}
+
+} // namespace
+
+namespace clangxx {
+
+Comment Comment::from_cursor(const Cursor &cursor)
+{
+	return Comment(clang_Cursor_getParsedComment(cursor.native_handle()),
+				   cursor.translation_unit());
+}
+
+Comment::Comment(CXComment cx_comment, std::shared_ptr<const TranslationUnit> translation_unit) noexcept
+	: m_translation_unit(std::move(translation_unit))
+	, m_cx_comment(cx_comment)
+{}
+
+Comment::~Comment() = default;
+
+Comment::Comment(const Comment &/*other*/) = default;
+Comment::Comment(Comment &&/*other*/) noexcept = default;
+
+Comment &Comment::operator=(const Comment &/*other*/) = default;
+Comment &Comment::operator=(Comment &&/*other*/) noexcept = default;
+
+Comment::Children Comment::children() const
+{
+	const Comment self(*this);
+	auto generator = [self](unsigned int index) {
+		return Comment(clang_Comment_getChild(self.m_cx_comment, index),
+					   self.m_translation_unit);
+	};
+	return Children(generator, clang_Comment_getNumChildren(m_cx_comment));
+}
+
+std::string Comment::text() const
+{
+	switch ( kind() ) {
+	  case CXComment_Text:
+		return to_string(clang_TextComment_getText(m_cx_comment));
+	  case CXComment_VerbatimBlockLine:
+		return to_string(clang_VerbatimBlockLineComment_getText(m_cx_comment));
+	  case CXComment_VerbatimLine:
+		return to_string(clang_VerbatimLineComment_getText(m_cx_comment));
+	  default:
+		return std::string();
+	}
+}
+
+std::string Comment::command_name() const
+{
+	switch ( kind() ) {
+	  case CXComment_InlineCommand:
+		return to_string(clang_InlineCommandComment_getCommandName(m_cx_comment));
+	  case CXComment_BlockCommand:
+	  case CXComment_VerbatimBlockCommand:
+	  case CXComment_VerbatimLine:
+		return to_string(clang_BlockCommandComment_getCommandName(m_cx_comment));
+	  default:
+		return std::string();
+	}
+}
+
+Comment::Arguments Comment::arguments() const
+{
+	const CXComment cx_comment(m_cx_comment);
+	if ( kind() == CXComment_InlineCommand ) {
+		auto generator = [cx_comment](unsigned int index) {
+			return to_string(clang_InlineCommandComment_getArgText(cx_comment, index));
+		};
+		return Arguments(generator, clang_InlineCommandComment_getNumArgs(cx_comment));
+	}
+
+	auto generator = [cx_comment](unsigned int index) {
+		return to_string(clang_BlockCommandComment_getArgText(cx_comment, index));
+	};
+	return Arguments(generator, clang_BlockCommandComment_getNumArgs(cx_comment));
+}
+
+Comment Comment::paragraph() const
+{
+	if ( kind() == CXComment_ParamCommand || kind() == CXComment_TParamCommand
+		 || kind() == CXComment_BlockCommand )
+	{
+		return Comment(clang_BlockCommandComment_getParagraph(m_cx_comment), m_translation_unit);
+	}
+	return Comment(CXComment(), m_translation_unit);
+}
+
+std::string Comment::param_name() const
+{
+	switch ( kind() ) {
+	  case CXComment_ParamCommand:
+		return to_string(clang_ParamCommandComment_getParamName(m_cx_comment));
+	  case CXComment_TParamCommand:
+		return to_string(clang_TParamCommandComment_getParamName(m_cx_comment));
+	  default:
+		return std::string();
+	}
+}
+
+std::string Comment::tag_name() const
+{
+	return to_string(clang_HTMLTagComment_getTagName(m_cx_comment));
+}
+
+Comment::Attributes Comment::attributes() const
+{
+	const CXComment cx_comment(m_cx_comment);
+	auto generator = [cx_comment](unsigned int index) {
+		return Attribute(to_string(clang_HTMLStartTag_getAttrName(cx_comment, index)),
+						 to_string(clang_HTMLStartTag_getAttrValue(cx_comment, index)));
+	};
+	return Attributes(generator, (kind() == CXComment_HTMLStartTag)
+					  ? clang_HTMLStartTag_getNumAttrs(cx_comment) : 0);
+}
+
+std::string Comment::str() const
+{
+	return to_string(clang_HTMLTagComment_getAsString(m_cx_comment));
+}
+
+std::string Comment::html() const
+{
+	return to_string(clang_FullComment_getAsHTML(m_cx_comment));
+}
+
+std::string Comment::xml() const
+{
+	return to_string(clang_FullComment_getAsXML(m_cx_comment));
+}
+
+void render_comments(
+  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+  CommentFormat format, const CommentSink &sink,
+  const TraversalOptions &options/* = TraversalOptions()*/,
+  unsigned int thread_count/* = 0*/)
+{
+	parallel_for(translation_units.size(), [&](std::size_t index) {
+		const CXTranslationUnit cx_translation_unit(translation_units[index]->native_handle());
+		LocationFilter filter(options, cx_translation_unit);
+		RenderContext context{index, format, &sink, &filter, nullptr};
+		clang_visitChildren(clang_getTranslationUnitCursor(cx_translation_unit),
+							&render_visitor, &context);
+		if ( context.exception ) {
+			std::rethrow_exception(context.exception);
+		}
+	}, thread_count);
+}
+
+} // namespace clangxx
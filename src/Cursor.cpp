@@ -6,13 +6,18 @@
 */
 #include "clang-cpp/Cursor.hpp"
 
+#include <exception>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 #include "clang-c/Index.h"
+#include "clang-cpp/Comment.hpp"
 #include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Stats.hpp"
+#include "clang-cpp/Trace.hpp"
 #include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
 #include "clang-cpp/UniqueCXObject.hpp"
 
 
@@ -29,8 +34,14 @@ Cursor Cursor::from_result(std::shared_ptr<const TranslationUnit> translation_un
 	return Cursor(std::move(cx_cursor), translation_unit);
 }
 
+Cursor Cursor::from_native_handle(CXCursor cx_cursor,
+								  std::shared_ptr<const TranslationUnit> translation_unit)
+{
+	return Cursor(std::move(cx_cursor), translation_unit);
+}
+
 Cursor::Cursor()
-	: m_cx_cursor()
+	: m_cx_cursor(clang_getNullCursor())
 {}
 
 Cursor::Cursor(CXCursor &&cx_cursor, std::shared_ptr<const TranslationUnit> &translation_unit)
@@ -46,23 +57,19 @@ Cursor::Cursor(Cursor &&/*other*/) noexcept = default;
 Cursor &Cursor::operator=(const Cursor &/*other*/) = default;
 Cursor &Cursor::operator=(Cursor &&/*other*/) /*noexcept*/ = default;
 
-bool Cursor::operator==(const Cursor &other) const
-{
-	return clang_equalCursors(m_cx_cursor, other.m_cx_cursor) == 0;
-}
-
 bool Cursor::is_definition() const
 {
-	return clang_isCursorDefinition(m_cx_cursor) == 0;
+	return clang_isCursorDefinition(m_cx_cursor) != 0;
 }
 
 bool Cursor::is_static_method() const
 {
-	return clang_CXXMethod_isStatic(m_cx_cursor) == 0;
+	return clang_CXXMethod_isStatic(m_cx_cursor) != 0;
 }
 
 Cursor Cursor::get_definition() const
 {
+	CLANGXX_STATS_CALL(Cursor_get_definition);
 	CXCursor cx_cursor(clang_getCursorDefinition(m_cx_cursor));
 	if ( is_null(cx_cursor) ) {
 		if ( is_null(m_cx_cursor) ) {
@@ -76,6 +83,7 @@ Cursor Cursor::get_definition() const
 
 std::string Cursor::get_usr() const
 {
+	CLANGXX_STATS_CALL(Cursor_get_usr);
 	UniqueCXString cx_string(clang_getCursorUSR(m_cx_cursor));
 	if ( !cx_string ) {
 		CLANGXX_THROW_LogicError("Error retrieving a Unified Symbol Resolution (USR) for the entity referenced by this cursor.");
@@ -84,8 +92,22 @@ std::string Cursor::get_usr() const
 	return clang_getCString(cx_string.get());
 }
 
+ArenaString Cursor::get_usr(Arena &arena) const
+{
+	CLANGXX_STATS_CALL(Cursor_get_usr);
+	UniqueCXString cx_string(clang_getCursorUSR(m_cx_cursor));
+	if ( !cx_string ) {
+		CLANGXX_THROW_LogicError("Error retrieving a Unified Symbol Resolution (USR) for the entity referenced by this cursor.");
+	}
+
+	return ArenaString(clang_getCString(cx_string.get()), ArenaAllocator<char>(arena));
+}
+
 std::string Cursor::spelling() const
 {
+	CLANGXX_STATS_CALL(Cursor_spelling);
+	// an empty spelling is not memoized: it is fetched again on every call
+	CLANGXX_STATS_MEMO(Cursor_spelling, !m_spelling.empty());
 	if ( m_spelling.empty() ) {
 		UniqueCXString cx_string(clang_getCursorSpelling(m_cx_cursor));
 		if ( !cx_string ) {
@@ -96,8 +118,25 @@ std::string Cursor::spelling() const
 	return m_spelling;
 }
 
+ArenaString Cursor::spelling(Arena &arena) const
+{
+	CLANGXX_STATS_CALL(Cursor_spelling);
+	CLANGXX_STATS_MEMO(Cursor_spelling, !m_spelling.empty());
+	if ( !m_spelling.empty() ) {
+		return ArenaString(m_spelling.data(), m_spelling.size(), ArenaAllocator<char>(arena));
+	}
+
+	UniqueCXString cx_string(clang_getCursorSpelling(m_cx_cursor));
+	if ( !cx_string ) {
+		CLANGXX_THROW_LogicError("Error retrieving a name for the entity referenced by this cursor.");
+	}
+	return ArenaString(clang_getCString(cx_string.get()), ArenaAllocator<char>(arena));
+}
+
 std::string Cursor::displayname() const
 {
+	CLANGXX_STATS_CALL(Cursor_displayname);
+	CLANGXX_STATS_MEMO(Cursor_displayname, !m_displayname.empty());
 	if ( m_displayname.empty() ) {
 		UniqueCXString cx_string(clang_getCursorDisplayName(m_cx_cursor));
 		if ( !cx_string ) {
@@ -108,8 +147,25 @@ std::string Cursor::displayname() const
 	return m_displayname;
 }
 
+ArenaString Cursor::displayname(Arena &arena) const
+{
+	CLANGXX_STATS_CALL(Cursor_displayname);
+	CLANGXX_STATS_MEMO(Cursor_displayname, !m_displayname.empty());
+	if ( !m_displayname.empty() ) {
+		return ArenaString(m_displayname.data(), m_displayname.size(), ArenaAllocator<char>(arena));
+	}
+
+	UniqueCXString cx_string(clang_getCursorDisplayName(m_cx_cursor));
+	if ( !cx_string ) {
+		CLANGXX_THROW_LogicError("Error retrieving the display name for the entity referenced by this cursor.");
+	}
+	return ArenaString(clang_getCString(cx_string.get()), ArenaAllocator<char>(arena));
+}
+
 Cursor Cursor::canonical() const
 {
+	CLANGXX_STATS_CALL(Cursor_canonical);
+	CLANGXX_STATS_MEMO(Cursor_canonical, static_cast<bool>(m_canonical));
 	if ( !m_canonical ) {
 		CXCursor cx_cursor(clang_getCanonicalCursor(m_cx_cursor));
 		if ( is_null(cx_cursor) ) {
@@ -122,14 +178,19 @@ Cursor Cursor::canonical() const
 
 unsigned int Cursor::hash() const
 {
-	if ( !m_hash ) {
+	CLANGXX_STATS_CALL(Cursor_hash);
+	CLANGXX_STATS_MEMO(Cursor_hash, m_has_hash);
+	if ( !m_has_hash ) {
 		m_hash = clang_hashCursor(m_cx_cursor);
+		m_has_hash = true;
 	}
 	return m_hash;
 }
 
 Cursor Cursor::semantic_parent() const
 {
+	CLANGXX_STATS_CALL(Cursor_semantic_parent);
+	CLANGXX_STATS_MEMO(Cursor_semantic_parent, static_cast<bool>(m_semantic_parent));
 	if ( !m_semantic_parent ) {
 		CXCursor cx_cursor(clang_getCursorSemanticParent(m_cx_cursor));
 		if ( is_null(cx_cursor) ) {
@@ -140,8 +201,28 @@ Cursor Cursor::semantic_parent() const
 	return *m_semantic_parent;
 }
 
+std::string Cursor::qualified_name() const
+{
+	CLANGXX_STATS_CALL(Cursor_qualified_name);
+	if ( !m_translation_unit ) {
+		return std::string();
+	}
+	return m_translation_unit->scope_names().qualified_name(m_cx_cursor);
+}
+
+std::vector<std::string> Cursor::scope_path() const
+{
+	CLANGXX_STATS_CALL(Cursor_scope_path);
+	if ( !m_translation_unit ) {
+		return std::vector<std::string>();
+	}
+	return m_translation_unit->scope_names().scope_path(m_cx_cursor);
+}
+
 Cursor Cursor::lexical_parent() const
 {
+	CLANGXX_STATS_CALL(Cursor_lexical_parent);
+	CLANGXX_STATS_MEMO(Cursor_lexical_parent, static_cast<bool>(m_lexical_parent));
 	if ( !m_lexical_parent ) {
 		CXCursor cx_cursor(clang_getCursorLexicalParent(m_cx_cursor));
 		if ( is_null(cx_cursor) ) {
@@ -154,6 +235,8 @@ Cursor Cursor::lexical_parent() const
 
 Cursor Cursor::referenced() const
 {
+	CLANGXX_STATS_CALL(Cursor_referenced);
+	CLANGXX_STATS_MEMO(Cursor_referenced, static_cast<bool>(m_referenced));
 	if ( !m_referenced ) {
 		CXCursor cx_cursor(clang_getCursorReferenced(m_cx_cursor));
 		if ( is_null(cx_cursor) ) {
@@ -187,6 +270,11 @@ std::string Cursor::raw_comment() const
 	return clang_getCString(cx_string.get());
 }
 
+Comment Cursor::parsed_comment() const
+{
+	return Comment::from_cursor(*this);
+}
+
 Cursor::Arguments Cursor::get_arguments() const
 {
 	auto generator = [this](unsigned int index) {
@@ -211,22 +299,290 @@ Cursor::Arguments Cursor::get_arguments() const
 
 std::vector<Cursor> Cursor::get_children() const
 {
-	auto visitor = [](CXCursor cursor, CXCursor /*parent*/, CXClientData client_data) {
-		if ( is_null(cursor) ) {
-			CLANGXX_THROW_LogicError("cursor is null");
+	struct ClientData
+	{
+		std::vector<Cursor>	&children;
+		const Cursor		&self;
+		std::exception_ptr	exception;
+	};
+
+	auto visitor = [](CXCursor cursor, CXCursor /*parent*/, CXClientData client_data) -> CXChildVisitResult {
+		auto data = static_cast<ClientData *>(client_data);
+		try {
+			if ( is_null(cursor) ) {
+				CLANGXX_THROW_LogicError("cursor is null");
+			}
+			data->children.push_back(Cursor(std::move(cursor), data->self.m_translation_unit));
+			return CXChildVisitResult::CXChildVisit_Continue;
+		}
+		catch ( ... ) {
+			// never unwind through libclang
+			data->exception = std::current_exception();
+			return CXChildVisitResult::CXChildVisit_Break;
 		}
-		auto pair = static_cast<std::pair<std::vector<Cursor> *, Cursor *> *>(client_data);
-		pair->first->push_back(
-		  Cursor(std::move(cursor), pair->second->m_translation_unit));
-		return CXChildVisitResult::CXChildVisit_Continue;
 	};
 
+	CLANGXX_STATS_CALL(Cursor_get_children);
+	trace::Span span("traversal", "get_children");
 	std::vector<Cursor> children;
-	auto client_data = std::make_pair(&children, this);
+	ClientData client_data{children, *this, nullptr};
 	clang_visitChildren(m_cx_cursor, visitor, &client_data);
+	if ( client_data.exception ) {
+		std::rethrow_exception(client_data.exception);
+	}
 	return children;
 }
 
+std::vector<Cursor> Cursor::get_children(const TraversalOptions &options) const
+{
+	std::vector<Cursor> children;
+	visit_children([&children](const Cursor &cursor, const Cursor &/*parent*/) {
+		children.push_back(cursor);
+		return CXChildVisitResult::CXChildVisit_Continue;
+	}, options);
+	return children;
+}
+
+ArenaVector<Cursor> Cursor::get_children(Arena &arena) const
+{
+	struct ClientData
+	{
+		ArenaVector<Cursor>	&children;
+		const Cursor		&self;
+		std::exception_ptr	exception;
+	};
+
+	auto visitor = [](CXCursor cursor, CXCursor /*parent*/, CXClientData client_data) -> CXChildVisitResult {
+		auto data = static_cast<ClientData *>(client_data);
+		try {
+			if ( is_null(cursor) ) {
+				CLANGXX_THROW_LogicError("cursor is null");
+			}
+			data->children.push_back(Cursor(std::move(cursor), data->self.m_translation_unit));
+			return CXChildVisitResult::CXChildVisit_Continue;
+		}
+		catch ( ... ) {
+			// never unwind through libclang
+			data->exception = std::current_exception();
+			return CXChildVisitResult::CXChildVisit_Break;
+		}
+	};
+
+	CLANGXX_STATS_CALL(Cursor_get_children);
+	trace::Span span("traversal", "get_children");
+	ArenaVector<Cursor> children{ArenaAllocator<Cursor>(arena)};
+	ClientData client_data{children, *this, nullptr};
+	clang_visitChildren(m_cx_cursor, visitor, &client_data);
+	if ( client_data.exception ) {
+		std::rethrow_exception(client_data.exception);
+	}
+	return children;
+}
+
+ArenaVector<Cursor> Cursor::get_children(Arena &arena, const TraversalOptions &options) const
+{
+	ArenaVector<Cursor> children{ArenaAllocator<Cursor>(arena)};
+	visit_children([&children](const Cursor &cursor, const Cursor &/*parent*/) {
+		children.push_back(cursor);
+		return CXChildVisitResult::CXChildVisit_Continue;
+	}, options);
+	return children;
+}
+
+void Cursor::visit_children(const Visitor &visitor) const
+{
+	visit_children(visitor, nullptr);
+}
+
+void Cursor::visit_children(const Visitor &visitor, const TraversalOptions &options) const
+{
+	if ( !m_translation_unit ) {
+		return; // a null cursor has no children
+	}
+	LocationFilter filter(options, m_translation_unit->native_handle());
+	visit_children(visitor, &filter);
+}
+
+void Cursor::visit_children(const Visitor &visitor, LocationFilter *filter) const
+{
+	struct ClientData
+	{
+		const Cursor		&self;
+		const Visitor		&visitor;
+		LocationFilter		*filter;
+		std::exception_ptr	exception;
+	};
+
+	auto cx_visitor = [](CXCursor cursor, CXCursor parent, CXClientData client_data) -> CXChildVisitResult {
+		auto data = static_cast<ClientData *>(client_data);
+		try {
+			if ( data->filter && !data->filter->accepts(cursor, parent) ) {
+				return CXChildVisitResult::CXChildVisit_Continue;
+			}
+			return data->visitor(
+			  Cursor(std::move(cursor), data->self.m_translation_unit),
+			  Cursor(std::move(parent), data->self.m_translation_unit));
+		}
+		catch ( ... ) {
+			data->exception = std::current_exception();
+			return CXChildVisitResult::CXChildVisit_Break;
+		}
+	};
+
+	CLANGXX_STATS_CALL(Cursor_visit_children);
+	trace::Span span("traversal", "visit_children");
+	ClientData client_data{*this, visitor, filter, nullptr};
+	clang_visitChildren(m_cx_cursor, cx_visitor, &client_data);
+	if ( client_data.exception ) {
+		std::rethrow_exception(client_data.exception);
+	}
+}
+
+Result<CursorKind> Cursor::try_kind() const noexcept
+{
+	const auto &kinds = CursorKind::get_all_kinds();
+	const auto found = kinds.find(m_cx_cursor.kind);
+	if ( found == kinds.end() ) {
+		return Status::Unknown;
+	}
+	return found->second;
+}
+
+Result<const std::string *> Cursor::try_spelling() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_spelling);
+	CLANGXX_STATS_MEMO(Cursor_spelling, !m_spelling.empty());
+	if ( is_null(m_cx_cursor) ) {
+		return Status::Null;
+	}
+	try {
+		if ( m_spelling.empty() ) {
+			UniqueCXString cx_string(clang_getCursorSpelling(m_cx_cursor));
+			if ( !cx_string ) {
+				return Status::NoString;
+			}
+			m_spelling = clang_getCString(cx_string.get());
+		}
+		return &m_spelling;
+	}
+	catch ( ... ) {
+		return Status::OutOfMemory;
+	}
+}
+
+Result<const std::string *> Cursor::try_displayname() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_displayname);
+	CLANGXX_STATS_MEMO(Cursor_displayname, !m_displayname.empty());
+	if ( is_null(m_cx_cursor) ) {
+		return Status::Null;
+	}
+	try {
+		if ( m_displayname.empty() ) {
+			UniqueCXString cx_string(clang_getCursorDisplayName(m_cx_cursor));
+			if ( !cx_string ) {
+				return Status::NoString;
+			}
+			m_displayname = clang_getCString(cx_string.get());
+		}
+		return &m_displayname;
+	}
+	catch ( ... ) {
+		return Status::OutOfMemory;
+	}
+}
+
+Result<std::string> Cursor::try_get_usr() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_get_usr);
+	if ( is_null(m_cx_cursor) ) {
+		return Status::Null;
+	}
+	UniqueCXString cx_string(clang_getCursorUSR(m_cx_cursor));
+	if ( !cx_string ) {
+		return Status::NoString;
+	}
+	try {
+		return std::string(clang_getCString(cx_string.get()));
+	}
+	catch ( ... ) {
+		return Status::OutOfMemory;
+	}
+}
+
+Result<Cursor> Cursor::try_get_definition() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_get_definition);
+	if ( is_null(m_cx_cursor) ) {
+		return Status::Null;
+	}
+	CXCursor cx_cursor(clang_getCursorDefinition(m_cx_cursor));
+	if ( is_null(cx_cursor) ) {
+		return Status::NotFound;
+	}
+	try {
+		return Cursor(std::move(cx_cursor), m_translation_unit);
+	}
+	catch ( ... ) {
+		return Status::OutOfMemory;
+	}
+}
+
+Result<Cursor> Cursor::try_canonical() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_canonical);
+	CLANGXX_STATS_MEMO(Cursor_canonical, static_cast<bool>(m_canonical));
+	return try_memoized(m_canonical, &clang_getCanonicalCursor, false);
+}
+
+Result<Cursor> Cursor::try_semantic_parent() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_semantic_parent);
+	CLANGXX_STATS_MEMO(Cursor_semantic_parent, static_cast<bool>(m_semantic_parent));
+	return try_memoized(m_semantic_parent, &clang_getCursorSemanticParent, false);
+}
+
+Result<Cursor> Cursor::try_lexical_parent() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_lexical_parent);
+	CLANGXX_STATS_MEMO(Cursor_lexical_parent, static_cast<bool>(m_lexical_parent));
+	return try_memoized(m_lexical_parent, &clang_getCursorLexicalParent, false);
+}
+
+Result<Cursor> Cursor::try_referenced() const noexcept
+{
+	CLANGXX_STATS_CALL(Cursor_referenced);
+	CLANGXX_STATS_MEMO(Cursor_referenced, static_cast<bool>(m_referenced));
+	return try_memoized(m_referenced, &clang_getCursorReferenced, true);
+}
+
+Result<Cursor> Cursor::try_memoized(std::shared_ptr<Cursor> &memo, CXCursor (*cx_function)(CXCursor),
+									bool memoize_null) const noexcept
+{
+	if ( is_null(m_cx_cursor) ) {
+		return Status::Null;
+	}
+	try {
+		if ( !memo ) {
+			CXCursor cx_cursor(cx_function(m_cx_cursor));
+			if ( is_null(cx_cursor) ) {
+				if ( memoize_null ) {
+					memo.reset(new Cursor());
+				}
+				return Status::NotFound;
+			}
+			memo.reset(new Cursor(std::move(cx_cursor), m_translation_unit));
+		}
+		if ( !*memo ) {
+			return Status::NotFound;
+		}
+		return *memo;
+	}
+	catch ( ... ) {
+		return Status::OutOfMemory;
+	}
+}
+
 bool Cursor::is_bitfield() const
 {
 	return clang_Cursor_isBitField(m_cx_cursor) != 0;
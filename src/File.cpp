@@ -13,8 +13,9 @@
 #include <utility>
 #include "clang-c/Index.h"
 #include "clang-cpp/Exception.hpp"
+#include "clang-cpp/FileTable.hpp"
+#include "clang-cpp/Stats.hpp"
 #include "clang-cpp/TranslationUnit.hpp"
-#include "clang-cpp/UniqueCXObject.hpp"
 
 
 namespace clangxx {
@@ -22,17 +23,55 @@ namespace clangxx {
 File File::from_name(std::shared_ptr<const TranslationUnit> translation_unit,
 					 const std::string &file_name)
 {
-	CXFile cx_file(clang_getFile(translation_unit->native_handle(), file_name.c_str()));
-	if ( !cx_file ) {
+	auto &file_table = translation_unit->file_table();
+	const FileTable::Id id{file_table.find(file_name)};
+	if ( id == FileTable::invalid_id ) {
 		CLANGXX_THROW_LogicError("The file was not a part of this translation unit.");
 	}
 
-	return File(std::move(cx_file), translation_unit);
+	const auto entry = file_table.entry(id);
+	CXFile cx_file(entry.cx_file);
+	return File(std::move(cx_file), translation_unit, id, entry.unique_id);
 }
 
-File::File(CXFile &&cx_file, std::shared_ptr<const TranslationUnit> &translation_unit) noexcept
+File File::from_native_handle(CXFile cx_file,
+							  std::shared_ptr<const TranslationUnit> translation_unit)
+{
+	auto &file_table = translation_unit->file_table();
+	const FileTable::Id id{file_table.id_of(cx_file)};
+	const auto entry = file_table.entry(id);
+	return File(std::move(cx_file), translation_unit, id, entry.unique_id);
+}
+
+namespace {
+
+/*!
+  @return false if a reparse cleared the table entry of @a cx_file (the id
+  may then name another file); otherwise copies it to @a entry.
+*/
+bool find_entry(const FileTable &file_table, FileTable::Id id, CXFile cx_file,
+				FileTable::Entry &entry)
+{
+	return file_table.find_entry(id, entry) && entry.cx_file == cx_file;
+}
+
+FileTable::Entry entry_of(const FileTable &file_table, FileTable::Id id, CXFile cx_file)
+{
+	FileTable::Entry entry;
+	if ( !find_entry(file_table, id, cx_file, entry) ) {
+		CLANGXX_THROW_LogicError("The file was invalidated by a reparse.");
+	}
+	return entry;
+}
+
+} // namespace
+
+File::File(CXFile &&cx_file, std::shared_ptr<const TranslationUnit> &translation_unit,
+		   FileTable::Id id, const FileUniqueID &unique_id) noexcept
 	: m_translation_unit(translation_unit)
 	, m_cx_file(std::move(cx_file))
+	, m_id(id)
+	, m_unique_id(unique_id)
 {}
 
 File::~File() = default;
@@ -45,17 +84,54 @@ File &File::operator=(File &&/*other*/) noexcept = default;
 
 std::string File::name() const
 {
-	UniqueCXString cx_string(clang_getFileName(m_cx_file));
-	if ( !cx_string ) {
-		CLANGXX_THROW_LogicError("Error retrieving the complete file and path name of the given file.");
-	}
+	CLANGXX_STATS_CALL(File_name);
+	return entry_of(m_translation_unit->file_table(), m_id, m_cx_file).name;
+}
 
-	return clang_getCString(cx_string.get());
+Result<std::string> File::try_name() const noexcept
+{
+	CLANGXX_STATS_CALL(File_name);
+	if ( !m_translation_unit ) {
+		return Status::Null;
+	}
+	try {
+		FileTable::Entry entry;
+		if ( !find_entry(m_translation_unit->file_table(), m_id, m_cx_file, entry) ) {
+			return Status::Unknown;
+		}
+		return std::move(entry.name);
+	}
+	catch ( ... ) {
+		return Status::OutOfMemory;
+	}
 }
 
 time_t File::time() const
 {
-	return clang_getFileTime(m_cx_file);
+	CLANGXX_STATS_CALL(File_time);
+	return entry_of(m_translation_unit->file_table(), m_id, m_cx_file).time;
+}
+
+bool File::is_multiple_include_guarded() const
+{
+	return entry_of(m_translation_unit->file_table(), m_id, m_cx_file).is_multiple_include_guarded;
+}
+
+Result<bool> File::try_is_multiple_include_guarded() const noexcept
+{
+	if ( !m_translation_unit ) {
+		return Status::Null;
+	}
+	try {
+		FileTable::Entry entry;
+		if ( !find_entry(m_translation_unit->file_table(), m_id, m_cx_file, entry) ) {
+			return Status::Unknown;
+		}
+		return entry.is_multiple_include_guarded;
+	}
+	catch ( ... ) {
+		return Status::OutOfMemory;
+	}
 }
 
 std::string File::repr() const
@@ -0,0 +1,128 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file FileTable.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/FileTable.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <utility>
+#include "clang-c/Index.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace clangxx {
+
+const FileTable::Id	FileTable::invalid_id;
+
+FileTable::FileTable(CXTranslationUnit cx_translation_unit)
+	: m_cx_translation_unit(cx_translation_unit)
+{}
+
+FileTable::~FileTable() = default;
+
+FileTable::Id FileTable::id_of(CXFile cx_file)
+{
+	if ( !cx_file ) {
+		CLANGXX_THROW_LogicError("file is null");
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto iter = m_ids.find(cx_file);
+	if ( iter != m_ids.end() ) {
+		return iter->second;
+	}
+	return insert(cx_file);
+}
+
+FileTable::Id FileTable::find(const std::string &file_name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto iter = m_names.find(file_name);
+	if ( iter != m_names.end() ) {
+		return iter->second;
+	}
+
+	const CXFile cx_file(clang_getFile(m_cx_translation_unit, file_name.c_str()));
+	if ( !cx_file ) {
+		return invalid_id;
+	}
+
+	const auto id_iter = m_ids.find(cx_file);
+	const Id id{(id_iter != m_ids.end()) ? id_iter->second : insert(cx_file)};
+	m_names.emplace(file_name, id);
+	return id;
+}
+
+FileTable::Id FileTable::find(const FileUniqueID &unique_id) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto iter = m_unique_ids.find(unique_id);
+	return (iter != m_unique_ids.end()) ? iter->second : invalid_id;
+}
+
+FileTable::Entry FileTable::entry(Id id) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ( id >= m_entries.size() ) {
+		CLANGXX_THROW_LogicError("Invalid file id.");
+	}
+	return m_entries[id];
+}
+
+bool FileTable::find_entry(Id id, Entry &entry) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ( id >= m_entries.size() ) {
+		return false;
+	}
+	entry = m_entries[id];
+	return true;
+}
+
+std::size_t FileTable::size() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries.size();
+}
+
+void FileTable::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_ids.clear();
+	m_unique_ids.clear();
+	m_names.clear();
+}
+
+FileTable::Id FileTable::insert(CXFile cx_file)
+{
+	Entry entry;
+	entry.cx_file = cx_file;
+
+	CXFileUniqueID cx_file_unique_id;
+	if ( clang_getFileUniqueID(cx_file, &cx_file_unique_id) == 0 ) {
+		entry.unique_id = FileUniqueID(cx_file_unique_id);
+	}
+
+	UniqueCXString cx_string(clang_getFileName(cx_file));
+	if ( !cx_string ) {
+		CLANGXX_THROW_LogicError("Error retrieving the complete file and path name of the given file.");
+	}
+	entry.name = clang_getCString(cx_string.get());
+	entry.time = clang_getFileTime(cx_file);
+	entry.is_multiple_include_guarded =
+		clang_isFileMultipleIncludeGuarded(m_cx_translation_unit, cx_file) != 0;
+
+	const Id id{static_cast<Id>(m_entries.size())};
+	m_entries.push_back(std::move(entry));
+	m_ids.emplace(cx_file, id);
+	m_unique_ids.emplace(m_entries.back().unique_id, id);
+	return id;
+}
+
+} // namespace clangxx
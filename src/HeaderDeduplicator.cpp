@@ -0,0 +1,82 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file HeaderDeduplicator.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/HeaderDeduplicator.hpp"
+
+#include <cstddef>
+#include <mutex>
+#include "clang-c/Index.h"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/FileUniqueID.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+
+
+namespace clangxx {
+
+HeaderDeduplicator::HeaderDeduplicator() = default;
+
+HeaderDeduplicator::~HeaderDeduplicator() = default;
+
+bool HeaderDeduplicator::claim(const FileUniqueID &unique_id)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_processed.insert(unique_id).second;
+}
+
+bool HeaderDeduplicator::is_processed(const FileUniqueID &unique_id) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_processed.count(unique_id) != 0;
+}
+
+std::size_t HeaderDeduplicator::size() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_processed.size();
+}
+
+void HeaderDeduplicator::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_processed.clear();
+}
+
+bool HeaderDeduplicator::should_visit(CXTranslationUnit cx_translation_unit,
+									  CXCursor cx_cursor, FileDecisions &decisions)
+{
+	const CXSourceLocation location(clang_getCursorLocation(cx_cursor));
+	CXFile cx_file{nullptr};
+	clang_getExpansionLocation(location, &cx_file, nullptr, nullptr, nullptr);
+	if ( !cx_file ) {
+		return true;
+	}
+
+	const auto iter = decisions.find(cx_file);
+	if ( iter != decisions.end() ) {
+		return iter->second;
+	}
+
+	bool visit{true};
+	if ( !clang_Location_isFromMainFile(location)
+		 && clang_isFileMultipleIncludeGuarded(cx_translation_unit, cx_file) )
+	{
+		CXFileUniqueID cx_file_unique_id;
+		if ( clang_getFileUniqueID(cx_file, &cx_file_unique_id) == 0 ) {
+			visit = claim(FileUniqueID(cx_file_unique_id));
+		}
+	}
+	decisions.emplace(cx_file, visit);
+	return visit;
+}
+
+void HeaderDeduplicator::visit(const Cursor &cursor, const Cursor::Visitor &visitor)
+{
+	TraversalOptions options;
+	options.header_deduplicator = this;
+	cursor.visit_children(visitor, options);
+}
+
+} // namespace clangxx
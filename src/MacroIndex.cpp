@@ -0,0 +1,174 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file MacroIndex.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/MacroIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/Trace.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+std::string to_string(CXString cx_string)
+{
+	clangxx::UniqueCXString unique_cx_string(cx_string);
+	const char *c_string = unique_cx_string ? clang_getCString(unique_cx_string.get()) : nullptr;
+	return c_string ? c_string : std::string();
+}
+
+//! Site found in one translation unit, before it is merged under the lock.
+struct LocalSite
+{
+	std::string		name;
+	std::string		filename;
+	unsigned int	line;
+	unsigned int	column;
+	unsigned int	offset;
+	bool			is_definition;
+}; // struct LocalSite
+
+CXChildVisitResult collect_visitor(CXCursor cursor, CXCursor /*parent*/, CXClientData client_data)
+{
+	if ( cursor.kind != CXCursor_MacroDefinition && cursor.kind != CXCursor_MacroExpansion ) {
+		return CXChildVisit_Continue;
+	}
+
+	CXFile cx_file = nullptr;
+	unsigned int line = 0, column = 0, offset = 0;
+	clang_getSpellingLocation(clang_getCursorLocation(cursor), &cx_file, &line, &column, &offset);
+	if ( !cx_file ) {
+		// built-in and command line macros
+		return CXChildVisit_Continue;
+	}
+
+	const auto sites = static_cast<std::vector<LocalSite> *>(client_data);
+	sites->push_back(LocalSite{to_string(clang_getCursorSpelling(cursor)),
+							   to_string(clang_getFileName(cx_file)),
+							   line, column, offset,
+							   cursor.kind == CXCursor_MacroDefinition});
+	return CXChildVisit_Continue;
+}
+
+} // namespace
+
+namespace clangxx {
+
+MacroIndex::MacroIndex() = default;
+
+MacroIndex::~MacroIndex() = default;
+
+std::shared_ptr<TranslationUnit> MacroIndex::parse(
+  const std::string &filename, const std::vector<std::string> *args/* = nullptr*/,
+  const std::vector<UnsavedFile> *unsaved_files/* = nullptr*/,
+  CXTranslationUnit_Flags options/* = CXTranslationUnit_None*/,
+  std::shared_ptr<Index> index/* = nullptr*/)
+{
+	auto translation_unit = TranslationUnit::from_source(
+		filename, args, unsaved_files,
+		static_cast<CXTranslationUnit_Flags>(options | CXTranslationUnit_DetailedPreprocessingRecord),
+		index);
+	add(*translation_unit);
+	return translation_unit;
+}
+
+void MacroIndex::add(const TranslationUnit &translation_unit)
+{
+	trace::Span span("index", "macros");
+	if ( span ) {
+		span.set_argument(translation_unit.spelling());
+	}
+	std::vector<LocalSite> sites;
+	clang_visitChildren(clang_getTranslationUnitCursor(translation_unit.native_handle()),
+						&collect_visitor, &sites);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for ( const auto &site : sites ) {
+		const SymbolTable::Id file(m_files.intern(site.filename));
+		if ( !m_seen.insert(SiteKey{file, site.offset, site.is_definition}).second ) {
+			continue;
+		}
+
+		Entry &entry = m_entries[m_names.intern(site.name)];
+		(site.is_definition ? entry.definitions : entry.expansions).push_back(
+			Site{file, site.line, site.column, site.offset});
+	}
+}
+
+void MacroIndex::add(const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+					 unsigned int thread_count/* = 0*/)
+{
+	parallel_for(translation_units.size(), [&](std::size_t index) {
+		add(*translation_units[index]);
+	}, thread_count);
+}
+
+std::vector<MacroIndex::Location> MacroIndex::definitions(const std::string &name) const
+{
+	std::vector<Location> result;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto found = m_entries.find(m_names.find(name));
+	if ( found != m_entries.end() ) {
+		for ( const auto &site : found->second.definitions ) {
+			result.push_back(location(site));
+		}
+	}
+	return result;
+}
+
+std::vector<MacroIndex::Location> MacroIndex::expansions(const std::string &name) const
+{
+	std::vector<Location> result;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto found = m_entries.find(m_names.find(name));
+	if ( found != m_entries.end() ) {
+		for ( const auto &site : found->second.expansions ) {
+			result.push_back(location(site));
+		}
+	}
+	return result;
+}
+
+std::vector<std::string> MacroIndex::names() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_names.names();
+}
+
+std::size_t MacroIndex::size() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_names.size();
+}
+
+void MacroIndex::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_names = SymbolTable();
+	m_files = SymbolTable();
+	m_entries.clear();
+	m_seen.clear();
+}
+
+MacroIndex::Location MacroIndex::location(const Site &site) const
+{
+	Location result;
+	result.filename = m_files.name(site.file);
+	result.line = site.line;
+	result.column = site.column;
+	result.offset = site.offset;
+	return result;
+}
+
+} // namespace clangxx
@@ -0,0 +1,87 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Module.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Module.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include "clang-c/Index.h"
+#include "clang-cpp/Cursor.hpp"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace clangxx {
+
+Module Module::from_file(const File &file)
+{
+	const auto translation_unit = file.translation_unit();
+	return Module(clang_getModuleForFile(translation_unit->native_handle(), file.native_handle()),
+				  translation_unit);
+}
+
+Module Module::from_import(const Cursor &cursor)
+{
+	return Module(clang_Cursor_getModule(cursor.native_handle()), cursor.translation_unit());
+}
+
+Module::Module(CXModule cx_module, std::shared_ptr<const TranslationUnit> translation_unit) noexcept
+	: m_translation_unit(std::move(translation_unit))
+	, m_cx_module(cx_module)
+{}
+
+Module::~Module() = default;
+
+Module::Module(const Module &/*other*/) = default;
+Module::Module(Module &&/*other*/) noexcept = default;
+
+Module &Module::operator=(const Module &/*other*/) = default;
+Module &Module::operator=(Module &&/*other*/) noexcept = default;
+
+File Module::ast_file() const
+{
+	return File::from_native_handle(clang_Module_getASTFile(m_cx_module), m_translation_unit);
+}
+
+Module Module::parent() const
+{
+	return Module(clang_Module_getParent(m_cx_module), m_translation_unit);
+}
+
+std::string Module::name() const
+{
+	UniqueCXString cx_string(clang_Module_getName(m_cx_module));
+	if ( !cx_string ) {
+		CLANGXX_THROW_LogicError("Error retrieving the module name.");
+	}
+	return clang_getCString(cx_string.get());
+}
+
+std::string Module::full_name() const
+{
+	UniqueCXString cx_string(clang_Module_getFullName(m_cx_module));
+	if ( !cx_string ) {
+		CLANGXX_THROW_LogicError("Error retrieving the full module name.");
+	}
+	return clang_getCString(cx_string.get());
+}
+
+Module::Headers Module::top_level_headers() const
+{
+	const Module self(*this);
+	auto generator = [self](unsigned int index) {
+		const CXTranslationUnit cx_translation_unit(self.m_translation_unit->native_handle());
+		return File::from_native_handle(
+			clang_Module_getTopLevelHeader(cx_translation_unit, self.m_cx_module, index),
+			self.m_translation_unit);
+	};
+	return Headers(generator, clang_Module_getNumTopLevelHeaders(
+						m_translation_unit->native_handle(), m_cx_module));
+}
+
+} // namespace clangxx
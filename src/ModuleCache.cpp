@@ -0,0 +1,204 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ModuleCache.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ModuleCache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#if !defined _WIN32
+	#include <dirent.h>
+	#include <sys/stat.h>
+#endif
+
+
+namespace {
+
+struct ModuleFile
+{
+	std::string		path;
+	std::uint64_t	size;
+	std::time_t		used;
+	std::time_t		modified;
+}; // struct ModuleFile
+
+bool has_suffix(const std::string &name, const std::string &suffix)
+{
+	return name.size() >= suffix.size()
+		&& name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+//! @return @a path with symbolic links and relative components resolved, or "" if it does not exist.
+std::string canonical_path(const std::string &path)
+{
+#if defined _WIN32
+	char buffer[_MAX_PATH];
+	return ::_fullpath(buffer, path.c_str(), _MAX_PATH) ? std::string(buffer) : std::string();
+#else
+	char *resolved = ::realpath(path.c_str(), nullptr);
+	if ( !resolved ) {
+		return std::string();
+	}
+	const std::string result(resolved);
+	std::free(resolved);
+	return result;
+#endif
+}
+
+//! Collects the module files under @a directory and its configuration subdirectories.
+void collect(const std::string &directory, std::vector<ModuleFile> &files)
+{
+#if defined _WIN32
+	// not implemented; the directory grows until it is cleaned up externally
+	(void)directory; (void)files;
+#else
+	DIR *dir = ::opendir(directory.c_str());
+	if ( !dir ) {
+		return;
+	}
+
+	while ( const dirent *entry = ::readdir(dir) ) {
+		const std::string name(entry->d_name);
+		if ( name == "." || name == ".." ) {
+			continue;
+		}
+
+		const std::string path(directory + '/' + name);
+		struct stat status;
+		if ( ::lstat(path.c_str(), &status) != 0 ) {
+			continue;
+		}
+		if ( S_ISDIR(status.st_mode) ) {
+			collect(path, files);
+		}
+		else if ( S_ISREG(status.st_mode) && has_suffix(name, ".pcm") ) {
+			files.push_back(ModuleFile{path, static_cast<std::uint64_t>(status.st_size),
+									   std::max(status.st_atime, status.st_mtime),
+									   status.st_mtime});
+		}
+	}
+	::closedir(dir);
+#endif
+}
+
+} // namespace
+
+namespace clangxx {
+
+ModuleCache::ModuleCache(std::string directory, std::uint64_t size_limit/* = 0*/,
+						 unsigned int prune_interval/* = 64*/)
+	: m_directory(std::move(directory))
+	, m_size_limit(size_limit)
+	, m_prune_interval(std::max(prune_interval, 1u))
+{}
+
+ModuleCache::~ModuleCache() = default;
+
+std::vector<std::string> ModuleCache::arguments() const
+{
+	std::vector<std::string> result;
+	result.push_back("-fmodules");
+	result.push_back("-fmodules-cache-path=" + m_directory);
+	return result;
+}
+
+std::vector<std::string> ModuleCache::retain(const std::vector<std::string> &module_files)
+{
+	std::vector<std::string> result;
+	result.reserve(module_files.size());
+	for ( const auto &file : module_files ) {
+		std::string path = canonical_path(file);
+		if ( !path.empty() ) {
+			result.push_back(std::move(path));
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for ( const auto &path : result ) {
+		++m_in_use[path];
+	}
+	return result;
+}
+
+void ModuleCache::release(const std::vector<std::string> &module_files) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for ( const auto &path : module_files ) {
+		const auto found = m_in_use.find(path);
+		if ( found != m_in_use.end() && --found->second == 0 ) {
+			m_in_use.erase(found);
+		}
+	}
+}
+
+void ModuleCache::note_parse()
+{
+	if ( m_size_limit != 0 && ++m_parse_count % m_prune_interval == 0 ) {
+		prune();
+	}
+}
+
+std::uint64_t ModuleCache::size()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<ModuleFile> files;
+	collect(m_directory, files);
+
+	std::uint64_t total = 0;
+	for ( const auto &file : files ) {
+		total += file.size;
+	}
+	return total;
+}
+
+std::uint64_t ModuleCache::prune()
+{
+	if ( m_size_limit == 0 ) {
+		return 0;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<ModuleFile> files;
+	collect(m_directory, files);
+
+	std::uint64_t total = 0;
+	for ( const auto &file : files ) {
+		total += file.size;
+	}
+	if ( total <= m_size_limit ) {
+		return 0;
+	}
+
+	std::sort(files.begin(), files.end(), [](const ModuleFile &lhs, const ModuleFile &rhs) {
+		return lhs.used < rhs.used;
+	});
+
+	const std::time_t recent = std::time(nullptr) - 60;
+	std::uint64_t removed = 0;
+	for ( const auto &file : files ) {
+		if ( total - removed <= m_size_limit ) {
+			break;
+		}
+		if ( file.modified >= recent ) {
+			continue;
+		}
+		if ( !m_in_use.empty() && m_in_use.count(canonical_path(file.path)) != 0 ) {
+			continue;
+		}
+		if ( std::remove(file.path.c_str()) == 0 ) {
+			removed += file.size;
+		}
+	}
+	return removed;
+}
+
+} // namespace clangxx
@@ -0,0 +1,79 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ModuleMap.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ModuleMap.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "clang-c/BuildSystem.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace clangxx {
+
+ModuleMap::ModuleMap()
+	: m_cx_descriptor(clang_ModuleMapDescriptor_create(0))
+{
+	if ( !m_cx_descriptor ) {
+		CLANGXX_THROW_RuntimeError("Error creating a module map descriptor.");
+	}
+}
+
+ModuleMap::~ModuleMap() = default;
+
+ModuleMap::ModuleMap(ModuleMap &&/*other*/) noexcept = default;
+
+ModuleMap &ModuleMap::operator=(ModuleMap &&/*other*/) noexcept = default;
+
+ModuleMap &ModuleMap::set_framework_module_name(const std::string &name)
+{
+	if ( clang_ModuleMapDescriptor_setFrameworkModuleName(m_cx_descriptor.get(), name.c_str())
+		 != CXError_Success )
+	{
+		CLANGXX_THROW_LogicError("Error setting the framework module name.");
+	}
+	return *this;
+}
+
+ModuleMap &ModuleMap::set_umbrella_header(const std::string &name)
+{
+	if ( clang_ModuleMapDescriptor_setUmbrellaHeader(m_cx_descriptor.get(), name.c_str())
+		 != CXError_Success )
+	{
+		CLANGXX_THROW_LogicError("Error setting the umbrella header.");
+	}
+	return *this;
+}
+
+std::string ModuleMap::str() const
+{
+	char *buffer = nullptr;
+	unsigned int size = 0;
+	if ( clang_ModuleMapDescriptor_writeToBuffer(m_cx_descriptor.get(), 0, &buffer, &size)
+		 != CXError_Success )
+	{
+		CLANGXX_THROW_RuntimeError("Error writing a module map.");
+	}
+
+	// allocated with malloc(); this version of libclang has no clang_free()
+	std::unique_ptr<char, void (*)(void *)> holder(buffer, &std::free);
+	return std::string(buffer, size);
+}
+
+void ModuleMap::write(const std::string &path) const
+{
+	const std::string contents(str());
+	std::ofstream ostream(path.c_str(), std::ios::binary);
+	ostream.write(contents.data(), contents.size());
+	if ( !ostream.flush() ) {
+		CLANGXX_THROW_RuntimeError("Error writing " + path + ".");
+	}
+}
+
+} // namespace clangxx
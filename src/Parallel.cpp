@@ -0,0 +1,75 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Parallel.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace clangxx {
+
+void parallel_for(std::size_t count,
+				  const std::function<void(std::size_t index)> &function,
+				  unsigned int thread_count/* = 0*/)
+{
+	if ( thread_count == 0 ) {
+		thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	thread_count = static_cast<unsigned int>(
+		std::min<std::size_t>(thread_count, count));
+
+	std::atomic<std::size_t> next{0};
+	std::atomic<bool> failed{false};
+	std::exception_ptr exception;
+	std::mutex exception_mutex;
+
+	auto worker = [&]() {
+		for ( ;; ) {
+			const std::size_t index{next.fetch_add(1)};
+			if ( index >= count || failed.load(std::memory_order_relaxed) ) {
+				return;
+			}
+			try {
+				function(index);
+			}
+			catch ( ... ) {
+				std::lock_guard<std::mutex> lock(exception_mutex);
+				if ( !exception ) {
+					exception = std::current_exception();
+				}
+				failed = true;
+			}
+		}
+	};
+
+	if ( thread_count <= 1 ) {
+		worker();
+	}
+	else {
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count - 1);
+		for ( unsigned int i{1}; i < thread_count; ++i ) {
+			threads.emplace_back(worker);
+		}
+		worker();
+		for ( auto &thread : threads ) {
+			thread.join();
+		}
+	}
+
+	if ( exception ) {
+		std::rethrow_exception(exception);
+	}
+}
+
+} // namespace clangxx
@@ -0,0 +1,155 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ParseProfile.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ParseProfile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/Exception.hpp"
+
+
+namespace {
+
+std::uint64_t hash_string(const std::string &string) noexcept
+{
+	std::uint64_t hash = UINT64_C(0xcbf29ce484222325);
+	for ( const char c : string ) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= UINT64_C(0x100000001b3);
+	}
+	return hash;
+}
+
+std::uint32_t mix(std::uint64_t value, std::uint64_t seed) noexcept
+{
+	value ^= seed * UINT64_C(0x9e3779b97f4a7c15);
+	value ^= value >> 33;
+	value *= UINT64_C(0xff51afd7ed558ccd);
+	value ^= value >> 33;
+	value *= UINT64_C(0xc4ceb9fe1a85ec53);
+	value ^= value >> 33;
+	return static_cast<std::uint32_t>(value);
+}
+
+} // namespace
+
+namespace clangxx {
+
+const std::size_t	ParseProfile::s_signature_size;
+
+ParseProfile::Signature ParseProfile::signature(const std::vector<std::string> &includes)
+{
+	Signature result;
+	result.fill(std::numeric_limits<std::uint32_t>::max());
+	for ( const auto &include : includes ) {
+		const std::uint64_t hash(hash_string(include));
+		for ( std::size_t i = 0; i < s_signature_size; ++i ) {
+			const std::uint32_t value(mix(hash, i + 1));
+			if ( value < result[i] ) {
+				result[i] = value;
+			}
+		}
+	}
+	return result;
+}
+
+double ParseProfile::similarity(const Signature &lhs, const Signature &rhs) noexcept
+{
+	std::size_t equal = 0;
+	for ( std::size_t i = 0; i < s_signature_size; ++i ) {
+		if ( lhs[i] == rhs[i] ) {
+			++equal;
+		}
+	}
+	return static_cast<double>(equal) / s_signature_size;
+}
+
+ParseProfile::ParseProfile() = default;
+
+ParseProfile::~ParseProfile() = default;
+
+bool ParseProfile::load(const std::string &path)
+{
+	std::ifstream istream(path.c_str());
+	if ( !istream ) {
+		return false;
+	}
+
+	// filename \t seconds \t signature...
+	std::unordered_map<std::string, Entry> entries;
+	std::string line;
+	while ( std::getline(istream, line) ) {
+		const auto tab = line.find('\t');
+		if ( tab == std::string::npos ) {
+			continue;
+		}
+		std::istringstream fields(line.substr(tab + 1));
+		Entry entry;
+		fields >> entry.seconds;
+		for ( auto &value : entry.signature ) {
+			fields >> value;
+		}
+		if ( fields ) {
+			entries[line.substr(0, tab)] = entry;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.swap(entries);
+	return true;
+}
+
+void ParseProfile::save(const std::string &path) const
+{
+	std::ofstream ostream(path.c_str());
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for ( const auto &entry : m_entries ) {
+		ostream << entry.first << '\t' << entry.second.seconds;
+		for ( const auto value : entry.second.signature ) {
+			ostream << ' ' << value;
+		}
+		ostream << '\n';
+	}
+	if ( !ostream.flush() ) {
+		CLANGXX_THROW_RuntimeError("Error writing " + path + ".");
+	}
+}
+
+void ParseProfile::record(const std::string &filename, double seconds,
+						  const std::vector<std::string> &includes)
+{
+	Entry entry;
+	entry.seconds = seconds;
+	entry.signature = signature(includes);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries[filename] = entry;
+}
+
+bool ParseProfile::find(const std::string &filename, Entry &entry) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto found = m_entries.find(filename);
+	if ( found == m_entries.end() ) {
+		return false;
+	}
+	entry = found->second;
+	return true;
+}
+
+std::size_t ParseProfile::size() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries.size();
+}
+
+} // namespace clangxx
@@ -0,0 +1,498 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file PchManager.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/PchManager.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+#if defined _WIN32
+	#include <process.h>
+#else
+	#include <unistd.h>
+#endif
+#include "clang-c/Index.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+const char	s_include_pch[]	= "-include-pch";
+
+std::string trim(const std::string &string)
+{
+	const auto first = string.find_first_not_of(" \t\r\v\f");
+	if ( first == std::string::npos ) {
+		return std::string();
+	}
+	const auto last = string.find_last_not_of(" \t\r\v\f");
+	return string.substr(first, last - first + 1);
+}
+
+//! Removes comments from @a line; @a in_comment carries a block comment across lines.
+std::string strip_comments(const std::string &line, bool &in_comment)
+{
+	std::string result;
+	for ( std::size_t i = 0; i < line.size(); ++i ) {
+		if ( in_comment ) {
+			if ( line.compare(i, 2, "*/") == 0 ) {
+				in_comment = false;
+				++i;
+			}
+		}
+		else if ( line.compare(i, 2, "//") == 0 ) {
+			break;
+		}
+		else if ( line.compare(i, 2, "/*") == 0 ) {
+			in_comment = true;
+			result += ' ';
+			++i;
+		}
+		else {
+			result += line[i];
+		}
+	}
+	return result;
+}
+
+std::string header_language(const std::string &filename)
+{
+	const auto dot = filename.rfind('.');
+	const std::string extension((dot == std::string::npos) ? std::string() : filename.substr(dot));
+	if ( extension == ".c" ) {
+		return "c-header";
+	}
+	if ( extension == ".m" ) {
+		return "objective-c-header";
+	}
+	if ( extension == ".mm" ) {
+		return "objective-c++-header";
+	}
+	return "c++-header";
+}
+
+std::string directory_of(const std::string &filename)
+{
+	const auto slash = filename.find_last_of("/\\");
+	return (slash == std::string::npos) ? std::string(".") : filename.substr(0, slash);
+}
+
+std::string hash_name(const std::string &key)
+{
+	std::uint64_t hash = UINT64_C(0xcbf29ce484222325);
+	for ( const char c : key ) {
+		hash ^= static_cast<unsigned char>(c);
+		hash *= UINT64_C(0x100000001b3);
+	}
+
+	static const char digits[] = "0123456789abcdef";
+	std::string result(16, '0');
+	for ( int i = 15; i >= 0; --i, hash >>= 4 ) {
+		result[i] = digits[hash & 0xf];
+	}
+	return result;
+}
+
+//! @a time is in nanoseconds, or whole seconds scaled up where stat() has no finer field.
+bool modification_time(const std::string &path, std::int64_t &time)
+{
+	struct stat status;
+	if ( ::stat(path.c_str(), &status) != 0 ) {
+		return false;
+	}
+#if defined __APPLE__
+	time = static_cast<std::int64_t>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#elif defined _WIN32
+	time = static_cast<std::int64_t>(status.st_mtime) * 1000000000;
+#else
+	time = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+	return true;
+}
+
+//! @return @a path with a suffix unique to this process, to write before renaming into place.
+std::string temporary_path(const std::string &path)
+{
+#if defined _WIN32
+	return path + ".tmp" + std::to_string(::_getpid());
+#else
+	return path + ".tmp" + std::to_string(::getpid());
+#endif
+}
+
+//! Renames @a from to @a to, replacing it.
+void replace_file(const std::string &from, const std::string &to)
+{
+#if defined _WIN32
+	std::remove(to.c_str());
+#endif
+	if ( std::rename(from.c_str(), to.c_str()) != 0 ) {
+		std::remove(from.c_str());
+		CLANGXX_THROW_RuntimeError("Error renaming " + from + " to " + to + ".");
+	}
+}
+
+struct InclusionContext
+{
+	CXTranslationUnit			translation_unit;
+	std::vector<std::string>	files;
+	//! line of the first #include of the generated header naming an unguarded file; 0 if none.
+	unsigned int				unguarded_line;
+	std::exception_ptr			exception;
+}; // struct InclusionContext
+
+void collect_inclusion(CXFile included_file, CXSourceLocation *inclusion_stack,
+					   unsigned int include_len, CXClientData client_data)
+{
+	const auto context = static_cast<InclusionContext *>(client_data);
+	try {
+		clangxx::UniqueCXString name(clang_getFileName(included_file));
+		if ( name && clang_getCString(name.get()) ) {
+			context->files.push_back(clang_getCString(name.get()));
+		}
+	}
+	catch ( ... ) {
+		context->exception = std::current_exception();
+	}
+
+	if ( include_len == 1
+		 && !clang_isFileMultipleIncludeGuarded(context->translation_unit, included_file) )
+	{
+		unsigned int line = 0;
+		clang_getSpellingLocation(inclusion_stack[0], nullptr, &line, nullptr, nullptr);
+		if ( line && (!context->unguarded_line || line < context->unguarded_line) ) {
+			context->unguarded_line = line;
+		}
+	}
+}
+
+//! Jobs sharing arguments and a non-empty prefix of their leading includes.
+struct Group
+{
+	std::string					key;
+	std::vector<std::string>	includes;
+	std::vector<std::string>	args;
+	std::string					language;
+	std::string					quote_directory;
+	std::vector<std::size_t>	jobs;
+	std::string					pch;
+}; // struct Group
+
+} // namespace
+
+namespace clangxx {
+
+PchManager::PchManager(std::string directory, std::size_t min_group_size/* = 2*/)
+	: m_directory(std::move(directory))
+	, m_min_group_size(std::max<std::size_t>(min_group_size, 1))
+{}
+
+PchManager::~PchManager() = default;
+
+std::vector<std::string> PchManager::leading_includes(const std::string &filename)
+{
+	std::vector<std::string> result;
+	std::ifstream istream(filename.c_str());
+	std::string line;
+	bool in_comment = false;
+	while ( std::getline(istream, line) ) {
+		const std::string code(trim(strip_comments(line, in_comment)));
+		if ( code.empty() ) {
+			continue;
+		}
+		if ( code[0] != '#' ) {
+			break;
+		}
+
+		const std::string directive(trim(code.substr(1)));
+		if ( directive.compare(0, 7, "include") == 0 ) {
+			const std::string header(trim(directive.substr(7)));
+			if ( header.empty() || (header[0] != '"' && header[0] != '<') ) {
+				// a macro include cannot be hoisted
+				break;
+			}
+			result.push_back(header);
+		}
+		else if ( directive.compare(0, 6, "pragma") == 0 && trim(directive.substr(6)) == "once" ) {
+			continue;
+		}
+		else {
+			break;
+		}
+	}
+	return result;
+}
+
+void PchManager::prepare(std::vector<ParseJob> &jobs, std::shared_ptr<Index> index,
+						 unsigned int thread_count/* = 0*/)
+{
+	std::vector<std::vector<std::string>> includes(jobs.size());
+	parallel_for(jobs.size(), [&](std::size_t i) {
+		includes[i] = leading_includes(jobs[i].filename);
+	}, thread_count);
+
+	// jobs can share a PCH only if they are parsed with the same arguments;
+	// quoted includes are also resolved relative to the source directory
+	std::unordered_map<std::string, std::vector<std::size_t>> by_args;
+	for ( std::size_t i = 0; i < jobs.size(); ++i ) {
+		if ( includes[i].empty() ) {
+			continue;
+		}
+		std::string key(header_language(jobs[i].filename));
+		for ( const auto &arg : jobs[i].args ) {
+			key += '\0';
+			key += arg;
+		}
+		for ( const auto &include : includes[i] ) {
+			if ( include[0] == '"' ) {
+				key += '\0';
+				key += directory_of(jobs[i].filename);
+				break;
+			}
+		}
+		by_args[key].push_back(i);
+	}
+
+	std::vector<Group> groups;
+	for ( auto &candidates : by_args ) {
+		auto &members = candidates.second;
+		std::sort(members.begin(), members.end(), [&](std::size_t lhs, std::size_t rhs) {
+			return includes[lhs] < includes[rhs];
+		});
+
+		auto flush = [&](Group &group) {
+			if ( group.jobs.size() >= m_min_group_size && !group.includes.empty() ) {
+				const ParseJob &first = jobs[group.jobs.front()];
+				group.args = first.args;
+				group.language = header_language(first.filename);
+				for ( const auto &include : group.includes ) {
+					if ( include[0] == '"' ) {
+						group.quote_directory = directory_of(first.filename);
+						break;
+					}
+				}
+				group.key = candidates.first;
+				for ( const auto &include : group.includes ) {
+					group.key += '\0';
+					group.key += include;
+				}
+				groups.push_back(std::move(group));
+			}
+			group = Group();
+		};
+
+		// sorted neighbours share the longest prefixes; a job joins the
+		// current group unless that would halve the shared prefix
+		Group group;
+		for ( const std::size_t member : members ) {
+			const auto &member_includes = includes[member];
+			if ( !group.jobs.empty() ) {
+				std::size_t common = 0;
+				while ( common < group.includes.size() && common < member_includes.size()
+						&& group.includes[common] == member_includes[common] )
+				{
+					++common;
+				}
+				if ( common > 0 && common * 2 >= group.includes.size() ) {
+					group.includes.resize(common);
+					group.jobs.push_back(member);
+					continue;
+				}
+				flush(group);
+			}
+			group.includes = member_includes;
+			group.jobs.push_back(member);
+		}
+		flush(group);
+	}
+
+	parallel_for(groups.size(), [&](std::size_t i) {
+		Group &group = groups[i];
+		std::vector<std::string> args(group.args);
+		if ( !group.quote_directory.empty() ) {
+			args.push_back("-iquote");
+			args.push_back(group.quote_directory);
+		}
+		try {
+			group.pch = build(group.key, group.includes, args, group.language, index);
+		}
+		catch ( const Exception & ) {
+			// the jobs of this group are parsed without a PCH
+		}
+	}, thread_count);
+
+	for ( const auto &group : groups ) {
+		if ( group.pch.empty() ) {
+			continue;
+		}
+		for ( const std::size_t job : group.jobs ) {
+			auto &args = jobs[job].args;
+			if ( !group.quote_directory.empty() ) {
+				args.push_back("-iquote");
+				args.push_back(group.quote_directory);
+			}
+			args.push_back(s_include_pch);
+			args.push_back(group.pch);
+		}
+	}
+}
+
+void PchManager::invalidate()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for ( const auto &pch : m_pchs ) {
+		std::remove(pch.second.path.c_str());
+		std::remove((pch.second.path + ".deps").c_str());
+	}
+	m_pchs.clear();
+}
+
+std::string PchManager::build(const std::string &key, const std::vector<std::string> &includes,
+							  const std::vector<std::string> &args, const std::string &language,
+							  std::shared_ptr<Index> &index)
+{
+	const std::string base(m_directory + "/pch-" + hash_name(key));
+	const std::string header(base + ".h");
+	const std::string path(base + ".pch");
+	const std::string deps_path(path + ".deps");
+
+	{
+		// wait for a concurrent build of the same PCH, then reuse it
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_built.wait(lock, [&] { return m_building.count(key) == 0; });
+		auto found = m_pchs.find(key);
+		if ( found == m_pchs.end() ) {
+			// reuse a PCH built by an earlier run
+			Pch pch{path, {}};
+			std::ifstream deps(deps_path.c_str());
+			std::string dependency;
+			while ( std::getline(deps, dependency) ) {
+				pch.dependencies.push_back(dependency);
+			}
+			if ( !pch.dependencies.empty() ) {
+				found = m_pchs.insert(std::make_pair(key, std::move(pch))).first;
+			}
+		}
+		if ( found != m_pchs.end() ) {
+			if ( is_up_to_date(found->second) ) {
+				return found->second.path;
+			}
+			m_pchs.erase(found);
+		}
+		m_building.insert(key);
+	}
+	struct Building
+	{
+		PchManager	&manager;
+		const std::string	&key;
+
+		~Building() {
+			{
+				std::lock_guard<std::mutex> lock(manager.m_mutex);
+				manager.m_building.erase(key);
+			}
+			manager.m_built.notify_all();
+		}
+	} building{*this, key};
+
+	std::vector<std::string> build_args(args);
+	build_args.push_back("-x");
+	build_args.push_back(language);
+
+	// the sources still include the hoisted headers, so a header without
+	// include guards or #pragma once would be included twice: end the
+	// prefix before the first one and parse again
+	std::size_t count = includes.size();
+	std::shared_ptr<TranslationUnit> translation_unit;
+	InclusionContext context{nullptr, {}, 0, nullptr};
+	for ( ;; ) {
+		{
+			const std::string temporary(temporary_path(header));
+			{
+				std::ofstream ostream(temporary.c_str());
+				for ( std::size_t i = 0; i < count; ++i ) {
+					ostream << "#include " << includes[i] << '\n';
+				}
+				if ( !ostream.flush() ) {
+					CLANGXX_THROW_RuntimeError("Error writing " + temporary + ".");
+				}
+			}
+			replace_file(temporary, header);
+		}
+
+		translation_unit = TranslationUnit::from_source(
+			header, &build_args, nullptr,
+			static_cast<CXTranslationUnit_Flags>(CXTranslationUnit_Incomplete
+												 | CXTranslationUnit_ForSerialization),
+			index);
+		context = InclusionContext{translation_unit->native_handle(), {}, 0, nullptr};
+		clang_getInclusions(translation_unit->native_handle(), &collect_inclusion, &context);
+		if ( context.exception ) {
+			std::rethrow_exception(context.exception);
+		}
+		if ( !context.unguarded_line || context.unguarded_line > count ) {
+			break;
+		}
+		count = context.unguarded_line - 1;
+		if ( count == 0 ) {
+			CLANGXX_THROW_RuntimeError("The leading include of " + header + " has no include guard.");
+		}
+	}
+	const std::string temporary(temporary_path(path));
+	translation_unit->save(temporary);
+	replace_file(temporary, path);
+
+	Pch pch{path, std::move(context.files)};
+	{
+		const std::string temporary_deps(temporary_path(deps_path));
+		{
+			std::ofstream deps(temporary_deps.c_str());
+			for ( const auto &dependency : pch.dependencies ) {
+				deps << dependency << '\n';
+			}
+		}
+		replace_file(temporary_deps, deps_path);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pchs[key] = std::move(pch);
+	return path;
+}
+
+bool PchManager::is_up_to_date(const Pch &pch) const
+{
+	std::int64_t built;
+	if ( !modification_time(pch.path, built) ) {
+		return false;
+	}
+	for ( const auto &dependency : pch.dependencies ) {
+		// equal times are ambiguous on filesystems with coarse timestamps
+		std::int64_t modified;
+		if ( !modification_time(dependency, modified) || modified >= built ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace clangxx
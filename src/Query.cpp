@@ -0,0 +1,577 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Query.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Query.hpp"
+
+#include <bitset>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Parallel.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+using KindSet	= std::bitset<CXCursor_LastExtraDecl + 1>;
+
+enum Flag: std::uint32_t
+{
+	Flag_Definition	= 1u << 0,
+	Flag_Static		= 1u << 1,
+	Flag_Virtual	= 1u << 2,
+	Flag_Pure		= 1u << 3,
+	Flag_Const		= 1u << 4,
+	Flag_BitField	= 1u << 5,
+	Flag_Variadic	= 1u << 6,
+	Flag_Public		= 1u << 7,
+	Flag_Protected	= 1u << 8,
+	Flag_Private	= 1u << 9,
+};
+
+const std::pair<const char *, Flag>	flag_names[] = {
+	{"definition", Flag_Definition},
+	{"static", Flag_Static},
+	{"virtual", Flag_Virtual},
+	{"pure", Flag_Pure},
+	{"const", Flag_Const},
+	{"bitfield", Flag_BitField},
+	{"variadic", Flag_Variadic},
+	{"public", Flag_Public},
+	{"protected", Flag_Protected},
+	{"private", Flag_Private},
+};
+
+enum class Field
+{
+	Name,
+	DisplayName,
+	USR,
+};
+
+enum class Operator
+{
+	Equal,
+	Prefix,
+	Suffix,
+	Contains,
+};
+
+struct StringPredicate
+{
+	Field		field;
+	Operator	op;
+	std::string	value;
+
+	bool test(const std::string &text) const {
+		switch ( op ) {
+		  case Operator::Equal:
+			return text == value;
+		  case Operator::Prefix:
+			return text.compare(0, value.size(), value) == 0;
+		  case Operator::Suffix:
+			return text.size() >= value.size()
+				&& text.compare(text.size() - value.size(), value.size(), value) == 0;
+		  case Operator::Contains:
+			return text.find(value) != std::string::npos;
+		}
+		return false;
+	}
+}; // struct StringPredicate
+
+struct Step
+{
+	KindSet							kinds;
+	std::uint32_t					flags{0};
+	std::vector<StringPredicate>	strings;
+	//! combinator between the previous step and this one
+	bool							is_child{false};
+}; // struct Step
+
+std::string normalize_kind_name(const std::string &name)
+{
+	std::string normalized;
+	for ( const char c : name ) {
+		const auto ic = std::string::traits_type::to_int_type(c);
+		if ( std::isalnum(ic) ) {
+			normalized += std::string::traits_type::to_char_type(std::tolower(ic));
+		}
+	}
+	return normalized;
+}
+
+const std::unordered_map<std::string, CXCursorKind> &kind_names()
+{
+	static const std::unordered_map<std::string, CXCursorKind> names = [] {
+		const std::pair<int, int> ranges[] = {
+			{CXCursor_FirstDecl, CXCursor_LastDecl},
+			{CXCursor_FirstRef, CXCursor_LastRef},
+			{CXCursor_FirstInvalid, CXCursor_LastInvalid},
+			{CXCursor_FirstExpr, CXCursor_LastExpr},
+			{CXCursor_FirstStmt, CXCursor_LastStmt},
+			{CXCursor_TranslationUnit, CXCursor_TranslationUnit},
+			{CXCursor_FirstAttr, CXCursor_LastAttr},
+			{CXCursor_FirstPreprocessing, CXCursor_LastPreprocessing},
+			{CXCursor_FirstExtraDecl, CXCursor_LastExtraDecl},
+		};
+		std::unordered_map<std::string, CXCursorKind> names;
+		for ( const auto &range : ranges ) {
+			for ( int value{range.first}; value <= range.second; ++value ) {
+				const auto kind = static_cast<CXCursorKind>(value);
+				clangxx::UniqueCXString cx_string(clang_getCursorKindSpelling(kind));
+				if ( cx_string ) {
+					names.emplace(normalize_kind_name(clang_getCString(cx_string.get())), kind);
+				}
+			}
+		}
+		// spellings differ from the enumerators for these
+		names["macroinstantiation"] = CXCursor_MacroExpansion;
+		names["macroexpansion"] = CXCursor_MacroExpansion;
+		names["macrodefinition"] = CXCursor_MacroDefinition;
+		names["inclusiondirective"] = CXCursor_InclusionDirective;
+		return names;
+	}();
+	return names;
+}
+
+bool is_body_kind(int kind)
+{
+	return (kind >= CXCursor_FirstExpr && kind <= CXCursor_LastExpr)
+		|| (kind >= CXCursor_FirstStmt && kind <= CXCursor_LastStmt);
+}
+
+class Parser
+{
+  private:
+	const std::string	&m_text;
+	std::size_t			m_pos{0};
+
+  public:
+	explicit Parser(const std::string &text)
+		: m_text(text)
+	{}
+
+  public:
+	std::vector<Step> parse() {
+		std::vector<Step> steps;
+		skip_spaces();
+		while ( m_pos < m_text.size() ) {
+			Step step;
+			if ( !steps.empty() ) {
+				step.is_child = accept('>');
+				skip_spaces();
+			}
+			parse_step(step);
+			steps.push_back(std::move(step));
+			skip_spaces();
+		}
+		if ( steps.empty() ) {
+			fail("empty selector");
+		}
+		if ( steps.size() > 64 ) {
+			fail("too many steps");
+		}
+		return steps;
+	}
+
+  private:
+	void parse_step(Step &step) {
+		if ( accept('*') ) {
+			step.kinds.set();
+		}
+		else {
+			const std::string name(identifier());
+			const auto &names = kind_names();
+			const auto iter = names.find(normalize_kind_name(name));
+			if ( iter == names.end() ) {
+				fail("unknown cursor kind '" + name + "'");
+			}
+			step.kinds.set(iter->second);
+		}
+
+		while ( accept('[') ) {
+			skip_spaces();
+			const std::string name(identifier());
+			skip_spaces();
+			if ( accept(']') ) {
+				step.flags |= flag(name);
+				continue;
+			}
+
+			StringPredicate predicate;
+			predicate.field = field(name);
+			predicate.op = (accept('^') ? Operator::Prefix
+							: accept('$') ? Operator::Suffix
+							: accept('*') ? Operator::Contains
+							: Operator::Equal);
+			expect('=');
+			skip_spaces();
+			predicate.value = value();
+			skip_spaces();
+			expect(']');
+			step.strings.push_back(std::move(predicate));
+		}
+	}
+
+	std::uint32_t flag(const std::string &name) {
+		for ( const auto &flag_name : flag_names ) {
+			if ( name == flag_name.first ) {
+				return flag_name.second;
+			}
+		}
+		fail("unknown attribute '" + name + "'");
+		return 0;
+	}
+
+	Field field(const std::string &name) {
+		if ( name == "name" || name == "spelling" ) {
+			return Field::Name;
+		}
+		if ( name == "displayname" ) {
+			return Field::DisplayName;
+		}
+		if ( name == "usr" ) {
+			return Field::USR;
+		}
+		fail("unknown attribute '" + name + "'");
+		return Field::Name;
+	}
+
+	std::string identifier() {
+		const std::size_t begin{m_pos};
+		while ( m_pos < m_text.size()
+				&& (std::isalnum(std::string::traits_type::to_int_type(m_text[m_pos]))
+					|| m_text[m_pos] == '_') )
+		{
+			++m_pos;
+		}
+		if ( begin == m_pos ) {
+			fail("identifier expected");
+		}
+		return m_text.substr(begin, m_pos - begin);
+	}
+
+	std::string value() {
+		if ( m_pos < m_text.size() && (m_text[m_pos] == '"' || m_text[m_pos] == '\'') ) {
+			const char quote{m_text[m_pos++]};
+			const std::size_t end{m_text.find(quote, m_pos)};
+			if ( end == std::string::npos ) {
+				fail("unterminated string");
+			}
+			std::string text(m_text.substr(m_pos, end - m_pos));
+			m_pos = end + 1;
+			return text;
+		}
+		const std::size_t begin{m_pos};
+		while ( m_pos < m_text.size() && m_text[m_pos] != ']'
+				&& !std::isspace(std::string::traits_type::to_int_type(m_text[m_pos])) )
+		{
+			++m_pos;
+		}
+		return m_text.substr(begin, m_pos - begin);
+	}
+
+	void skip_spaces() {
+		while ( m_pos < m_text.size()
+				&& std::isspace(std::string::traits_type::to_int_type(m_text[m_pos])) )
+		{
+			++m_pos;
+		}
+	}
+
+	bool accept(char c) {
+		if ( m_pos < m_text.size() && m_text[m_pos] == c ) {
+			++m_pos;
+			return true;
+		}
+		return false;
+	}
+
+	void expect(char c) {
+		if ( !accept(c) ) {
+			fail(std::string("'") + c + "' expected");
+		}
+	}
+
+	[[noreturn]] void fail(const std::string &message) const {
+		std::ostringstream ostream;
+		ostream << "Invalid selector \"" << m_text << "\" at " << m_pos << ": " << message;
+		CLANGXX_THROW_QuerySyntaxError(ostream.str());
+	}
+}; // class Parser
+
+//! Lazily computed properties of the cursor being matched.
+class Node
+{
+  private:
+	CXCursor	m_cx_cursor;
+	std::string	m_strings[3];
+	bool		m_has_string[3]{false, false, false};
+
+  public:
+	explicit Node(CXCursor cx_cursor) noexcept
+		: m_cx_cursor(cx_cursor)
+	{}
+
+  public:
+	bool has_flags(std::uint32_t flags) const {
+		if ( (flags & Flag_Definition) && !clang_isCursorDefinition(m_cx_cursor) ) {
+			return false;
+		}
+		if ( (flags & Flag_Static) && !clang_CXXMethod_isStatic(m_cx_cursor) ) {
+			return false;
+		}
+		if ( (flags & Flag_Virtual) && !clang_CXXMethod_isVirtual(m_cx_cursor) ) {
+			return false;
+		}
+		if ( (flags & Flag_Pure) && !clang_CXXMethod_isPureVirtual(m_cx_cursor) ) {
+			return false;
+		}
+		if ( (flags & Flag_Const) && !clang_CXXMethod_isConst(m_cx_cursor) ) {
+			return false;
+		}
+		if ( (flags & Flag_BitField) && !clang_Cursor_isBitField(m_cx_cursor) ) {
+			return false;
+		}
+		if ( (flags & Flag_Variadic) && !clang_Cursor_isVariadic(m_cx_cursor) ) {
+			return false;
+		}
+		if ( flags & (Flag_Public | Flag_Protected | Flag_Private) ) {
+			const CX_CXXAccessSpecifier access(clang_getCXXAccessSpecifier(m_cx_cursor));
+			if ( ((flags & Flag_Public) && access != CX_CXXPublic)
+				 || ((flags & Flag_Protected) && access != CX_CXXProtected)
+				 || ((flags & Flag_Private) && access != CX_CXXPrivate) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const std::string &string(Field field) {
+		const auto index = static_cast<std::size_t>(field);
+		if ( !m_has_string[index] ) {
+			clangxx::UniqueCXString cx_string(
+				(field == Field::Name) ? clang_getCursorSpelling(m_cx_cursor)
+				: (field == Field::DisplayName) ? clang_getCursorDisplayName(m_cx_cursor)
+				: clang_getCursorUSR(m_cx_cursor));
+			if ( cx_string ) {
+				m_strings[index] = clang_getCString(cx_string.get());
+			}
+			m_has_string[index] = true;
+		}
+		return m_strings[index];
+	}
+}; // class Node
+
+} // namespace
+
+namespace clangxx {
+
+class Query::Plan
+{
+  private:
+	struct Context
+	{
+		const Plan								*plan;
+		std::uint64_t							active;
+		const std::function<void(CXCursor)>		*callback;
+		//! shared by the nested contexts of one run()
+		std::exception_ptr						*exception;
+	}; // struct Context
+
+  private:
+	std::string			m_selector;
+	std::vector<Step>	m_steps;
+	//! steps that stay active below their parent's match (descendant combinator)
+	std::uint64_t		m_persistent{0};
+	//! kinds of subtrees worth descending into
+	KindSet				m_descend;
+
+  public:
+	explicit Plan(const std::string &selector)
+		: m_selector(selector)
+		, m_steps(Parser(selector).parse())
+	{
+		KindSet targets;
+		for ( std::size_t i{0}; i < m_steps.size(); ++i ) {
+			if ( (i == 0) || !m_steps[i].is_child ) {
+				m_persistent |= std::uint64_t(1) << i;
+			}
+			targets |= m_steps[i].kinds;
+		}
+
+		m_descend.set();
+		bool needs_bodies{false};
+		for ( int kind{0}; kind < static_cast<int>(targets.size()); ++kind ) {
+			if ( targets[kind] && is_body_kind(kind) ) {
+				needs_bodies = true;
+				break;
+			}
+		}
+		if ( !needs_bodies ) {
+			for ( int kind{CXCursor_FirstExpr}; kind <= CXCursor_LastExpr; ++kind ) {
+				m_descend.reset(kind);
+			}
+			for ( int kind{CXCursor_FirstStmt}; kind <= CXCursor_LastStmt; ++kind ) {
+				m_descend.reset(kind);
+			}
+		}
+	}
+
+  public:
+	const std::string &selector() const noexcept {
+		return m_selector;
+	}
+
+	void run(CXCursor root, const std::function<void(CXCursor)> &callback) const {
+		std::exception_ptr exception;
+		Context context{this, 1, &callback, &exception};
+		clang_visitChildren(root, &Plan::visit, &context);
+		if ( exception ) {
+			std::rethrow_exception(exception);
+		}
+	}
+
+  private:
+	static CXChildVisitResult visit(CXCursor cursor, CXCursor /*parent*/, CXClientData client_data) {
+		const auto context = static_cast<const Context *>(client_data);
+		try {
+			return visit(cursor, *context);
+		}
+		catch ( ... ) {
+			// never unwind through libclang
+			*context->exception = std::current_exception();
+			return CXChildVisit_Break;
+		}
+	}
+
+	static CXChildVisitResult visit(CXCursor cursor, const Context &context) {
+		const Plan &plan = *context.plan;
+		const auto kind = static_cast<std::size_t>(cursor.kind);
+		// a kind newer than the vendored header may hold matches: search it
+		if ( kind < plan.m_descend.size() && !plan.m_descend[kind] ) {
+			return CXChildVisit_Continue;
+		}
+
+		const std::size_t last{plan.m_steps.size() - 1};
+		std::uint64_t children{context.active & plan.m_persistent};
+		Node node(cursor);
+		for ( std::uint64_t active{context.active}; active; active &= active - 1 ) {
+			const std::size_t index{count_trailing_zeros(active)};
+			if ( !plan.matches(plan.m_steps[index], node, kind) ) {
+				continue;
+			}
+			if ( index == last ) {
+				(*context.callback)(cursor);
+			}
+			else {
+				children |= std::uint64_t(1) << (index + 1);
+			}
+		}
+
+		Context inner{&plan, children, context.callback, context.exception};
+		clang_visitChildren(cursor, &Plan::visit, &inner);
+		return *context.exception ? CXChildVisit_Break : CXChildVisit_Continue;
+	}
+
+	bool matches(const Step &step, Node &node, std::size_t kind) const {
+		// cheapest checks first: kind bit, then flags, then strings
+		// only `*` names the kinds newer than the vendored header
+		if ( (kind < step.kinds.size()) ? !step.kinds[kind] : !step.kinds.all() ) {
+			return false;
+		}
+		if ( step.flags && !node.has_flags(step.flags) ) {
+			return false;
+		}
+		for ( const auto &predicate : step.strings ) {
+			if ( !predicate.test(node.string(predicate.field)) ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static std::size_t count_trailing_zeros(std::uint64_t value) noexcept {
+		std::size_t count{0};
+		while ( !(value & 1) ) {
+			value >>= 1;
+			++count;
+		}
+		return count;
+	}
+}; // class Query::Plan
+
+Query Query::compile(const std::string &selector)
+{
+	return Query(std::make_shared<const Plan>(selector));
+}
+
+Query::Query(std::shared_ptr<const Plan> plan) noexcept
+	: m_plan(std::move(plan))
+{}
+
+Query::~Query() = default;
+
+Query::Query(const Query &/*other*/) = default;
+Query::Query(Query &&/*other*/) noexcept = default;
+
+Query &Query::operator=(const Query &/*other*/) = default;
+Query &Query::operator=(Query &&/*other*/) noexcept = default;
+
+const std::string &Query::selector() const noexcept
+{
+	return m_plan->selector();
+}
+
+void Query::match(const Cursor &root, const Callback &callback) const
+{
+	const auto translation_unit = root.translation_unit();
+	m_plan->run(root.native_handle(), [&](CXCursor cx_cursor) {
+		callback(Cursor::from_native_handle(cx_cursor, translation_unit));
+	});
+}
+
+std::vector<Cursor> Query::match(const Cursor &root) const
+{
+	std::vector<Cursor> matches;
+	match(root, [&matches](const Cursor &cursor) {
+		matches.push_back(cursor);
+	});
+	return matches;
+}
+
+ArenaVector<Cursor> Query::match(const Cursor &root, Arena &arena) const
+{
+	ArenaVector<Cursor> matches{ArenaAllocator<Cursor>(arena)};
+	match(root, [&matches](const Cursor &cursor) {
+		matches.push_back(cursor);
+	});
+	return matches;
+}
+
+std::vector<std::vector<Cursor>> Query::match(
+  const std::vector<std::shared_ptr<TranslationUnit>> &translation_units,
+  unsigned int thread_count/* = 0*/) const
+{
+	std::vector<std::vector<Cursor>> matches(translation_units.size());
+	parallel_for(translation_units.size(), [&](std::size_t index) {
+		matches[index] = match(translation_units[index]->cursor());
+	}, thread_count);
+	return matches;
+}
+
+} // namespace clangxx
@@ -0,0 +1,181 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ReparseScheduler.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ReparseScheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+
+
+namespace clangxx {
+
+ReparseScheduler::ReparseScheduler(std::shared_ptr<TranslationUnit> translation_unit)
+	: ReparseScheduler(std::move(translation_unit), Options())
+{}
+
+ReparseScheduler::ReparseScheduler(std::shared_ptr<TranslationUnit> translation_unit, Options options)
+	: m_translation_unit(std::move(translation_unit))
+	, m_options(options)
+{
+	if ( !m_translation_unit ) {
+		CLANGXX_THROW_LogicError("Null translation unit.");
+	}
+	m_thread = std::thread(&ReparseScheduler::run, this);
+}
+
+ReparseScheduler::~ReparseScheduler()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_updated.notify_all();
+	m_thread.join();
+	m_ready.notify_all();
+}
+
+void ReparseScheduler::set_callback(Callback callback)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_callback = std::move(callback);
+}
+
+ReparseScheduler::Version ReparseScheduler::update(std::vector<UnsavedFile> unsaved_files)
+{
+	const auto now = Clock::now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if ( m_has_pending ) {
+		++m_stats.superseded;
+	}
+	else {
+		m_first_update = now;
+	}
+	m_last_update = now;
+	m_pending = std::move(unsaved_files);
+	m_has_pending = true;
+	++m_stats.updates;
+	const Version version = ++m_pending_version;
+	m_updated.notify_all();
+	return version;
+}
+
+ReparseScheduler::Version ReparseScheduler::wait(Version version)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_ready.wait(lock, [this, version] {
+			return m_stopping || m_ready_version >= version || m_failed_version >= version;
+		});
+	return m_ready_version;
+}
+
+ReparseScheduler::Version ReparseScheduler::ready_version() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_ready_version;
+}
+
+ReparseScheduler::Version ReparseScheduler::failed_version() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_failed_version;
+}
+
+void ReparseScheduler::access(
+	const std::function<void(TranslationUnit &translation_unit, Version version)> &function)
+{
+	std::lock_guard<std::mutex> translation_unit_lock(m_translation_unit_mutex);
+	// the ready version cannot change while the translation unit is locked
+	function(*m_translation_unit, ready_version());
+}
+
+ReparseScheduler::Duration ReparseScheduler::delay() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return delay_locked();
+}
+
+ReparseScheduler::Stats ReparseScheduler::stats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+ReparseScheduler::Duration ReparseScheduler::delay_locked() const
+{
+	if ( m_cost < 0.0 ) {
+		return m_options.min_delay;
+	}
+	const Duration scaled(std::chrono::duration_cast<Duration>(
+		std::chrono::duration<double>(m_cost * m_options.cost_factor)));
+	return std::min<Duration>(std::max<Duration>(scaled, m_options.min_delay), m_options.max_delay);
+}
+
+void ReparseScheduler::run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for ( ;; ) {
+		m_updated.wait(lock, [this] { return m_stopping || m_has_pending; });
+		if ( m_stopping ) {
+			return;
+		}
+
+		const auto deadline = std::min(m_last_update + delay_locked(),
+									   m_first_update + m_options.max_delay);
+		if ( Clock::now() < deadline ) {
+			m_updated.wait_until(lock, deadline);
+			continue;
+		}
+
+		std::vector<UnsavedFile> unsaved_files(std::move(m_pending));
+		m_pending.clear();
+		m_has_pending = false;
+		const Version version = m_pending_version;
+		lock.unlock();
+
+		std::exception_ptr error;
+		const auto begin = Clock::now();
+		{
+			std::lock_guard<std::mutex> translation_unit_lock(m_translation_unit_mutex);
+			try {
+				m_translation_unit->reparse(&unsaved_files);
+			}
+			catch ( ... ) {
+				error = std::current_exception();
+			}
+
+			lock.lock();
+			const double cost = std::chrono::duration<double>(Clock::now() - begin).count();
+			++m_stats.reparses;
+			if ( error ) {
+				++m_stats.failures;
+				m_failed_version = version;
+			}
+			else {
+				m_cost = (m_cost < 0.0) ? cost
+					: m_options.smoothing * cost + (1.0 - m_options.smoothing) * m_cost;
+				m_ready_version = version;
+			}
+		}
+		m_ready.notify_all();
+
+		const Callback callback(m_callback);
+		if ( callback ) {
+			lock.unlock();
+			try {
+				callback(version, error);
+			}
+			catch ( ... ) {
+			}
+			lock.lock();
+		}
+	}
+}
+
+} // namespace clangxx
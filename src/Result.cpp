@@ -0,0 +1,25 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Result.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Result.hpp"
+
+
+namespace clangxx {
+
+const char *name(Status status) noexcept
+{
+	switch ( status ) {
+	  case Status::OK:			return "OK";
+	  case Status::Null:		return "Null";
+	  case Status::NotFound:	return "NotFound";
+	  case Status::NoString:	return "NoString";
+	  case Status::Unknown:		return "Unknown";
+	  case Status::OutOfMemory:	return "OutOfMemory";
+	}
+	return "";
+}
+
+} // namespace clangxx
@@ -0,0 +1,114 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ScopeNameTable.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ScopeNameTable.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+bool is_root(CXCursor cx_cursor)
+{
+	return clangxx::is_null(cx_cursor)
+		|| (cx_cursor.kind == CXCursor_TranslationUnit)
+		|| clang_isInvalid(cx_cursor.kind);
+}
+
+} // namespace
+
+namespace clangxx {
+
+const char	ScopeNameTable::s_separator[] = "::";
+
+ScopeNameTable::ScopeNameTable() = default;
+
+ScopeNameTable::~ScopeNameTable() = default;
+
+std::string ScopeNameTable::qualified_name(CXCursor cx_cursor)
+{
+	const CXCursor cx_parent(clang_getCursorSemanticParent(cx_cursor));
+	std::string name(name_of(cx_cursor));
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const Scope *parent = scope(cx_parent);
+	if ( !parent || parent->qualified_name.empty() ) {
+		return name;
+	}
+	return parent->qualified_name + s_separator + name;
+}
+
+std::vector<std::string> ScopeNameTable::scope_path(CXCursor cx_cursor)
+{
+	const CXCursor cx_parent(clang_getCursorSemanticParent(cx_cursor));
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<std::string> path;
+	for ( const Scope *current = scope(cx_parent); current; current = m_scopes.find(current->parent) ) {
+		path.push_back(current->name);
+	}
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+void ScopeNameTable::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_scopes.clear();
+}
+
+const ScopeNameTable::Scope *ScopeNameTable::scope(CXCursor cx_scope)
+{
+	if ( is_root(cx_scope) ) {
+		return nullptr;
+	}
+	if ( const Scope *known = m_scopes.find(cx_scope) ) {
+		return known;
+	}
+
+	// collect the unnamed part of the chain, then name it outermost first
+	std::vector<CXCursor> chain{cx_scope};
+	for ( ;; ) {
+		const CXCursor cx_parent(clang_getCursorSemanticParent(chain.back()));
+		if ( is_root(cx_parent) || m_scopes.find(cx_parent) ) {
+			break;
+		}
+		chain.push_back(cx_parent);
+	}
+
+	for ( auto iter = chain.rbegin(); iter != chain.rend(); ++iter ) {
+		Scope scope;
+		scope.name = name_of(*iter);
+		scope.parent = clang_getCursorSemanticParent(*iter);
+		const Scope *parent = is_root(scope.parent) ? nullptr : m_scopes.find(scope.parent);
+		scope.qualified_name = (parent && !parent->qualified_name.empty())
+			? parent->qualified_name + s_separator + scope.name
+			: scope.name;
+		if ( !parent ) {
+			scope.parent = CXCursor();
+		}
+		m_scopes.insert(*iter, std::move(scope));
+	}
+	return m_scopes.find(cx_scope);
+}
+
+std::string ScopeNameTable::name_of(CXCursor cx_cursor)
+{
+	UniqueCXString cx_string(clang_getCursorSpelling(cx_cursor));
+	const char *spelling = cx_string ? clang_getCString(cx_string.get()) : nullptr;
+	if ( spelling && *spelling ) {
+		return spelling;
+	}
+	return (cx_cursor.kind == CXCursor_Namespace) ? "(anonymous namespace)" : "(anonymous)";
+}
+
+} // namespace clangxx
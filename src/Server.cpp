@@ -0,0 +1,691 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Server.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Server.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/CursorMap.hpp"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/ServerProtocol.hpp"
+#include "clang-cpp/ThreadPool.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+#include "clang-cpp/UnsavedFile.hpp"
+#if !defined _WIN32
+	#include <cerrno>
+	#include <sys/socket.h>
+	#include <sys/types.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+
+#if !defined _WIN32
+
+namespace {
+
+namespace protocol = clangxx::protocol;
+
+using protocol::MessageType;
+using protocol::Status;
+
+std::string to_string(CXString cx_string)
+{
+	clangxx::UniqueCXString unique_cx_string(cx_string);
+	const char *c_string = unique_cx_string ? clang_getCString(unique_cx_string.get()) : nullptr;
+	return c_string ? c_string : std::string();
+}
+
+protocol::Location location_of(CXCursor cursor)
+{
+	protocol::Location location;
+	if ( clang_Cursor_isNull(cursor) ) {
+		return location;
+	}
+	CXFile cx_file = nullptr;
+	unsigned int line = 0, column = 0;
+	clang_getExpansionLocation(clang_getCursorLocation(cursor), &cx_file, &line, &column, nullptr);
+	if ( cx_file ) {
+		location.filename = to_string(clang_getFileName(cx_file));
+	}
+	location.line = line;
+	location.column = column;
+	return location;
+}
+
+std::vector<clangxx::UnsavedFile> to_unsaved_files(const protocol::UnsavedContents &contents)
+{
+	std::vector<clangxx::UnsavedFile> result;
+	result.reserve(contents.size());
+	for ( const auto &content : contents ) {
+		clangxx::UnsavedFile unsaved_file;
+		unsaved_file.filename = content.first;
+		unsaved_file.contents.reset(new std::istringstream(content.second));
+		result.push_back(std::move(unsaved_file));
+	}
+	return result;
+}
+
+class Connection
+{
+  private:
+	const int	m_descriptor;
+	std::mutex	m_write_mutex;
+
+  public:
+	explicit Connection(int descriptor) noexcept
+		: m_descriptor(descriptor)
+	{}
+
+	~Connection() {
+		::close(m_descriptor);
+	}
+
+	Connection(const Connection &) = delete;
+	Connection &operator=(const Connection &) = delete;
+
+  public:
+	int descriptor() const noexcept {
+		return m_descriptor;
+	}
+
+	void reply(std::uint32_t request_id, Status status, const std::string &payload) {
+		std::string data(1, static_cast<char>(status));
+		data += payload;
+		std::lock_guard<std::mutex> lock(m_write_mutex);
+		try {
+			protocol::write_frame(m_descriptor, MessageType::Reply, request_id, data);
+		}
+		catch ( const std::runtime_error & ) {
+			// the client went away
+		}
+	}
+
+	void shutdown() noexcept {
+		::shutdown(m_descriptor, SHUT_RDWR);
+	}
+}; // class Connection
+
+struct Request
+{
+	std::shared_ptr<Connection>	connection;
+	std::uint32_t				id;
+	MessageType					type;
+	std::string					payload;
+}; // struct Request
+
+//! Requests for one translation unit; drained by one worker at a time.
+struct Session
+{
+	std::mutex							mutex;
+	std::deque<Request>					queue;
+	bool								scheduled{false};
+	//! key of the session in the server
+	std::string							filename;
+	std::shared_ptr<clangxx::TranslationUnit>	translation_unit;
+	//! guarded by the server mutex
+	std::uint64_t						last_used{0};
+}; // struct Session
+
+//! Thread reading the requests of one connection.
+struct Reader
+{
+	std::shared_ptr<Connection>	connection;
+	std::thread					thread;
+}; // struct Reader
+
+struct ReferenceContext
+{
+	const std::string				*usr;
+	clangxx::CursorMap<bool>		matches;
+	std::vector<protocol::Location>	locations;
+	std::exception_ptr				exception;
+}; // struct ReferenceContext
+
+CXChildVisitResult find_references(CXCursor cursor, ReferenceContext *context)
+{
+	const CXCursorKind kind(cursor.kind);
+	if ( clang_isReference(kind) || clang_isExpression(kind) || clang_isDeclaration(kind) ) {
+		const CXCursor referenced(clang_getCursorReferenced(cursor));
+		if ( !clang_Cursor_isNull(referenced) ) {
+			// many references share a declaration; compare its USR once
+			const auto inserted = context->matches.insert(referenced, false);
+			if ( inserted.second ) {
+				*inserted.first = (to_string(clang_getCursorUSR(referenced)) == *context->usr);
+			}
+			if ( *inserted.first ) {
+				context->locations.push_back(location_of(cursor));
+			}
+		}
+	}
+	return CXChildVisit_Recurse;
+}
+
+CXChildVisitResult reference_visitor(CXCursor cursor, CXCursor /*parent*/, CXClientData client_data)
+{
+	const auto context = static_cast<ReferenceContext *>(client_data);
+	try {
+		return find_references(cursor, context);
+	}
+	catch ( ... ) {
+		// never unwind through libclang
+		context->exception = std::current_exception();
+		return CXChildVisit_Break;
+	}
+}
+
+} // namespace
+
+#endif // !defined _WIN32
+
+namespace clangxx {
+
+const std::size_t	Server::default_max_translation_units;
+
+class Server::Impl
+{
+  private:
+	const std::string			m_socket_path;
+	std::shared_ptr<Index>		m_index;
+	const unsigned int			m_worker_count;
+	const std::size_t			m_max_translation_units;
+#if !defined _WIN32
+	std::unique_ptr<ThreadPool>	m_pool;
+	int							m_listener{-1};
+	std::thread					m_acceptor;
+	mutable std::mutex			m_mutex;
+	std::condition_variable		m_stopped;
+	bool						m_running{false};
+	std::unordered_map<std::string, std::shared_ptr<Session>>	m_sessions;
+	std::uint64_t				m_clock{0};
+	std::unordered_map<const Connection *, Reader>	m_readers;
+	//! readers whose connection closed, joined by the acceptor
+	std::vector<std::thread>	m_finished;
+	std::condition_variable		m_reader_exited;
+#endif
+
+  public:
+	Impl(std::string socket_path, std::shared_ptr<Index> index, unsigned int worker_count,
+		 std::size_t max_translation_units)
+		: m_socket_path(std::move(socket_path))
+		, m_index(index ? std::move(index) : Index::create())
+		, m_worker_count(worker_count)
+		, m_max_translation_units(max_translation_units)
+	{}
+
+	~Impl() {
+		stop();
+	}
+
+  public:
+	const std::string &socket_path() const noexcept {
+		return m_socket_path;
+	}
+
+#if defined _WIN32
+	void start() {
+		CLANGXX_THROW_RuntimeError("Server requires Unix domain sockets.");
+	}
+
+	void stop() {}
+
+	void wait() {}
+
+	std::size_t translation_unit_count() const {
+		return 0;
+	}
+#else
+	void start() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if ( m_running ) {
+			return;
+		}
+
+		sockaddr_un address;
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if ( m_socket_path.size() >= sizeof(address.sun_path) ) {
+			CLANGXX_THROW_LogicError("Socket path too long: " + m_socket_path);
+		}
+		std::strcpy(address.sun_path, m_socket_path.c_str());
+
+		const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if ( listener < 0 ) {
+			CLANGXX_THROW_RuntimeError(std::string("Error creating a socket: ") + std::strerror(errno));
+		}
+		::unlink(m_socket_path.c_str());
+		if ( ::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+			 || ::listen(listener, 64) != 0 )
+		{
+			const int error = errno;
+			::close(listener);
+			CLANGXX_THROW_RuntimeError("Error listening on " + m_socket_path + ": " + std::strerror(error));
+		}
+
+		m_listener = listener;
+		m_pool.reset(new ThreadPool(m_worker_count));
+		m_running = true;
+		m_acceptor = std::thread(&Impl::accept_loop, this);
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if ( !m_running ) {
+				return;
+			}
+			m_running = false;
+		}
+
+		::shutdown(m_listener, SHUT_RDWR);
+		::close(m_listener);
+		m_acceptor.join();
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for ( const auto &reader : m_readers ) {
+				reader.second.connection->shutdown();
+			}
+			m_reader_exited.wait(lock, [this] { return m_readers.empty(); });
+		}
+		join_finished();
+
+		// runs the batches still queued; their replies go nowhere
+		m_pool.reset();
+		::unlink(m_socket_path.c_str());
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_sessions.clear();
+		m_stopped.notify_all();
+	}
+
+	void wait() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_stopped.wait(lock, [this] { return !m_running; });
+	}
+
+	std::size_t translation_unit_count() const {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_sessions.size();
+	}
+
+  private:
+	void accept_loop() {
+		for ( ;; ) {
+			const int descriptor = ::accept(m_listener, nullptr, nullptr);
+			if ( descriptor < 0 ) {
+				if ( errno == EINTR ) {
+					continue;
+				}
+				return;
+			}
+
+			join_finished();
+
+			const auto connection = std::make_shared<Connection>(descriptor);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if ( !m_running ) {
+				return;
+			}
+			Reader &reader = m_readers[connection.get()];
+			reader.connection = connection;
+			reader.thread = std::thread(&Impl::read_loop, this, connection);
+		}
+	}
+
+	void join_finished() {
+		std::vector<std::thread> finished;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			finished.swap(m_finished);
+		}
+		for ( auto &thread : finished ) {
+			thread.join();
+		}
+	}
+
+	void read_loop(std::shared_ptr<Connection> connection) {
+		protocol::FrameHeader header;
+		std::string payload;
+		try {
+			while ( protocol::read_frame(connection->descriptor(), header, payload) ) {
+				enqueue(Request{connection, header.request_id, header.type, std::move(payload)});
+				payload = std::string();
+			}
+		}
+		catch ( const std::runtime_error & ) {
+			// malformed stream; drop the connection
+		}
+
+		// the acceptor, or stop(), joins this thread
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const auto found = m_readers.find(connection.get());
+		m_finished.push_back(std::move(found->second.thread));
+		m_readers.erase(found);
+		m_reader_exited.notify_all();
+	}
+
+	void enqueue(Request request) {
+		std::string filename;
+		try {
+			filename = protocol::Decoder(request.payload.data(), request.payload.size()).get_string();
+		}
+		catch ( const std::runtime_error &e ) {
+			request.connection->reply(request.id, protocol::Status::Error, error_payload(e.what()));
+			return;
+		}
+
+		// only a parse opens a session, so requests for unknown files evict nothing
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto found = m_sessions.find(filename);
+		if ( found == m_sessions.end() ) {
+			if ( request.type != MessageType::Parse ) {
+				lock.unlock();
+				request.connection->reply(request.id, protocol::Status::Error,
+										  error_payload("Not parsed: " + filename));
+				return;
+			}
+			found = m_sessions.emplace(filename, std::make_shared<Session>()).first;
+			found->second->filename = filename;
+		}
+		const std::shared_ptr<Session> session(found->second);
+		session->last_used = ++m_clock;
+
+		// taken before the server mutex is released, so evict() sees the request
+		std::lock_guard<std::mutex> session_lock(session->mutex);
+		lock.unlock();
+		session->queue.push_back(std::move(request));
+		if ( !session->scheduled ) {
+			session->scheduled = true;
+			m_pool->submit([this, session] { drain(*session); });
+		}
+	}
+
+	/*!
+	  Called after each successful parse; drops the least recently used idle
+	  translation units above the limit, whose clients get "Not parsed" and
+	  parse again.  Sessions with queued or running requests are kept, so the
+	  limit may be exceeded briefly.
+	*/
+	void evict(const Session &keep) {
+		while ( m_max_translation_units && m_sessions.size() > m_max_translation_units ) {
+			auto victim = m_sessions.end();
+			for ( auto iter = m_sessions.begin(); iter != m_sessions.end(); ++iter ) {
+				Session &session = *iter->second;
+				if ( &session == &keep
+					 || (victim != m_sessions.end() && victim->second->last_used <= session.last_used) )
+				{
+					continue;
+				}
+				std::lock_guard<std::mutex> lock(session.mutex);
+				if ( !session.scheduled && session.queue.empty() ) {
+					victim = iter;
+				}
+			}
+			if ( victim == m_sessions.end() ) {
+				return;
+			}
+			m_sessions.erase(victim);
+		}
+	}
+
+	//! Drops @a session, left without a translation unit, unless more requests are queued.
+	void forget(Session &session) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::lock_guard<std::mutex> session_lock(session.mutex);
+		if ( !session.queue.empty() ) {
+			return;
+		}
+		const auto found = m_sessions.find(session.filename);
+		if ( found != m_sessions.end() && found->second.get() == &session ) {
+			m_sessions.erase(found);
+		}
+	}
+
+	//! Handles the queued requests of @a session, batch after batch.
+	void drain(Session &session) {
+		for ( ;; ) {
+			std::deque<Request> batch;
+			{
+				std::lock_guard<std::mutex> lock(session.mutex);
+				if ( session.queue.empty() ) {
+					session.scheduled = false;
+					return;
+				}
+				batch.swap(session.queue);
+			}
+
+			for ( std::size_t i = 0; i < batch.size(); ++i ) {
+				// a run of reparses is done once, with the latest contents
+				std::size_t last = i;
+				if ( batch[i].type == MessageType::Reparse ) {
+					while ( last + 1 < batch.size() && batch[last + 1].type == MessageType::Reparse ) {
+						++last;
+					}
+				}
+
+				protocol::Status status = protocol::Status::OK;
+				std::string payload;
+				try {
+					payload = handle(session, batch[last]);
+				}
+				catch ( const std::logic_error &e ) {
+					status = protocol::Status::Error;
+					payload = error_payload(e.what());
+				}
+				catch ( const std::runtime_error &e ) {
+					status = protocol::Status::Error;
+					payload = error_payload(e.what());
+				}
+				catch ( ... ) {
+					status = protocol::Status::Error;
+					payload = error_payload("Unknown error.");
+				}
+				// before the reply, so the client sees the sessions it leaves
+				if ( status == protocol::Status::OK && batch[last].type == MessageType::Parse ) {
+					std::lock_guard<std::mutex> lock(m_mutex);
+					evict(session);
+				}
+				else if ( !session.translation_unit && last + 1 == batch.size() ) {
+					forget(session);
+				}
+
+				for ( ; i <= last; ++i ) {
+					batch[i].connection->reply(batch[i].id, status, payload);
+				}
+				--i;
+			}
+		}
+	}
+
+	std::string handle(Session &session, const Request &request) {
+		protocol::Decoder decoder(request.payload.data(), request.payload.size());
+		const std::string filename(decoder.get_string());
+		protocol::Encoder encoder;
+
+		if ( request.type == MessageType::Parse ) {
+			const std::vector<std::string> args(decoder.get_strings());
+			const auto unsaved_files = to_unsaved_files(decoder.get_unsaved());
+			session.translation_unit.reset();
+			session.translation_unit = TranslationUnit::from_source(
+				filename, &args, &unsaved_files,
+				static_cast<CXTranslationUnit_Flags>(clang_defaultEditingTranslationUnitOptions()),
+				m_index);
+			return encoder.data();
+		}
+
+		if ( !session.translation_unit ) {
+			CLANGXX_THROW_LogicError("Not parsed: " + filename);
+		}
+		TranslationUnit &translation_unit = *session.translation_unit;
+		const CXTranslationUnit cx_translation_unit(translation_unit.native_handle());
+
+		switch ( request.type ) {
+		  case MessageType::Reparse: {
+			const auto unsaved_files = to_unsaved_files(decoder.get_unsaved());
+			translation_unit.reparse(&unsaved_files);
+			break;
+		  }
+		  case MessageType::CursorAt: {
+			std::string file(decoder.get_string());
+			const std::uint32_t line(decoder.get_u32());
+			const std::uint32_t column(decoder.get_u32());
+			if ( file.empty() ) {
+				file = filename;
+			}
+			const CXFile cx_file(clang_getFile(cx_translation_unit, file.c_str()));
+			if ( !cx_file ) {
+				CLANGXX_THROW_LogicError("Not a file of the translation unit: " + file);
+			}
+			const CXCursor cursor(clang_getCursor(
+				cx_translation_unit, clang_getLocation(cx_translation_unit, cx_file, line, column)));
+			const CXCursor referenced(clang_getCursorReferenced(cursor));
+
+			encoder.put(to_string(clang_getCursorKindSpelling(cursor.kind)));
+			encoder.put(to_string(clang_getCursorSpelling(cursor)));
+			encoder.put(to_string(clang_getCursorUSR(cursor)));
+			encoder.put(location_of(cursor));
+			encoder.put(clang_Cursor_isNull(referenced) ? std::string()
+						: to_string(clang_getCursorUSR(referenced)));
+			encoder.put(location_of(clang_getCursorDefinition(cursor)));
+			break;
+		  }
+		  case MessageType::References: {
+			const std::string usr(decoder.get_string());
+			ReferenceContext context{&usr, {}, {}, nullptr};
+			clang_visitChildren(clang_getTranslationUnitCursor(cx_translation_unit),
+								&reference_visitor, &context);
+			if ( context.exception ) {
+				std::rethrow_exception(context.exception);
+			}
+			encoder.put(static_cast<std::uint32_t>(context.locations.size()));
+			for ( const auto &location : context.locations ) {
+				encoder.put(location);
+			}
+			break;
+		  }
+		  case MessageType::Complete: {
+			const std::uint32_t line(decoder.get_u32());
+			const std::uint32_t column(decoder.get_u32());
+			const protocol::UnsavedContents contents(decoder.get_unsaved());
+			std::vector<CXUnsavedFile> unsaved_array;
+			for ( const auto &content : contents ) {
+				unsaved_array.push_back(CXUnsavedFile{content.first.c_str(), content.second.data(),
+													  static_cast<unsigned long>(content.second.size())});
+			}
+			encode_completions(encoder, cx_translation_unit, filename, line, column, unsaved_array);
+			break;
+		  }
+		  default:
+			CLANGXX_THROW_LogicError("Unknown request type.");
+		}
+		return encoder.data();
+	}
+
+	static void encode_completions(protocol::Encoder &encoder, CXTranslationUnit cx_translation_unit,
+								   const std::string &filename, unsigned int line, unsigned int column,
+								   std::vector<CXUnsavedFile> &unsaved_array) {
+		CXCodeCompleteResults *results = clang_codeCompleteAt(
+			cx_translation_unit, filename.c_str(), line, column,
+			unsaved_array.data(), static_cast<unsigned int>(unsaved_array.size()),
+			clang_defaultCodeCompleteOptions());
+		if ( !results ) {
+			CLANGXX_THROW_RuntimeError("Error completing " + filename + ".");
+		}
+
+		std::vector<protocol::Completion> completions;
+		completions.reserve(results->NumResults);
+		for ( unsigned int i = 0; i < results->NumResults; ++i ) {
+			const CXCompletionString string(results->Results[i].CompletionString);
+			if ( clang_getCompletionAvailability(string) == CXAvailability_NotAvailable ) {
+				continue;
+			}
+			protocol::Completion completion;
+			completion.priority = clang_getCompletionPriority(string);
+			const unsigned int chunk_count = clang_getNumCompletionChunks(string);
+			for ( unsigned int chunk = 0; chunk < chunk_count; ++chunk ) {
+				const std::string text(to_string(clang_getCompletionChunkText(string, chunk)));
+				if ( clang_getCompletionChunkKind(string, chunk) == CXCompletionChunk_TypedText ) {
+					completion.typed_text = text;
+				}
+				completion.text += text;
+			}
+			completions.push_back(std::move(completion));
+		}
+		clang_disposeCodeCompleteResults(results);
+
+		std::stable_sort(completions.begin(), completions.end(),
+						 [](const protocol::Completion &lhs, const protocol::Completion &rhs) {
+							 return lhs.priority < rhs.priority;
+						 });
+		encoder.put(static_cast<std::uint32_t>(completions.size()));
+		for ( const auto &completion : completions ) {
+			encoder.put(completion.typed_text);
+			encoder.put(completion.text);
+			encoder.put(completion.priority);
+		}
+	}
+
+	static std::string error_payload(const std::string &message) {
+		protocol::Encoder encoder;
+		encoder.put(message);
+		return encoder.data();
+	}
+#endif
+}; // class Server::Impl
+
+Server::Server(std::string socket_path, std::shared_ptr<Index> index/* = nullptr*/,
+			   unsigned int worker_count/* = 0*/,
+			   std::size_t max_translation_units/* = default_max_translation_units*/)
+	: m_impl(new Impl(std::move(socket_path), std::move(index), worker_count,
+					  max_translation_units))
+{}
+
+Server::~Server() = default;
+
+const std::string &Server::socket_path() const noexcept
+{
+	return m_impl->socket_path();
+}
+
+void Server::start()
+{
+	m_impl->start();
+}
+
+void Server::stop()
+{
+	m_impl->stop();
+}
+
+void Server::wait()
+{
+	m_impl->wait();
+}
+
+std::size_t Server::translation_unit_count() const
+{
+	return m_impl->translation_unit_count();
+}
+
+} // namespace clangxx
@@ -0,0 +1,106 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ServerProtocol.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ServerProtocol.hpp"
+
+#if !defined _WIN32
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include "clang-cpp/Exception.hpp"
+
+
+namespace {
+
+//! @return false if the stream ended before the first byte.
+bool receive(int descriptor, char *data, std::size_t size)
+{
+	std::size_t received = 0;
+	while ( received < size ) {
+		const ssize_t result = ::recv(descriptor, data + received, size - received, 0);
+		if ( result == 0 ) {
+			if ( received == 0 ) {
+				return false;
+			}
+			CLANGXX_THROW_RuntimeError("Truncated frame.");
+		}
+		if ( result < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+			CLANGXX_THROW_RuntimeError(std::string("Error receiving a frame: ") + std::strerror(errno));
+		}
+		received += static_cast<std::size_t>(result);
+	}
+	return true;
+}
+
+void send_all(int descriptor, const char *data, std::size_t size)
+{
+	while ( size > 0 ) {
+#if defined MSG_NOSIGNAL
+		const ssize_t result = ::send(descriptor, data, size, MSG_NOSIGNAL);
+#else
+		const ssize_t result = ::send(descriptor, data, size, 0);
+#endif
+		if ( result < 0 ) {
+			if ( errno == EINTR ) {
+				continue;
+			}
+			CLANGXX_THROW_RuntimeError(std::string("Error sending a frame: ") + std::strerror(errno));
+		}
+		data += result;
+		size -= static_cast<std::size_t>(result);
+	}
+}
+
+} // namespace
+
+namespace clangxx {
+namespace protocol {
+
+bool read_frame(int descriptor, FrameHeader &header, std::string &payload)
+{
+	if ( !receive(descriptor, reinterpret_cast<char *>(&header), sizeof(header)) ) {
+		return false;
+	}
+	if ( header.size > max_frame_size ) {
+		CLANGXX_THROW_RuntimeError("Frame too large.");
+	}
+	payload.resize(header.size);
+	if ( header.size != 0 && !receive(descriptor, &payload[0], header.size) ) {
+		CLANGXX_THROW_RuntimeError("Truncated frame.");
+	}
+	return true;
+}
+
+void write_frame(int descriptor, MessageType type, std::uint32_t request_id,
+				 const std::string &payload)
+{
+	if ( payload.size() > max_frame_size ) {
+		CLANGXX_THROW_LogicError("Frame too large.");
+	}
+
+	FrameHeader header;
+	header.size = static_cast<std::uint32_t>(payload.size());
+	header.request_id = request_id;
+	header.type = type;
+	std::memset(header.reserved, 0, sizeof(header.reserved));
+
+	std::string frame(reinterpret_cast<const char *>(&header), sizeof(header));
+	frame += payload;
+	send_all(descriptor, frame.data(), frame.size());
+}
+
+} // namespace protocol
+} // namespace clangxx
+
+#endif // !defined _WIN32
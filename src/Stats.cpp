@@ -0,0 +1,276 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Stats.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Stats.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+
+namespace {
+
+using clangxx::stats::Counter;
+
+const std::size_t	counter_count	= static_cast<std::size_t>(Counter::count);
+
+const char *const	s_names[counter_count] = {
+	"Cursor::spelling",
+	"Cursor::displayname",
+	"Cursor::get_usr",
+	"Cursor::get_definition",
+	"Cursor::canonical",
+	"Cursor::hash",
+	"Cursor::semantic_parent",
+	"Cursor::lexical_parent",
+	"Cursor::referenced",
+	"Cursor::qualified_name",
+	"Cursor::scope_path",
+	"Cursor::get_children",
+	"Cursor::visit_children",
+	"File::name",
+	"File::time",
+	"TranslationUnit::from_source",
+	"TranslationUnit::from_ast_file",
+	"TranslationUnit::reparse",
+	"TranslationUnit::save",
+};
+
+#if defined CLANGXX_ENABLE_STATS
+
+const std::size_t	cache_line_size	= 64;
+
+/*!
+  Written by its thread only, read by snapshot(): relaxed loads and stores
+  suffice, and avoid the cost of atomic read-modify-write operations.
+*/
+struct alignas(cache_line_size) Slot
+{
+	std::atomic<std::uint64_t>	calls;
+	std::atomic<std::uint64_t>	hits;
+	std::atomic<std::uint64_t>	misses;
+	std::atomic<std::uint64_t>	total_nanoseconds;
+	std::atomic<std::uint64_t>	histogram[clangxx::stats::histogram_size];
+}; // struct Slot
+
+void increment(std::atomic<std::uint64_t> &value, std::uint64_t amount = 1) noexcept
+{
+	value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+struct ThreadSlots
+{
+	Slot	slots[counter_count];
+
+	void reset() noexcept {
+		for ( auto &slot : slots ) {
+			slot.calls.store(0, std::memory_order_relaxed);
+			slot.hits.store(0, std::memory_order_relaxed);
+			slot.misses.store(0, std::memory_order_relaxed);
+			slot.total_nanoseconds.store(0, std::memory_order_relaxed);
+			for ( auto &bucket : slot.histogram ) {
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}; // struct ThreadSlots
+
+//! Releases memory obtained by allocate_slots().
+struct SlotsDeleter
+{
+	void operator()(ThreadSlots *slots) const noexcept {
+		if ( slots ) {
+			void *memory = reinterpret_cast<void **>(slots)[-1];
+			slots->~ThreadSlots();
+			std::free(memory);
+		}
+	}
+}; // struct SlotsDeleter
+
+using SlotsPtr	= std::unique_ptr<ThreadSlots, SlotsDeleter>;
+
+//! operator new does not honor extended alignments before C++17.
+SlotsPtr allocate_slots()
+{
+	const std::size_t header = sizeof(void *);
+	void *memory = std::malloc(sizeof(ThreadSlots) + cache_line_size + header);
+	if ( !memory ) {
+		throw std::bad_alloc();
+	}
+	const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory) + header;
+	const std::uintptr_t aligned = (address + cache_line_size - 1) & ~(cache_line_size - 1);
+	reinterpret_cast<void **>(aligned)[-1] = memory;
+	ThreadSlots *slots = new(reinterpret_cast<void *>(aligned)) ThreadSlots;
+	slots->reset();
+	return SlotsPtr(slots);
+}
+
+//! Slots outlive their threads so that their counts stay in the totals.
+struct Registry
+{
+	std::mutex				mutex;
+	std::vector<SlotsPtr>	threads;
+}; // struct Registry
+
+Registry &registry()
+{
+	static Registry s_registry;
+	return s_registry;
+}
+
+ThreadSlots *thread_slots() noexcept
+{
+	static thread_local ThreadSlots *s_slots = nullptr;
+	if ( !s_slots ) {
+		try {
+			SlotsPtr slots(allocate_slots());
+			Registry &registry_(registry());
+			std::lock_guard<std::mutex> lock(registry_.mutex);
+			registry_.threads.push_back(std::move(slots));
+			s_slots = registry_.threads.back().get();
+		}
+		catch ( ... ) {
+			return nullptr;
+		}
+	}
+	return s_slots;
+}
+
+std::size_t bucket_of(std::uint64_t nanoseconds) noexcept
+{
+	std::size_t bucket = 0;
+	while ( (nanoseconds >>= 1) != 0 && bucket + 1 < clangxx::stats::histogram_size ) {
+		++bucket;
+	}
+	return bucket;
+}
+
+#endif // defined CLANGXX_ENABLE_STATS
+
+} // namespace
+
+namespace clangxx {
+namespace stats {
+
+const char *name(Counter counter) noexcept
+{
+	const std::size_t index = static_cast<std::size_t>(counter);
+	return index < counter_count ? s_names[index] : "";
+}
+
+std::vector<Entry> snapshot()
+{
+	std::vector<Entry> entries;
+#if defined CLANGXX_ENABLE_STATS
+	entries.resize(counter_count);
+	for ( std::size_t i = 0; i < counter_count; ++i ) {
+		entries[i] = Entry{s_names[i], 0, 0, 0, 0, {}};
+	}
+
+	Registry &registry_(registry());
+	std::lock_guard<std::mutex> lock(registry_.mutex);
+	for ( const auto &thread : registry_.threads ) {
+		for ( std::size_t i = 0; i < counter_count; ++i ) {
+			const Slot &slot = thread->slots[i];
+			Entry &entry = entries[i];
+			entry.calls += slot.calls.load(std::memory_order_relaxed);
+			entry.hits += slot.hits.load(std::memory_order_relaxed);
+			entry.misses += slot.misses.load(std::memory_order_relaxed);
+			entry.total_nanoseconds += slot.total_nanoseconds.load(std::memory_order_relaxed);
+			for ( std::size_t bucket = 0; bucket < histogram_size; ++bucket ) {
+				entry.histogram[bucket] += slot.histogram[bucket].load(std::memory_order_relaxed);
+			}
+		}
+	}
+#endif
+	return entries;
+}
+
+void write(std::ostream &ostream)
+{
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-32s %12s %12s %10s %12s\n",
+				  "counter", "calls", "mean ns", "memo hit%", "p50 <= ns");
+	ostream << line;
+	for ( const auto &entry : snapshot() ) {
+		if ( entry.calls == 0 && entry.hits + entry.misses == 0 ) {
+			continue;
+		}
+
+		const std::uint64_t memo = entry.hits + entry.misses;
+		char hit_rate[16] = "-";
+		if ( memo != 0 ) {
+			std::snprintf(hit_rate, sizeof(hit_rate), "%.1f", 100.0 * entry.hits / memo);
+		}
+		// upper bound of the bucket holding the median
+		std::uint64_t median = 0, seen = 0;
+		for ( std::size_t bucket = 0; bucket < histogram_size; ++bucket ) {
+			seen += entry.histogram[bucket];
+			if ( seen * 2 >= entry.calls ) {
+				median = (std::uint64_t(2) << bucket) - 1;
+				break;
+			}
+		}
+
+		std::snprintf(line, sizeof(line), "%-32s %12llu %12.0f %10s %12llu\n",
+					  entry.name, static_cast<unsigned long long>(entry.calls),
+					  entry.calls ? static_cast<double>(entry.total_nanoseconds) / entry.calls : 0.0,
+					  hit_rate, static_cast<unsigned long long>(median));
+		ostream << line;
+	}
+}
+
+void reset()
+{
+#if defined CLANGXX_ENABLE_STATS
+	Registry &registry_(registry());
+	std::lock_guard<std::mutex> lock(registry_.mutex);
+	for ( const auto &thread : registry_.threads ) {
+		thread->reset();
+	}
+#endif
+}
+
+namespace detail {
+
+void record_call(Counter counter, std::uint64_t nanoseconds) noexcept
+{
+#if defined CLANGXX_ENABLE_STATS
+	if ( ThreadSlots *slots = thread_slots() ) {
+		Slot &slot = slots->slots[static_cast<std::size_t>(counter)];
+		increment(slot.calls);
+		increment(slot.total_nanoseconds, nanoseconds);
+		increment(slot.histogram[bucket_of(nanoseconds)]);
+	}
+#else
+	static_cast<void>(counter);
+	static_cast<void>(nanoseconds);
+#endif
+}
+
+void record_memo(Counter counter, bool hit) noexcept
+{
+#if defined CLANGXX_ENABLE_STATS
+	if ( ThreadSlots *slots = thread_slots() ) {
+		Slot &slot = slots->slots[static_cast<std::size_t>(counter)];
+		increment(hit ? slot.hits : slot.misses);
+	}
+#else
+	static_cast<void>(counter);
+	static_cast<void>(hit);
+#endif
+}
+
+} // namespace detail
+
+} // namespace stats
+} // namespace clangxx
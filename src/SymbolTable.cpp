@@ -0,0 +1,49 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file SymbolTable.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/SymbolTable.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+
+namespace clangxx {
+
+const SymbolTable::Id	SymbolTable::invalid_id;
+
+SymbolTable::SymbolTable() = default;
+
+SymbolTable::~SymbolTable() = default;
+
+SymbolTable::SymbolTable(const SymbolTable &/*other*/) = default;
+SymbolTable::SymbolTable(SymbolTable &&/*other*/) noexcept = default;
+
+SymbolTable &SymbolTable::operator=(const SymbolTable &/*other*/) = default;
+SymbolTable &SymbolTable::operator=(SymbolTable &&/*other*/) noexcept = default;
+
+SymbolTable::Id SymbolTable::intern(const std::string &name)
+{
+	const auto result = m_ids.emplace(name, static_cast<Id>(m_names.size()));
+	if ( result.second ) {
+		m_names.push_back(name);
+	}
+	return result.first->second;
+}
+
+SymbolTable::Id SymbolTable::find(const std::string &name) const
+{
+	const auto iter = m_ids.find(name);
+	return (iter != m_ids.end()) ? iter->second : invalid_id;
+}
+
+void SymbolTable::reserve(std::size_t size)
+{
+	m_names.reserve(size);
+	m_ids.reserve(size);
+}
+
+} // namespace clangxx
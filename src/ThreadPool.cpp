@@ -0,0 +1,83 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file ThreadPool.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/ThreadPool.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+
+namespace clangxx {
+
+ThreadPool::ThreadPool(unsigned int thread_count/* = 0*/)
+{
+	if ( thread_count == 0 ) {
+		thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	m_threads.reserve(thread_count);
+	for ( unsigned int i{0}; i < thread_count; ++i ) {
+		m_threads.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_task_ready.notify_all();
+	for ( auto &thread : m_threads ) {
+		thread.join();
+	}
+}
+
+void ThreadPool::submit(Task task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::move(task));
+	}
+	m_task_ready.notify_one();
+}
+
+void ThreadPool::wait_idle()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this] { return m_tasks.empty() && m_running == 0; });
+}
+
+void ThreadPool::work()
+{
+	for ( ;; ) {
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_task_ready.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+			if ( m_tasks.empty() ) {
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+			++m_running;
+		}
+
+		try {
+			task();
+		}
+		catch ( ... ) {
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if ( --m_running == 0 && m_tasks.empty() ) {
+			m_idle.notify_all();
+		}
+	}
+}
+
+} // namespace clangxx
@@ -0,0 +1,262 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Trace.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-cpp/Exception.hpp"
+
+
+namespace {
+
+using Clock	= std::chrono::steady_clock;
+
+struct Event
+{
+	const char		*category;
+	const char		*name;
+	std::int64_t	begin;
+	std::int64_t	duration;
+	std::string		argument;
+}; // struct Event
+
+//! Events are appended by the owning thread and published by `size`.
+struct Chunk
+{
+	static const std::size_t	capacity	= 1024;
+
+	Event						events[capacity];
+	std::atomic<std::size_t>	size{0};
+	std::atomic<Chunk *>		next{nullptr};
+}; // struct Chunk
+
+struct ThreadBuffer
+{
+	unsigned int			id;
+	std::unique_ptr<Chunk>	head;
+	//! written by the owning thread only.
+	Chunk					*tail;
+
+	explicit ThreadBuffer(unsigned int id_)
+		: id(id_)
+		, head(new Chunk)
+		, tail(head.get())
+	{}
+
+	~ThreadBuffer() {
+		free_chain(head->next.exchange(nullptr));
+	}
+
+	void append(Event &&event) {
+		std::size_t size = tail->size.load(std::memory_order_relaxed);
+		if ( size == Chunk::capacity ) {
+			Chunk *chunk = new Chunk;
+			tail->next.store(chunk, std::memory_order_release);
+			tail = chunk;
+			size = 0;
+		}
+		tail->events[size] = std::move(event);
+		tail->size.store(size + 1, std::memory_order_release);
+	}
+
+	void clear() {
+		free_chain(head->next.exchange(nullptr));
+		head->size.store(0);
+		tail = head.get();
+	}
+
+	static void free_chain(Chunk *chunk) {
+		while ( chunk ) {
+			Chunk *next = chunk->next.load();
+			delete chunk;
+			chunk = next;
+		}
+	}
+}; // struct ThreadBuffer
+
+//! Buffers outlive their threads so that a trace can be written at any time.
+struct Registry
+{
+	std::mutex									mutex;
+	std::vector<std::unique_ptr<ThreadBuffer>>	buffers;
+	const Clock::time_point						epoch{Clock::now()};
+}; // struct Registry
+
+std::atomic<bool>	s_enabled{false};
+
+Registry &registry()
+{
+	static Registry s_registry;
+	return s_registry;
+}
+
+std::int64_t now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		Clock::now() - registry().epoch).count();
+}
+
+ThreadBuffer &thread_buffer()
+{
+	static thread_local ThreadBuffer *s_buffer = nullptr;
+	if ( !s_buffer ) {
+		Registry &registry_(registry());
+		std::lock_guard<std::mutex> lock(registry_.mutex);
+		registry_.buffers.emplace_back(
+			new ThreadBuffer(static_cast<unsigned int>(registry_.buffers.size() + 1)));
+		s_buffer = registry_.buffers.back().get();
+	}
+	return *s_buffer;
+}
+
+void write_escaped(std::ostream &ostream, const char *string)
+{
+	static const char hex[] = "0123456789abcdef";
+	ostream << '"';
+	for ( ; *string; ++string ) {
+		const unsigned char c = static_cast<unsigned char>(*string);
+		if ( c == '"' || c == '\\' ) {
+			ostream << '\\' << *string;
+		}
+		else if ( c < 0x20 ) {
+			ostream << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+		}
+		else {
+			ostream << *string;
+		}
+	}
+	ostream << '"';
+}
+
+//! Nanoseconds as fractional microseconds, the unit of trace events.
+void write_microseconds(std::ostream &ostream, std::int64_t nanoseconds)
+{
+	char buffer[32];
+	std::snprintf(buffer, sizeof(buffer), "%lld.%03lld",
+				  static_cast<long long>(nanoseconds / 1000),
+				  static_cast<long long>(nanoseconds % 1000));
+	ostream << buffer;
+}
+
+} // namespace
+
+namespace clangxx {
+namespace trace {
+
+void enable(bool enabled/* = true*/) noexcept
+{
+	s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool enabled() noexcept
+{
+	return s_enabled.load(std::memory_order_relaxed);
+}
+
+void write(std::ostream &ostream)
+{
+	Registry &registry_(registry());
+	std::lock_guard<std::mutex> lock(registry_.mutex);
+
+	ostream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	for ( const auto &buffer : registry_.buffers ) {
+		ostream << (first ? "" : ",")
+				<< "\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->id
+				<< ",\"args\":{\"name\":\"thread " << buffer->id << "\"}}";
+		first = false;
+
+		for ( const Chunk *chunk = buffer->head.get(); chunk;
+			  chunk = chunk->next.load(std::memory_order_acquire) ) {
+			const std::size_t size = chunk->size.load(std::memory_order_acquire);
+			for ( std::size_t i = 0; i < size; ++i ) {
+				const Event &event = chunk->events[i];
+				ostream << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"cat\":";
+				write_escaped(ostream, event.category);
+				ostream << ",\"name\":";
+				write_escaped(ostream, event.name);
+				ostream << ",\"ts\":";
+				write_microseconds(ostream, event.begin);
+				ostream << ",\"dur\":";
+				write_microseconds(ostream, event.duration);
+				if ( !event.argument.empty() ) {
+					ostream << ",\"args\":{\"name\":";
+					write_escaped(ostream, event.argument.c_str());
+					ostream << '}';
+				}
+				ostream << '}';
+			}
+		}
+	}
+	ostream << "\n]}\n";
+}
+
+void write(const std::string &path)
+{
+	std::ofstream ostream(path, std::ios::binary | std::ios::trunc);
+	if ( !ostream ) {
+		CLANGXX_THROW_RuntimeError("Error opening " + path);
+	}
+	write(ostream);
+	if ( !ostream.flush() ) {
+		CLANGXX_THROW_RuntimeError("Error writing the trace.");
+	}
+}
+
+void clear()
+{
+	Registry &registry_(registry());
+	std::lock_guard<std::mutex> lock(registry_.mutex);
+	for ( const auto &buffer : registry_.buffers ) {
+		buffer->clear();
+	}
+}
+
+Span::Span(const char *category, const char *name) noexcept
+	: m_category(category)
+	, m_name(name)
+	, m_argument()
+	, m_begin(0)
+	, m_active(enabled())
+{
+	if ( m_active ) {
+		m_begin = now();
+	}
+}
+
+Span::Span(const char *category, const char *name, const std::string &argument)
+	: Span(category, name)
+{
+	if ( m_active ) {
+		m_argument = argument;
+	}
+}
+
+Span::~Span()
+{
+	if ( m_active ) {
+		const std::int64_t end = now();
+		try {
+			thread_buffer().append(Event{m_category, m_name, m_begin, end - m_begin, std::move(m_argument)});
+		}
+		catch ( ... ) {
+			// out of memory: the span is lost
+		}
+	}
+}
+
+} // namespace trace
+} // namespace clangxx
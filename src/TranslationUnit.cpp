@@ -8,22 +8,96 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <iterator>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "clang-c/CXString.h"
 #include "clang-cpp/Exception.hpp"
 #include "clang-cpp/File.hpp"
+#include "clang-cpp/FileTable.hpp"
 #include "clang-cpp/Index.hpp"
+#include "clang-cpp/ModuleCache.hpp"
+#include "clang-cpp/ScopeNameTable.hpp"
+#include "clang-cpp/Stats.hpp"
+#include "clang-cpp/Trace.hpp"
 #include "clang-cpp/memory.hpp"
 #include "clang-cpp/UniqueCXObject.hpp"
 //clang-cpp/Exception.hpp
 //clang-cpp/SourceLocation.hpp
 
 
+namespace {
+
+/*!
+  @return the AST files of the modules the top-level declarations of
+  @a cx_translation_unit come from, imported or not.
+*/
+std::vector<std::string> loaded_modules(CXTranslationUnit cx_translation_unit)
+{
+	struct Data
+	{
+		CXTranslationUnit			cx_translation_unit;
+		std::unordered_set<CXFile>	files;
+		std::vector<CXModule>		modules;
+		std::exception_ptr			exception;
+	} data{cx_translation_unit, {}, {}, nullptr};
+
+	clang_visitChildren(
+		clang_getTranslationUnitCursor(cx_translation_unit),
+		[](CXCursor cx_cursor, CXCursor /*parent*/, CXClientData client_data) {
+			auto &data = *static_cast<Data *>(client_data);
+			try {
+				CXModule cx_module = nullptr;
+				if ( clang_getCursorKind(cx_cursor) == CXCursor_ModuleImportDecl ) {
+					cx_module = clang_Cursor_getModule(cx_cursor);
+				}
+				else {
+					CXFile cx_file = nullptr;
+					clang_getFileLocation(clang_getCursorLocation(cx_cursor),
+										  &cx_file, nullptr, nullptr, nullptr);
+					if ( !cx_file || !data.files.insert(cx_file).second ) {
+						return CXChildVisit_Continue;
+					}
+					cx_module = clang_getModuleForFile(data.cx_translation_unit, cx_file);
+				}
+				if ( cx_module ) {
+					data.modules.push_back(cx_module);
+				}
+				return CXChildVisit_Continue;
+			}
+			catch ( ... ) {
+				data.exception = std::current_exception();
+				return CXChildVisit_Break;
+			}
+		},
+		&data);
+	if ( data.exception ) {
+		std::rethrow_exception(data.exception);
+	}
+
+	std::vector<std::string> result;
+	for ( CXModule cx_module : data.modules ) {
+		CXFile cx_ast_file = clang_Module_getASTFile(cx_module);
+		if ( !cx_ast_file ) {
+			continue;
+		}
+		clangxx::UniqueCXString cx_name(clang_getFileName(cx_ast_file));
+		if ( cx_name ) {
+			result.push_back(clang_getCString(cx_name.get()));
+		}
+	}
+	std::sort(result.begin(), result.end());
+	result.erase(std::unique(result.begin(), result.end()), result.end());
+	return result;
+}
+
+} // namespace
+
 namespace clangxx {
 
 class TranslationUnit::Impl
@@ -35,10 +109,22 @@ class TranslationUnit::Impl
 	  CXTranslationUnit_Flags options,
 	  std::shared_ptr<Index> &index)
 	{
-		std::vector<const char *> args_array; args_array.reserve(args.size());
+		CLANGXX_STATS_CALL(TranslationUnit_from_source);
+		trace::Span span("parse", "from_source", filename);
+		const auto module_cache = index->module_cache();
+		std::vector<std::string> module_args;
+		if ( module_cache ) {
+			module_args = module_cache->arguments();
+		}
+
+		std::vector<const char *> args_array;
+		args_array.reserve(args.size() + module_args.size());
 		for ( const auto &arg : args ) {
 			args_array.push_back(arg.c_str());
 		}
+		for ( const auto &arg : module_args ) {
+			args_array.push_back(arg.c_str());
+		}
 
 		std::vector<CXUnsavedFile> unsaved_array;
 		unsaved_array.reserve(unsaved_files.size());
@@ -68,13 +154,20 @@ class TranslationUnit::Impl
 			CLANGXX_THROW_TranslationUnitLoadError("Error parsing translation unit.");
 		}
 
-//		return make_shared<TranslationUnit>(std::move(ptr), index);
-		return std::shared_ptr<TranslationUnit>(new TranslationUnit(std::move(ptr), index));
+//		auto result = make_shared<TranslationUnit>(std::move(ptr), index);
+		std::shared_ptr<TranslationUnit> result(new TranslationUnit(std::move(ptr), index));
+		// prune once the new translation unit has retained its module files
+		if ( module_cache ) {
+			module_cache->note_parse();
+		}
+		return result;
 	}
 
 	static std::shared_ptr<TranslationUnit> from_ast_file(
 	  const std::string &filename, std::shared_ptr<Index> &index)
 	{
+		CLANGXX_STATS_CALL(TranslationUnit_from_ast_file);
+		trace::Span span("parse", "from_ast_file", filename);
 		UniqueCXTranslationUnit ptr(clang_createTranslationUnit(
 									index->native_handle(), filename.c_str()));
 		if ( !ptr ) {
@@ -89,18 +182,46 @@ class TranslationUnit::Impl
 	std::shared_ptr<const Index>	m_index;
 	// warning: define m_index before m_cx_translation_unit
 	UniqueCXTranslationUnit	m_cx_translation_unit;
+	// warning: define m_cx_translation_unit before m_file_table
+	mutable FileTable		m_file_table;
+	mutable ScopeNameTable	m_scope_names;
+	const std::shared_ptr<ModuleCache>	m_module_cache;
+	//! module files retained in m_module_cache
+	std::vector<std::string>	m_module_files;
 
   public:
-	Impl(UniqueCXTranslationUnit &&ptr, std::shared_ptr<const Index> &index) noexcept
+	Impl(UniqueCXTranslationUnit &&ptr, std::shared_ptr<const Index> &index)
 		: m_index(index)
 		, m_cx_translation_unit(std::move(ptr))
-	{}
+		, m_file_table(m_cx_translation_unit.get())
+		, m_module_cache(index->module_cache())
+	{
+		if ( m_module_cache ) {
+			m_module_files = m_module_cache->retain(
+				loaded_modules(m_cx_translation_unit.get()));
+		}
+	}
+
+	~Impl()
+	{
+		if ( m_module_cache ) {
+			m_module_cache->release(m_module_files);
+		}
+	}
 
   public:
 	CXTranslationUnit native_handle() const noexcept {
 		return m_cx_translation_unit.get();
 	}
 
+	FileTable &file_table() const noexcept {
+		return m_file_table;
+	}
+
+	ScopeNameTable &scope_names() const noexcept {
+		return m_scope_names;
+	}
+
 	std::string spelling() const {
 		UniqueCXString cx_string(clang_getTranslationUnitSpelling(
 								 m_cx_translation_unit.get()));
@@ -114,6 +235,11 @@ class TranslationUnit::Impl
 	void reparse(const std::vector<UnsavedFile> &unsaved_files,
 				 CXTranslationUnit_Flags options)
 	{
+		CLANGXX_STATS_CALL(TranslationUnit_reparse);
+		trace::Span span("parse", "reparse");
+		if ( span ) {
+			span.set_argument(spelling());
+		}
 		std::vector<CXUnsavedFile> unsaved_array;
 		unsaved_array.reserve(unsaved_files.size());
 		std::vector<std::string> contents_array;
@@ -140,9 +266,20 @@ class TranslationUnit::Impl
 		if ( error_code != 0 ) {
 			CLANGXX_THROW_TranslationUnitLoadError("Error reparsing translation unit.");
 		}
+		m_file_table.clear();
+		m_scope_names.clear();
+
+		if ( m_module_cache ) {
+			auto module_files = m_module_cache->retain(
+				loaded_modules(m_cx_translation_unit.get()));
+			m_module_cache->release(m_module_files);
+			m_module_files = std::move(module_files);
+		}
 	}
 
 	void save(const std::string &filename) {
+		CLANGXX_STATS_CALL(TranslationUnit_save);
+		trace::Span span("parse", "save", filename);
 		const auto options = clang_defaultSaveOptions(m_cx_translation_unit.get());
 		const int result{clang_saveTranslationUnit(
 			  m_cx_translation_unit.get(), filename.c_str(), options)};
@@ -201,6 +338,16 @@ CXTranslationUnit TranslationUnit::native_handle() const noexcept
 	return m_impl->native_handle();
 }
 
+FileTable &TranslationUnit::file_table() const
+{
+	return m_impl->file_table();
+}
+
+ScopeNameTable &TranslationUnit::scope_names() const
+{
+	return m_impl->scope_names();
+}
+
 std::string TranslationUnit::spelling() const
 {
 	return m_impl->spelling();
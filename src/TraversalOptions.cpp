@@ -0,0 +1,71 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file TraversalOptions.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/TraversalOptions.hpp"
+
+#include "clang-c/Index.h"
+#include "clang-cpp/FileUniqueID.hpp"
+#include "clang-cpp/HeaderDeduplicator.hpp"
+
+
+namespace clangxx {
+
+LocationFilter::LocationFilter(const TraversalOptions &options,
+							   CXTranslationUnit cx_translation_unit)
+	: m_options(options)
+	, m_cx_translation_unit(cx_translation_unit)
+{}
+
+bool LocationFilter::accepts(CXCursor cx_cursor, CXCursor cx_parent)
+{
+	if ( m_options.filters_locations() ) {
+		const CXSourceLocation location(clang_getCursorLocation(cx_cursor));
+		CXFile cx_file{nullptr};
+		clang_getExpansionLocation(location, &cx_file, nullptr, nullptr, nullptr);
+		if ( cx_file != m_last_file || !m_last_file ) {
+			m_last_decision = accepts_file(cx_file, location);
+			m_last_file = cx_file;
+		}
+		if ( !m_last_decision ) {
+			return false;
+		}
+	}
+
+	if ( m_options.header_deduplicator && (cx_parent.kind == CXCursor_TranslationUnit) ) {
+		return m_options.header_deduplicator->should_visit(
+			m_cx_translation_unit, cx_cursor, m_header_decisions);
+	}
+	return true;
+}
+
+bool LocationFilter::accepts_file(CXFile cx_file, const CXSourceLocation &location)
+{
+	if ( !cx_file ) {
+		return !m_options.main_file_only && m_options.allowed_files.empty();
+	}
+
+	const auto iter = m_decisions.find(cx_file);
+	if ( iter != m_decisions.end() ) {
+		return iter->second;
+	}
+
+	bool accepted{true};
+	if ( m_options.main_file_only && !clang_Location_isFromMainFile(location) ) {
+		accepted = false;
+	}
+	else if ( m_options.exclude_system_headers && clang_Location_isInSystemHeader(location) ) {
+		accepted = false;
+	}
+	else if ( !m_options.allowed_files.empty() ) {
+		CXFileUniqueID cx_file_unique_id;
+		accepted = (clang_getFileUniqueID(cx_file, &cx_file_unique_id) == 0)
+			&& (m_options.allowed_files.count(FileUniqueID(cx_file_unique_id)) != 0);
+	}
+	m_decisions.emplace(cx_file, accepted);
+	return accepted;
+}
+
+} // namespace clangxx
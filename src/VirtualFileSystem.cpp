@@ -0,0 +1,225 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file VirtualFileSystem.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/VirtualFileSystem.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <unistd.h>
+	#if defined __linux__
+		#include <sys/syscall.h>
+		#if !defined MFD_CLOEXEC
+			// from <linux/memfd.h>, which older C libraries do not include
+			#define MFD_CLOEXEC	0x0001U
+		#endif
+	#endif
+#endif
+#include "clang-c/BuildSystem.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace {
+
+bool write_all(int descriptor, const std::string &data)
+{
+#if defined _WIN32
+	(void)descriptor; (void)data;
+	return false;
+#else
+	const char *p = data.data();
+	std::size_t rest = data.size();
+	while ( rest > 0 ) {
+		const ssize_t written = ::write(descriptor, p, rest);
+		if ( written <= 0 ) {
+			return false;
+		}
+		p += written;
+		rest -= static_cast<std::size_t>(written);
+	}
+	return true;
+#endif
+}
+
+} // namespace
+
+namespace clangxx {
+
+VirtualFileSystem::VirtualFileSystem()
+	: m_cx_overlay(clang_VirtualFileOverlay_create(0))
+{
+	if ( !m_cx_overlay ) {
+		CLANGXX_THROW_RuntimeError("Error creating a virtual file overlay.");
+	}
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+#if !defined _WIN32
+	for ( const int descriptor : m_descriptors ) {
+		::close(descriptor);
+	}
+#endif
+	for ( const auto &path : m_temporary_files ) {
+		std::remove(path.c_str());
+	}
+}
+
+VirtualFileSystem::VirtualFileSystem(VirtualFileSystem &&/*other*/) noexcept = default;
+
+VirtualFileSystem &VirtualFileSystem::operator=(VirtualFileSystem &&other) noexcept
+{
+	// the descriptors and files of this object are released by other
+	std::swap(m_cx_overlay, other.m_cx_overlay);
+	m_contents.swap(other.m_contents);
+	m_overlay_path.swap(other.m_overlay_path);
+	m_descriptors.swap(other.m_descriptors);
+	m_temporary_files.swap(other.m_temporary_files);
+	m_mapping_count = other.m_mapping_count;
+	return *this;
+}
+
+void VirtualFileSystem::map_file(const std::string &virtual_path, const std::string &real_path)
+{
+	if ( clang_VirtualFileOverlay_addFileMapping(m_cx_overlay.get(), virtual_path.c_str(),
+												  real_path.c_str()) != CXError_Success )
+	{
+		CLANGXX_THROW_LogicError("Error mapping a virtual file; both paths must be absolute.");
+	}
+	++m_mapping_count;
+	m_overlay_path.clear();
+}
+
+void VirtualFileSystem::add_file(const std::string &virtual_path, std::string contents)
+{
+	for ( auto &content : m_contents ) {
+		if ( content.first == virtual_path ) {
+			content.second = std::move(contents);
+			return;
+		}
+	}
+	m_contents.emplace_back(virtual_path, std::move(contents));
+}
+
+void VirtualFileSystem::set_case_sensitive(bool case_sensitive)
+{
+	if ( clang_VirtualFileOverlay_setCaseSensitivity(m_cx_overlay.get(), case_sensitive ? 1 : 0)
+		 != CXError_Success )
+	{
+		CLANGXX_THROW_LogicError("Error setting the case sensitivity of a virtual file overlay.");
+	}
+	m_overlay_path.clear();
+}
+
+std::string VirtualFileSystem::yaml() const
+{
+	char *buffer = nullptr;
+	unsigned int size = 0;
+	if ( clang_VirtualFileOverlay_writeToBuffer(m_cx_overlay.get(), 0, &buffer, &size)
+		 != CXError_Success )
+	{
+		CLANGXX_THROW_RuntimeError("Error writing a virtual file overlay.");
+	}
+
+	// allocated with malloc(); this version of libclang has no clang_free()
+	std::unique_ptr<char, void (*)(void *)> holder(buffer, &std::free);
+	return std::string(buffer, size);
+}
+
+std::vector<std::string> VirtualFileSystem::arguments()
+{
+	std::vector<std::string> result;
+	if ( m_mapping_count == 0 ) {
+		return result;
+	}
+	if ( m_overlay_path.empty() ) {
+		m_overlay_path = materialize(yaml());
+	}
+
+	result.push_back("-ivfsoverlay");
+	result.push_back(m_overlay_path);
+	return result;
+}
+
+std::vector<UnsavedFile> VirtualFileSystem::unsaved_files() const
+{
+	std::vector<UnsavedFile> result;
+	result.reserve(m_contents.size());
+	for ( const auto &content : m_contents ) {
+		UnsavedFile unsaved_file;
+		unsaved_file.filename = content.first;
+		unsaved_file.contents.reset(new std::istringstream(content.second));
+		result.push_back(std::move(unsaved_file));
+	}
+	return result;
+}
+
+std::string VirtualFileSystem::materialize(const std::string &yaml)
+{
+	// earlier overlays stay open: translation units parsed with them reread
+	// the overlay when they are reparsed; child processes do not inherit them
+#if defined __linux__ && defined SYS_memfd_create
+	const int memory_file = static_cast<int>(
+		::syscall(SYS_memfd_create, "clangxx-vfsoverlay", MFD_CLOEXEC));
+	if ( memory_file >= 0 ) {
+		if ( write_all(memory_file, yaml) ) {
+			m_descriptors.push_back(memory_file);
+			return "/proc/self/fd/" + std::to_string(memory_file);
+		}
+		::close(memory_file);
+	}
+#endif
+
+	std::string path;
+#if defined _WIN32
+	char directory[MAX_PATH + 1];
+	char filename[MAX_PATH + 1];
+	if ( ::GetTempPathA(sizeof(directory), directory) == 0
+		 || ::GetTempFileNameA(directory, "vfs", 0, filename) == 0 )
+	{
+		CLANGXX_THROW_RuntimeError("Error creating a temporary virtual file overlay.");
+	}
+	path = filename;
+	std::ofstream ostream(path.c_str(), std::ios::binary);
+	ostream << yaml;
+	if ( !ostream.flush() ) {
+		std::remove(path.c_str());
+		CLANGXX_THROW_RuntimeError("Error writing a temporary virtual file overlay.");
+	}
+#else
+	const char *directory = std::getenv("TMPDIR");
+	path = std::string((directory && *directory) ? directory : "/tmp") + "/clangxx-vfsoverlay-XXXXXX";
+	std::vector<char> buffer(path.begin(), path.end());
+	buffer.push_back('\0');
+	const int descriptor = ::mkstemp(buffer.data());
+	if ( descriptor < 0 ) {
+		CLANGXX_THROW_RuntimeError("Error creating a temporary virtual file overlay.");
+	}
+	path = buffer.data();
+	const bool written = write_all(descriptor, yaml);
+	::close(descriptor);
+	if ( !written ) {
+		std::remove(path.c_str());
+		CLANGXX_THROW_RuntimeError("Error writing a temporary virtual file overlay.");
+	}
+#endif
+	m_temporary_files.push_back(path);
+	return path;
+}
+
+} // namespace clangxx
@@ -0,0 +1,31 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file VisitedCursorSet.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/VisitedCursorSet.hpp"
+
+#include <utility>
+#include "clang-c/Index.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+
+
+namespace clangxx {
+
+VisitedCursorSet::VisitedCursorSet()
+	: m_cx_cursor_set(clang_createCXCursorSet())
+{
+	if ( !m_cx_cursor_set ) {
+		CLANGXX_THROW_LogicError("Error creating cursor set.");
+	}
+}
+
+VisitedCursorSet::~VisitedCursorSet() = default;
+
+VisitedCursorSet::VisitedCursorSet(VisitedCursorSet &&/*other*/) noexcept = default;
+
+VisitedCursorSet &VisitedCursorSet::operator=(VisitedCursorSet &&/*other*/) noexcept = default;
+
+} // namespace clangxx
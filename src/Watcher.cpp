@@ -0,0 +1,559 @@
+// -*- tab-width: 4 -*-
+/*!
+   @file Watcher.cpp
+
+   Copyright (c) 2015 pegacorn
+*/
+#include "clang-cpp/Watcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "clang-c/Index.h"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/ThreadPool.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+#include "clang-cpp/UniqueCXObject.hpp"
+#if defined __linux__
+	#include <cerrno>
+	#include <dirent.h>
+	#include <poll.h>
+	#include <sys/eventfd.h>
+	#include <sys/inotify.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+namespace {
+
+using Clock	= std::chrono::steady_clock;
+
+//! @a path made absolute, with symbolic links resolved as far as it exists.
+std::string normalize(const std::string &path)
+{
+#if defined _WIN32
+	char buffer[_MAX_PATH];
+	return _fullpath(buffer, path.c_str(), sizeof(buffer)) ? buffer : path;
+#else
+	char buffer[PATH_MAX];
+	if ( realpath(path.c_str(), buffer) ) {
+		return buffer;
+	}
+	// a deleted file: resolve its directory
+	const std::string::size_type slash = path.rfind('/');
+	const std::string directory(slash == std::string::npos ? "." : path.substr(0, slash));
+	if ( slash != 0 && realpath(directory.c_str(), buffer) ) {
+		return std::string(buffer) + '/' + path.substr(slash + 1);
+	}
+	return path;
+#endif
+}
+
+void collect_inclusion(CXFile included_file, CXSourceLocation * /*inclusion_stack*/,
+					   unsigned int /*include_len*/, CXClientData client_data)
+{
+	clangxx::UniqueCXString name(clang_getFileName(included_file));
+	if ( name && clang_getCString(name.get()) ) {
+		static_cast<std::vector<std::string> *>(client_data)->push_back(
+			normalize(clang_getCString(name.get())));
+	}
+}
+
+//! Normalized paths of the main file and the files included by @a translation_unit.
+std::vector<std::string> files_of(const clangxx::TranslationUnit &translation_unit)
+{
+	std::vector<std::string> files;
+	clang_getInclusions(translation_unit.native_handle(), &collect_inclusion, &files);
+	files.push_back(normalize(translation_unit.spelling()));
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+	return files;
+}
+
+struct Entry
+{
+	std::shared_ptr<clangxx::TranslationUnit>	translation_unit;
+	std::vector<std::string>	files;
+	//! being reparsed by a worker.
+	bool						running{false};
+	//! changed again since the running reparse began.
+	bool						pending{false};
+}; // struct Entry
+
+} // namespace
+
+namespace clangxx {
+
+class Watcher::Impl
+{
+  private:
+	const Options		m_options;
+	std::mutex			m_mutex;
+	std::condition_variable	m_changed;
+	std::condition_variable	m_idle;
+	Callback			m_callback;
+	bool				m_running{false};
+	bool				m_stopping{false};
+
+	std::unordered_map<const TranslationUnit *, std::shared_ptr<Entry>>	m_entries;
+	//! file -> translation units including it.
+	std::unordered_map<std::string, std::unordered_set<Entry *>>			m_dependents;
+
+	std::unordered_set<std::string>	m_changes;
+	//! every watched translation unit must be reparsed (events were lost).
+	bool				m_overflow{false};
+	Clock::time_point	m_first_change;
+	Clock::time_point	m_last_change;
+	bool				m_burst{false};
+	std::size_t			m_active{0};
+
+	std::thread			m_debouncer;
+#if defined __linux__
+	int					m_inotify{-1};
+	int					m_wakeup{-1};
+	struct Directory
+	{
+		std::string	path;
+		bool		recursive;
+	}; // struct Directory
+	std::unordered_map<int, Directory>	m_directories;
+	std::thread			m_reader;
+#endif
+	// destroyed first: its tasks use the members above
+	ThreadPool			m_pool;
+
+  public:
+	explicit Impl(const Options &options)
+		: m_options(options)
+		, m_pool(options.thread_count)
+	{}
+
+	~Impl() {
+		stop();
+#if defined __linux__
+		if ( m_inotify >= 0 ) {
+			::close(m_inotify);
+			::close(m_wakeup);
+		}
+#endif
+	}
+
+  public:
+	void add_directory(const std::string &path, bool recursive) {
+#if defined __linux__
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if ( m_inotify < 0 ) {
+			m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if ( m_inotify < 0 ) {
+				CLANGXX_THROW_RuntimeError(std::string("Error initializing inotify: ") + std::strerror(errno));
+			}
+			m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if ( m_wakeup < 0 ) {
+				const int error = errno;
+				::close(m_inotify);
+				m_inotify = -1;
+				CLANGXX_THROW_RuntimeError(std::string("Error creating an eventfd: ") + std::strerror(error));
+			}
+			if ( m_running && !m_stopping ) {
+				// start() had no descriptor to read yet
+				m_reader = std::thread(&Impl::read_loop, this);
+			}
+		}
+		if ( !add_watch(normalize(path), recursive) ) {
+			CLANGXX_THROW_RuntimeError("Error watching " + path + ": " + std::strerror(errno));
+		}
+#else
+		(void)recursive;
+		CLANGXX_THROW_RuntimeError("Directory watching is not supported on this system: " + path);
+#endif
+	}
+
+	void watch(std::shared_ptr<TranslationUnit> translation_unit) {
+		std::vector<std::string> files(files_of(*translation_unit));
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto &entry = m_entries[translation_unit.get()];
+		if ( entry ) {
+			// keep the entry, which may be being reparsed
+			unlink(*entry);
+		}
+		else {
+			entry = std::make_shared<Entry>();
+			entry->translation_unit = std::move(translation_unit);
+		}
+		entry->files = std::move(files);
+		link(*entry);
+	}
+
+	void unwatch(const std::shared_ptr<TranslationUnit> &translation_unit) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const auto found = m_entries.find(translation_unit.get());
+		if ( found != m_entries.end() ) {
+			unlink(*found->second);
+			m_entries.erase(found);
+		}
+	}
+
+	void set_callback(Callback callback) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_callback = std::move(callback);
+	}
+
+	void start() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if ( m_running ) {
+			return;
+		}
+		m_running = true;
+		m_stopping = false;
+		m_debouncer = std::thread(&Impl::debounce_loop, this);
+#if defined __linux__
+		if ( m_inotify >= 0 ) {
+			m_reader = std::thread(&Impl::read_loop, this);
+		}
+#endif
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if ( !m_running ) {
+				return;
+			}
+			m_stopping = true;
+		}
+		m_changed.notify_all();
+#if defined __linux__
+		if ( m_reader.joinable() ) {
+			const std::uint64_t one = 1;
+			while ( ::write(m_wakeup, &one, sizeof(one)) < 0 && errno == EINTR ) {
+			}
+			m_reader.join();
+		}
+#endif
+		m_debouncer.join();
+		m_pool.wait_idle();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_changes.clear();
+		m_overflow = false;
+		m_burst = false;
+		m_running = false;
+		m_idle.notify_all();
+	}
+
+	void notify(const std::string &path) {
+		const std::string normalized(normalize(path));
+		std::lock_guard<std::mutex> lock(m_mutex);
+		note_event();
+		if ( m_dependents.count(normalized) ) {
+			m_changes.insert(normalized);
+		}
+	}
+
+	void wait_idle() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this] {
+				return !m_running || (m_changes.empty() && !m_overflow && m_active == 0);
+			});
+	}
+
+	std::size_t watched_count() {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_entries.size();
+	}
+
+  private:
+	void link(Entry &entry) {
+		for ( const auto &file : entry.files ) {
+			m_dependents[file].insert(&entry);
+		}
+	}
+
+	void unlink(Entry &entry) {
+		for ( const auto &file : entry.files ) {
+			const auto found = m_dependents.find(file);
+			if ( found != m_dependents.end() ) {
+				found->second.erase(&entry);
+				if ( found->second.empty() ) {
+					m_dependents.erase(found);
+				}
+			}
+		}
+	}
+
+	//! Every event, relevant or not, extends the burst.
+	void note_event() {
+		const auto now = Clock::now();
+		if ( !m_burst ) {
+			m_burst = true;
+			m_first_change = now;
+		}
+		m_last_change = now;
+		m_changed.notify_all();
+	}
+
+	void debounce_loop() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while ( !m_stopping ) {
+			if ( !m_burst ) {
+				m_changed.wait(lock);
+				continue;
+			}
+			const auto deadline = std::min(m_last_change + m_options.debounce,
+										   m_first_change + m_options.max_delay);
+			if ( Clock::now() < deadline ) {
+				m_changed.wait_until(lock, deadline);
+				continue;
+			}
+			m_burst = false;
+			flush();
+		}
+	}
+
+	void flush() {
+		std::unordered_set<Entry *> affected;
+		if ( m_overflow ) {
+			for ( const auto &entry : m_entries ) {
+				affected.insert(entry.second.get());
+			}
+		}
+		else {
+			for ( const auto &change : m_changes ) {
+				const auto found = m_dependents.find(change);
+				if ( found != m_dependents.end() ) {
+					affected.insert(found->second.begin(), found->second.end());
+				}
+			}
+		}
+		m_changes.clear();
+		m_overflow = false;
+
+		for ( const auto entry : affected ) {
+			if ( entry->running ) {
+				entry->pending = true;
+				continue;
+			}
+			entry->running = true;
+			++m_active;
+			const auto shared_entry = m_entries.at(entry->translation_unit.get());
+			m_pool.submit([this, shared_entry] { reparse(shared_entry); });
+		}
+		if ( m_active == 0 ) {
+			m_idle.notify_all();
+		}
+	}
+
+	void reparse(const std::shared_ptr<Entry> &entry) {
+		for ( ;; ) {
+			std::exception_ptr error;
+			std::vector<std::string> files;
+			try {
+				entry->translation_unit->reparse();
+				files = files_of(*entry->translation_unit);
+			}
+			catch ( ... ) {
+				error = std::current_exception();
+			}
+
+			Callback callback;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				callback = m_callback;
+				const auto found = m_entries.find(entry->translation_unit.get());
+				if ( !error && found != m_entries.end() && found->second == entry ) {
+					// the inclusions may have changed with the sources
+					unlink(*entry);
+					entry->files = std::move(files);
+					link(*entry);
+				}
+			}
+			if ( callback ) {
+				try {
+					callback(entry->translation_unit, error);
+				}
+				catch ( ... ) {
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if ( entry->pending && !m_stopping ) {
+				entry->pending = false;
+				continue;
+			}
+			entry->pending = false;
+			entry->running = false;
+			if ( --m_active == 0 && m_changes.empty() && !m_overflow ) {
+				m_idle.notify_all();
+			}
+			return;
+		}
+	}
+
+#if defined __linux__
+	bool add_watch(const std::string &path, bool recursive) {
+		const int descriptor = inotify_add_watch(
+			m_inotify, path.c_str(),
+			IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+		if ( descriptor < 0 ) {
+			return false;
+		}
+		m_directories[descriptor] = Directory{path, recursive};
+		if ( !recursive ) {
+			return true;
+		}
+
+		DIR *directory = ::opendir(path.c_str());
+		if ( !directory ) {
+			return true;
+		}
+		while ( const dirent *entry = ::readdir(directory) ) {
+			if ( std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0 ) {
+				continue;
+			}
+			const std::string child(path + '/' + entry->d_name);
+			struct stat status;
+			// symbolic links are not followed, so that cycles cannot occur
+			if ( ::lstat(child.c_str(), &status) == 0 && S_ISDIR(status.st_mode) ) {
+				add_watch(child, true);
+			}
+		}
+		::closedir(directory);
+		return true;
+	}
+
+	void read_loop() {
+		alignas(inotify_event) char buffer[64 * 1024];
+		pollfd descriptors[2] = {{m_inotify, POLLIN, 0}, {m_wakeup, POLLIN, 0}};
+		for ( ;; ) {
+			if ( ::poll(descriptors, 2, -1) < 0 ) {
+				if ( errno == EINTR ) {
+					continue;
+				}
+				return;
+			}
+			if ( descriptors[1].revents ) {
+				std::uint64_t value;
+				while ( ::read(m_wakeup, &value, sizeof(value)) < 0 && errno == EINTR ) {
+				}
+				return;
+			}
+
+			for ( ;; ) {
+				const ssize_t size = ::read(m_inotify, buffer, sizeof(buffer));
+				if ( size <= 0 ) {
+					break;
+				}
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for ( ssize_t offset = 0; offset < size; ) {
+					const auto event = reinterpret_cast<const inotify_event *>(buffer + offset);
+					handle(*event);
+					offset += sizeof(inotify_event) + event->len;
+				}
+			}
+		}
+	}
+
+	void handle(const inotify_event &event) {
+		if ( event.mask & IN_Q_OVERFLOW ) {
+			m_overflow = true;
+			note_event();
+			return;
+		}
+		const auto found = m_directories.find(event.wd);
+		if ( found == m_directories.end() ) {
+			return;
+		}
+		if ( event.mask & IN_IGNORED ) {
+			m_directories.erase(found);
+			return;
+		}
+		if ( event.len == 0 ) {
+			return;
+		}
+
+		const std::string path(found->second.path + '/' + event.name);
+		if ( event.mask & IN_ISDIR ) {
+			if ( (event.mask & (IN_CREATE | IN_MOVED_TO)) && found->second.recursive ) {
+				add_watch(path, true);
+			}
+			return;
+		}
+		note_event();
+		// the watched directories are normalized already
+		if ( m_dependents.count(path) ) {
+			m_changes.insert(path);
+		}
+	}
+#endif
+}; // class Watcher::Impl
+
+Watcher::Watcher()
+	: Watcher(Options())
+{}
+
+Watcher::Watcher(Options options)
+	: m_impl(new Impl(options))
+{}
+
+Watcher::~Watcher() = default;
+
+void Watcher::add_directory(const std::string &path, bool recursive/* = true*/)
+{
+	m_impl->add_directory(path, recursive);
+}
+
+void Watcher::watch(std::shared_ptr<TranslationUnit> translation_unit)
+{
+	m_impl->watch(std::move(translation_unit));
+}
+
+void Watcher::unwatch(const std::shared_ptr<TranslationUnit> &translation_unit)
+{
+	m_impl->unwatch(translation_unit);
+}
+
+void Watcher::set_callback(Callback callback)
+{
+	m_impl->set_callback(std::move(callback));
+}
+
+void Watcher::start()
+{
+	m_impl->start();
+}
+
+void Watcher::stop()
+{
+	m_impl->stop();
+}
+
+void Watcher::notify(const std::string &path)
+{
+	m_impl->notify(path);
+}
+
+void Watcher::wait_idle()
+{
+	m_impl->wait_idle();
+}
+
+std::size_t Watcher::watched_count() const
+{
+	return m_impl->watched_count();
+}
+
+} // namespace clangxx
@@ -0,0 +1,90 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include "clang-cpp/Arena.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+const string inputs_dir("../vendor/clang/bindings/python/tests/cindex/INPUTS");
+
+bool aligned(const void *pointer, size_t alignment)
+{
+	return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+}
+
+
+int main()
+{
+	{
+		Arena arena(1024);
+		assert(arena.allocated() == 0 && arena.capacity() == 0);
+
+		// consecutive allocations are bumped from one block
+		char *a = static_cast<char *>(arena.allocate(10, 1));
+		char *b = static_cast<char *>(arena.allocate(6, 1));
+		assert(b == a + 10);
+		assert(arena.allocated() == 16 && arena.capacity() == 1024);
+
+		for ( size_t alignment : {2, 8, 16, 64} ) {
+			arena.allocate(1, 1);
+			assert(aligned(arena.allocate(8, alignment), alignment));
+		}
+
+		// a full block is followed by a larger one; a huge request gets its own
+		arena.allocate(1000, 1);
+		assert(arena.capacity() == 1024 + 2048);
+		void *huge = arena.allocate(100000, 64);
+		assert(aligned(huge, 64));
+		assert(arena.capacity() >= 1024 + 2048 + 100000);
+
+		// the last block is kept for the next round
+		const size_t allocated = arena.allocated();
+		assert(allocated == 16 + 4 * 9 + 1000 + 100000);
+		arena.reset();
+		assert(arena.allocated() == 0);
+		assert(arena.capacity() >= 100000 && arena.capacity() < 1024 + 2048 + 100000);
+		assert(arena.allocate(10, 1) != nullptr);
+	}
+	{
+		// the block size is at least 256
+		Arena arena(1);
+		arena.allocate(1, 1);
+		assert(arena.capacity() == 256);
+	}
+	{
+		Arena arena;
+		ArenaAllocator<int> allocator(arena);
+		ArenaAllocator<char> rebound(allocator);
+		assert(allocator == rebound && &rebound.arena() == &arena);
+		Arena other;
+		assert(allocator != ArenaAllocator<int>(other));
+
+		ArenaVector<int> numbers(allocator);
+		for ( int i = 0; i < 1000; ++i ) {
+			numbers.push_back(i);
+		}
+		assert(numbers.size() == 1000 && numbers[999] == 999);
+		assert(aligned(numbers.data(), alignof(int)));
+
+		ArenaString string_("a string longer than the small string buffer", rebound);
+		string_ += "!";
+		assert(string_.back() == '!');
+		assert(arena.allocated() >= 1000 * sizeof(int) + string_.size());
+	}
+	{
+		auto index = Index::create();
+		auto translation_unit = index->parse(inputs_dir + "/hello.cpp");
+		auto root = translation_unit->cursor();
+		Arena arena;
+		const auto children = root.get_children();
+		const auto arena_children = root.get_children(arena);
+		assert(arena_children.size() == children.size());
+		const auto &main_ = arena_children.back();
+		assert(main_.spelling(arena) == ArenaString("main", ArenaAllocator<char>(arena)));
+		assert(main_.spelling(arena).c_str() == main_.spelling());
+		assert(main_.get_usr(arena).c_str() == main_.get_usr());
+		assert(arena.allocated() > 0);
+	}
+}
@@ -0,0 +1,88 @@
+#include <cassert>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "clang-cpp/AstDumper.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+string read_file(const string &path)
+{
+	ifstream input(path);
+	ostringstream text;
+	text << input.rdbuf();
+	return text.str();
+}
+
+
+int main()
+{
+	ofstream("dumper.cpp") <<
+		"namespace ns {\n"
+		"  int f(int x) { return x + 1; }\n"
+		"}\n";
+	auto index = Index::create();
+	auto tu = index->parse("dumper.cpp");
+
+	AstDumper::Options options;
+	options.format = AstDumper::Format::NDJSON;
+	options.fields = AstDumper::AllFields;
+	options.kinds = {CXCursor_FunctionDecl, CXCursor_ParmDecl, CXCursor_Namespace};
+	ostringstream ndjson;
+	AstDumper(options).dump(*tu, ndjson);
+	// filtered out nodes are skipped, the root is always written
+	assert(ndjson.str() ==
+		   "{\"id\":0,\"depth\":0,\"kind\":\"TranslationUnit\",\"spelling\":\"dumper.cpp\"}\n"
+		   "{\"id\":1,\"parent\":0,\"depth\":1,\"kind\":\"Namespace\",\"spelling\":\"ns\","
+		   "\"file\":\"dumper.cpp\",\"line\":1,\"column\":11,\"usr\":\"c:@N@ns\"}\n"
+		   "{\"id\":2,\"parent\":1,\"depth\":2,\"kind\":\"FunctionDecl\",\"spelling\":\"f\","
+		   "\"file\":\"dumper.cpp\",\"line\":2,\"column\":7,\"type\":\"int (int)\",\"usr\":\"c:@N@ns@F@f#I#\"}\n"
+		   "{\"id\":3,\"parent\":2,\"depth\":3,\"kind\":\"ParmDecl\",\"spelling\":\"x\","
+		   "\"file\":\"dumper.cpp\",\"line\":2,\"column\":13,\"type\":\"int\","
+		   "\"usr\":\"c:dumper.cpp@23@N@ns@F@f#I#@x\"}\n");
+
+	// a tiny buffer gives the same output in many pieces
+	AstDumper::Options json_options;
+	json_options.fields = AstDumper::Kind;
+	json_options.kinds = {CXCursor_FunctionDecl, CXCursor_ParmDecl};
+	const AstDumper json_dumper(json_options);
+	ostringstream json;
+	json_dumper.dump(*tu, json);
+	assert(json.str() ==
+		   "{\"kind\":\"TranslationUnit\",\"children\":[{\"kind\":\"FunctionDecl\","
+		   "\"children\":[{\"kind\":\"ParmDecl\"}]}]}");
+
+	json_options.buffer_size = 8;
+	string pieces;
+	size_t calls = 0;
+	AstDumper(json_options).dump(*tu, [&](const char *data, size_t size) {
+			pieces.append(data, size);
+			++calls;
+		});
+	assert(pieces == json.str() && calls > 1);
+
+	// an exception thrown by the sink stops the dump and reaches the caller
+	calls = 0;
+	try {
+		AstDumper(json_options).dump(*tu, [&](const char *, size_t) {
+				++calls;
+				throw runtime_error("disk full");
+			});
+		assert(false);
+	}
+	catch ( const runtime_error &error ) {
+		assert(string(error.what()) == "disk full");
+	}
+	assert(calls == 1);
+
+	const vector<shared_ptr<TranslationUnit>> tus{tu, index->parse("dumper.cpp")};
+	AstDumper::dump(tus, {"dumper0.json", "dumper1.json"}, json_options, 2);
+	assert(read_file("dumper0.json") == json.str());
+	assert(read_file("dumper1.json") == json.str());
+}
@@ -0,0 +1,125 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "clang-cpp/AstFile.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+//! Writes a two-node file by hand; each flag corrupts one part of it.
+string write_ast_file(bool huge_count, bool bad_offset, bool loop)
+{
+	AstFileHeader header{};
+	memcpy(header.magic, ast_file_magic, sizeof(header.magic));
+	header.version = ast_file_version;
+	header.byte_order = ast_file_byte_order;
+	header.node_count = huge_count ? (UINT64_C(1) << 62) : 2;
+	header.file_count = 1;
+	header.kind_count = 1;
+	header.string_count = 3;
+	header.string_bytes = 11;
+	const AstFileNode nodes[2] = {
+		{300, ast_file_invalid, 1, ast_file_invalid, 1, 0, AstFile::pack_location(0, 3, 4)},
+		{8, 0, ast_file_invalid, loop ? 1u : ast_file_invalid, 2, 2, 0}};
+	const AstFileEntry file{1, 0, 42};
+	const AstFileKind kind{8, 2};
+	const uint64_t offsets[4] = {0, 1, 7, bad_offset ? UINT64_C(10) : UINT64_C(11)};
+	const char strings[] = "\0a.cpp\0foo\0";
+
+	string data;
+	auto append = [&data](const void *section, size_t size) {
+		data.append(static_cast<const char *>(section), size);
+		data.append(AstFile::align8(size) - size, '\0');
+	};
+	append(&header, sizeof(header));
+	append(nodes, sizeof(nodes));
+	append(&file, sizeof(file));
+	append(&kind, sizeof(kind));
+	append(offsets, sizeof(offsets));
+	append(strings, 11);
+	ofstream("handmade.ast", ios::binary) << data;
+	return "handmade.ast";
+}
+
+bool opens(const string &path)
+{
+	try {
+		AstFile file(path);
+		return true;
+	}
+	catch ( const runtime_error & ) {
+		return false;
+	}
+}
+
+
+int main()
+{
+	const auto location = AstFile::pack_location(3, 120, 7);
+	assert(AstFile::location_file(location) == 3);
+	assert(AstFile::location_line(location) == 120);
+	assert(AstFile::location_column(location) == 7);
+	assert(AstFile::location_file(AstFile::pack_location(ast_file_invalid, 1, 1)) == ast_file_invalid);
+
+	ofstream("ast_file.cpp") <<
+		"namespace ns {\n"
+		"  int f(int x) { return x + 1; }\n"
+		"}\n";
+	auto index = Index::create();
+	index->parse("ast_file.cpp")->export_binary("ast_file.ast");
+
+	const AstFile file("ast_file.ast");
+	assert(file.node_count() > 5);
+	assert(file.node(0).parent == ast_file_invalid);
+	assert(string(file.kind_name(file.node(0).kind)) == "TranslationUnit");
+	uint32_t f = ast_file_invalid;
+	for ( uint32_t i = 1; i < file.node_count(); ++i ) {
+		const AstFileNode &node = file.node(i);
+		assert(node.parent < i);
+		if ( string(file.string(node.spelling)) == "f" && string(file.kind_name(node.kind)) == "FunctionDecl" ) {
+			f = i;
+		}
+	}
+	assert(f != ast_file_invalid);
+	assert(string(file.string(file.node(f).usr)) == "c:@N@ns@F@f#I#");
+	assert(string(file.kind_name(file.node(file.node(f).parent).kind)) == "Namespace");
+	const auto f_location = file.node(f).location;
+	assert(AstFile::location_line(f_location) == 2 && AstFile::location_column(f_location) == 7);
+	assert(string(file.file_name(AstFile::location_file(f_location))).find("ast_file.cpp") != string::npos);
+	size_t children = 0;
+	file.for_each_child(f, [&](uint32_t child) {
+			assert(file.node(child).parent == f);
+			++children;
+		});
+	assert(children == 2);	// the parameter and the body
+
+	const AstFile handmade(write_ast_file(false, false, false));
+	assert(handmade.node_count() == 2 && handmade.file_count() == 1);
+	assert(string(handmade.file_name(0)) == "a.cpp" && handmade.file(0).time == 42);
+	assert(string(handmade.kind_name(8)) == "foo" && string(handmade.kind_name(9)).empty());
+	assert(handmade.string_size(1) == 5 && handmade.string_size(99) == 0);
+	assert(string(handmade.string(99)).empty());
+	try {
+		handmade.node(2);
+		assert(false);
+	}
+	catch ( const out_of_range & ) {
+	}
+
+	// corrupt files are rejected instead of being read out of bounds
+	assert(!opens(write_ast_file(true, false, false)));
+	assert(!opens(write_ast_file(false, true, false)));
+	const AstFile looped(write_ast_file(false, false, true));
+	try {
+		looped.for_each_child(0, [](uint32_t) {});
+		assert(false);
+	}
+	catch ( const runtime_error & ) {
+	}
+	ofstream("truncated.ast", ios::binary).write(ast_file_magic, sizeof(ast_file_magic));
+	assert(!opens("truncated.ast"));
+}
@@ -0,0 +1,89 @@
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "clang-cpp/AstSnapshot.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+AstSnapshot reparse(TranslationUnit &tu, const string &source)
+{
+	ofstream("snapshot.cpp") << source;
+	tu.reparse();
+	return AstSnapshot::capture(tu);
+}
+
+
+int main()
+{
+	const string source(
+		"int f() { return 1 + 2; }\n"
+		"int g();\n"
+		"void h() { }\n");
+	ofstream("snapshot.cpp") << source;
+	auto index = Index::create();
+	auto tu = index->parse("snapshot.cpp");
+
+	const AstSnapshot snapshot = AstSnapshot::capture(*tu);
+	assert(snapshot.declarations().size() == 3);
+	assert(snapshot.declaration_hash("c:@F@f#") != 0);
+	assert(snapshot.declaration_hash("c:@F@k#") == 0);
+	const Cursor f = tu->cursor().get_children().front();
+	assert(snapshot.subtree_hash(f) != 0);
+	assert(snapshot.subtree_hash(f) != snapshot.subtree_hash(tu->cursor().get_children().back()));
+	assert(AstSnapshot::diff(snapshot, AstSnapshot::capture(*tu)).empty());
+
+	// moving code does not change the hashes
+	assert(AstSnapshot::diff(snapshot, reparse(*tu, "\n\n" + source)).empty());
+
+	// literals and operators are part of the hash
+	const AstDiff literal = AstSnapshot::diff(snapshot, reparse(*tu,
+		"int f() { return 1 + 3; }\nint g();\nvoid h() { }\n"));
+	assert(literal.changed == vector<string>{"c:@F@f#"});
+	assert(literal.added.empty() && literal.removed.empty());
+	const AstDiff op = AstSnapshot::diff(snapshot, reparse(*tu,
+		"int f() { return 1 - 2; }\nint g();\nvoid h() { }\n"));
+	assert(op.changed == vector<string>{"c:@F@f#"});
+
+	const string operators(
+		"int f(int x) { x++; x += 1; return -(x + 1) * 2; }\n"
+		"int g();\nvoid h() { }\n");
+	const AstSnapshot before = reparse(*tu, operators);
+	for ( const auto &edit : vector<pair<string, string>>{
+			{"x++", "x--"}, {"+=", "-="}, {"-(", "~("}, {") *", ") /"}, {"x + 1", "x - 1"}} )
+	{
+		string edited(operators);
+		edited.replace(edited.find(edit.first), edit.first.size(), edit.second);
+		assert(AstSnapshot::diff(before, reparse(*tu, edited)).changed == vector<string>{"c:@F@f#I#"});
+	}
+
+	// editing a member changes neither its class nor its namespace
+	const string nested(
+		"namespace ns {\n"
+		"struct S { int m() { return 1; } int n(); int field; };\n"
+		"}\n");
+	const AstSnapshot outer = reparse(*tu, nested);
+	string edited(nested);
+	edited.replace(edited.find("return 1"), 8, "return 2");
+	assert(AstSnapshot::diff(outer, reparse(*tu, edited)).changed
+		   == vector<string>{"c:@N@ns@S@S@F@m#"});
+	edited = nested;
+	edited.replace(edited.find("int field"), 9, "long field");
+	assert(AstSnapshot::diff(outer, reparse(*tu, edited)).changed
+		   == vector<string>{"c:@N@ns@S@S@FI@field"});
+	// adding a member changes its class, and only its class
+	edited = nested;
+	edited.replace(edited.find("int n();"), 8, "int n(); int o();");
+	const AstDiff added = AstSnapshot::diff(outer, reparse(*tu, edited));
+	assert(added.added == vector<string>{"c:@N@ns@S@S@F@o#"});
+	assert(added.changed == vector<string>{"c:@N@ns@S@S"});
+
+	const AstDiff diff = AstSnapshot::diff(snapshot, reparse(*tu,
+		"int f() { return 1 + 2; }\nint g();\nvoid k() { }\n"));
+	assert(diff.added == vector<string>{"c:@F@k#"});
+	assert(diff.removed == vector<string>{"c:@F@h#"});
+	assert(diff.changed.empty());
+}
@@ -0,0 +1,61 @@
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/BatchParser.hpp"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/ParseProfile.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+
+int main()
+{
+	ofstream("batch_a.h") << "#pragma once\nint a();\n";
+	ofstream("batch_b.h") << "#pragma once\nint b();\n";
+	vector<ParseJob> jobs(7);
+	for ( size_t i = 0; i < 6; ++i ) {
+		jobs[i].filename = "batch_" + to_string(i) + ".cpp";
+		ofstream(jobs[i].filename) << ((i % 2) ? "#include \"batch_a.h\"\n" : "#include \"batch_b.h\"\n")
+								   << "int f" << i << "();\n";
+	}
+	jobs[6].filename = "no_such_file.cpp";
+
+	ParseProfile profile;
+	for ( const auto schedule : {BatchParser::Schedule::Fifo, BatchParser::Schedule::Locality} ) {
+		BatchParser parser(Index::create(), 3);
+		parser.set_profile(&profile);
+		parser.set_schedule(schedule);
+		parser.set_window(2);
+		const auto results = parser.parse(jobs);
+
+		// one result per job, in the order of the jobs
+		assert(results.size() == jobs.size());
+		for ( size_t i = 0; i < 6; ++i ) {
+			assert(results[i].translation_unit && !results[i].error);
+			assert(results[i].translation_unit->spelling() == jobs[i].filename);
+			assert(results[i].translation_unit->cursor().get_children().back().spelling()
+				   == "f" + to_string(i));
+		}
+		assert(!results[6].translation_unit && results[6].error);
+		try {
+			rethrow_exception(results[6].error);
+		}
+		catch ( const TranslationUnitLoadError & ) {
+		}
+
+		const BatchStats &stats = parser.last_stats();
+		assert(stats.jobs == 7 && stats.failures == 1);
+		assert(stats.wall_seconds > 0 && stats.parse_seconds > 0);
+		// the profile records the parsed jobs, which the second pass schedules by
+		assert(profile.size() == 6);
+	}
+
+	ParseProfile::Entry odd, even, other_odd;
+	assert(profile.find("batch_0.cpp", even) && profile.find("batch_1.cpp", odd)
+		   && profile.find("batch_3.cpp", other_odd));
+	assert(ParseProfile::similarity(odd.signature, other_odd.signature) == 1.0);
+	assert(ParseProfile::similarity(odd.signature, even.signature) < 1.0);
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "clang-cpp/CallGraph.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+vector<string> callees(const CallGraph &graph, const string &usr)
+{
+	vector<string> usrs;
+	const auto range = graph.callees(graph.find(usr));
+	for ( auto callee = range.first; callee != range.second; ++callee ) {
+		usrs.emplace_back(graph.usr(*callee));
+	}
+	sort(usrs.begin(), usrs.end());
+	return usrs;
+}
+
+//! Writes @a data with @a size bytes at @a offset replaced by @a value.
+bool loads(string data, size_t offset, uint64_t value, size_t size)
+{
+	memcpy(&data[offset], &value, size);
+	ofstream("corrupt.bin", ios::binary) << data;
+	try {
+		CallGraph::load("corrupt.bin");
+		return true;
+	}
+	catch ( const runtime_error & ) {
+		return false;
+	}
+}
+
+
+int main()
+{
+	// a -> b -> c, d isolated
+	const vector<string> usrs{"a", "b", "c", "d"};
+	CallGraph graph = CallGraph::from_edges(usrs, {{0, 1}, {1, 2}, {0, 1}});
+	assert(graph.node_count() == 4);
+	assert(graph.find("c") == 2);
+	assert(graph.find("e") == CallGraph::invalid_node);
+	assert(callees(graph, "a") == vector<string>{"b"});
+	assert(callees(graph, "d").empty());
+	assert(graph.reachable({0}).size() == 3);
+	assert(graph.reachable({3}) == vector<CallGraph::NodeId>{3});
+
+	const CallGraph reversed = graph.reversed();
+	assert(callees(reversed, "c") == vector<string>{"b"});
+	assert(reversed.reachable({2}).size() == 3);
+
+	graph.save("call_graph.bin");
+	const CallGraph loaded = CallGraph::load("call_graph.bin");
+	assert(loaded.node_count() == graph.node_count());
+	assert(loaded.edge_count() == graph.edge_count());
+	assert(callees(loaded, "b") == vector<string>{"c"});
+
+	// corrupt files are rejected instead of being read out of bounds; the
+	// header is 40 bytes, then 5 edge offsets, 5 name offsets, 2 targets,
+	// 4 sorted nodes and "a\0b\0c\0d\0"
+	ifstream saved("call_graph.bin", ios::binary);
+	const string data((istreambuf_iterator<char>(saved)), istreambuf_iterator<char>());
+	assert(data.size() == 152);
+	assert(loads(data, 0, 0, 0));
+	assert(!loads(data, 16, UINT64_C(1) << 62, 8));	// node count
+	assert(!loads(data, 16, 0xffffffff, 8));
+	assert(!loads(data, 24, UINT64_C(1) << 62, 8));	// edge count
+	assert(!loads(data, 32, 100, 8));				// name bytes
+	assert(!loads(data, 56, 0, 8));					// decreasing edge offset
+	assert(!loads(data, 72, 3, 8));					// last edge offset
+	assert(!loads(data, 88, 100, 8));				// name offset
+	assert(!loads(data, 120, 4, 4));				// callee
+	assert(!loads(data, 128, 7, 4));				// sorted node
+	assert(!loads(data, 128, 3, 4));				// unsorted names
+	assert(!loads(data, 145, 'x', 1));				// name without its NUL
+	ofstream("truncated.bin", ios::binary) << data.substr(0, 100);
+	try {
+		CallGraph::load("truncated.bin");
+		assert(false);
+	}
+	catch ( const runtime_error & ) {
+	}
+
+	ofstream("call_graph.cpp") <<
+		"struct B { virtual void v(); };\n"
+		"struct D : B { void v() override; };\n"
+		"void leaf() { }\n"
+		"void mid() { leaf(); }\n"
+		"void top(B &b) { mid(); b.v(); }\n";
+	auto index = Index::create();
+	vector<shared_ptr<TranslationUnit>> tus{index->parse("call_graph.cpp")};
+	const CallGraph built = CallGraph::build(tus, 2);
+	assert(callees(built, "c:@F@mid#") == vector<string>{"c:@F@leaf#"});
+	// the virtual call also reaches the override
+	assert(callees(built, "c:@F@top#&$@S@B#")
+		   == (vector<string>{"c:@F@mid#", "c:@S@B@F@v#", "c:@S@D@F@v#"}));
+	assert(built.reversed().reachable({built.find("c:@F@leaf#")}).size() == 3);
+}
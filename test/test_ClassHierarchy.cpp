@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "clang-cpp/ClassHierarchy.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+vector<string> usrs(const ClassHierarchy &hierarchy, ClassHierarchy::Range range)
+{
+	vector<string> result;
+	for ( auto node = range.first; node != range.second; ++node ) {
+		result.push_back(hierarchy.usr(*node));
+	}
+	sort(result.begin(), result.end());
+	return result;
+}
+
+vector<string> usrs(const ClassHierarchy &hierarchy, const vector<ClassHierarchy::NodeId> &nodes)
+{
+	return usrs(hierarchy, ClassHierarchy::Range(nodes.data(), nodes.data() + nodes.size()));
+}
+
+
+int main()
+{
+	ofstream("hierarchy.h") <<
+		"#pragma once\n"
+		"struct A { virtual void m(); };\n"
+		"struct B : A { void m() override; };\n";
+	ofstream("hierarchy_b.cpp") << "#include \"hierarchy.h\"\n";
+	ofstream("hierarchy_c.cpp") << "#include \"hierarchy.h\"\nstruct C : B { void m() override; };\n";
+
+	auto index = Index::create();
+	const vector<shared_ptr<TranslationUnit>> tus{
+		index->parse("hierarchy_b.cpp"), index->parse("hierarchy_c.cpp")};
+	const ClassHierarchy hierarchy = ClassHierarchy::build(tus, 2);
+
+	const auto a = hierarchy.find("c:@S@A");
+	const auto b = hierarchy.find("c:@S@B");
+	assert(a != ClassHierarchy::invalid_node && b != ClassHierarchy::invalid_node);
+	assert(hierarchy.find("c:@S@D") == ClassHierarchy::invalid_node);
+	// the relations of the shared header are recorded once
+	assert(usrs(hierarchy, hierarchy.bases(b)) == vector<string>{"c:@S@A"});
+	assert(usrs(hierarchy, hierarchy.derived(a)) == vector<string>{"c:@S@B"});
+	assert(usrs(hierarchy, hierarchy.all_subclasses(a)) == (vector<string>{"c:@S@B", "c:@S@C"}));
+	assert(usrs(hierarchy, hierarchy.all_bases(hierarchy.find("c:@S@C")))
+		   == (vector<string>{"c:@S@A", "c:@S@B"}));
+
+	const auto a_m = hierarchy.find("c:@S@A@F@m#");
+	assert(usrs(hierarchy, hierarchy.overriders(a_m)) == vector<string>{"c:@S@B@F@m#"});
+	assert(usrs(hierarchy, hierarchy.all_overriders(a_m))
+		   == (vector<string>{"c:@S@B@F@m#", "c:@S@C@F@m#"}));
+	assert(usrs(hierarchy, hierarchy.all_overridden(hierarchy.find("c:@S@C@F@m#")))
+		   == (vector<string>{"c:@S@A@F@m#", "c:@S@B@F@m#"}));
+
+	// merging the hierarchies of each TU gives the same relations
+	ClassHierarchy merged = ClassHierarchy::build({tus[0]}, 1);
+	merged.merge(ClassHierarchy::build({tus[1]}, 1));
+	assert(merged.node_count() == hierarchy.node_count());
+	assert(usrs(merged, merged.derived(merged.find("c:@S@A"))) == vector<string>{"c:@S@B"});
+	assert(usrs(merged, merged.all_overriders(merged.find("c:@S@A@F@m#")))
+		   == (vector<string>{"c:@S@B@F@m#", "c:@S@C@F@m#"}));
+}
@@ -0,0 +1,73 @@
+#include <cassert>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "clang-cpp/Comment.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Query.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+
+int main()
+{
+	ofstream("comment.cpp") <<
+		"/// Adds two numbers.\n"
+		"/// \\param a the first one\n"
+		"int add(int a, int b);\n"
+		"int undocumented();\n"
+		"struct S {\n"
+		"  /// Returns <b>zero</b>.\n"
+		"  int zero();\n"
+		"};\n";
+	auto index = Index::create();
+	auto tu = index->parse("comment.cpp");
+
+	const auto functions = Query::compile("FunctionDecl").match(tu->cursor());
+	assert(functions.size() == 2);
+	assert(!functions[1].parsed_comment());
+
+	const Comment comment = functions[0].parsed_comment();
+	assert(comment.kind() == CXComment_FullComment);
+	bool has_param{false};
+	for ( const Comment &child : comment.children() ) {
+		if ( child.kind() == CXComment_ParamCommand ) {
+			assert(child.param_name() == "a");
+			assert(child.is_param_index_valid() && child.param_index() == 0);
+			has_param = true;
+		}
+	}
+	assert(has_param);
+	assert(comment.html().find("Adds two numbers.") != string::npos);
+	assert(comment.xml().find("<Name>add</Name>") != string::npos);
+
+	// one rendering per documented declaration, tagged with its TU
+	const vector<shared_ptr<TranslationUnit>> tus{tu, index->parse("comment.cpp")};
+	mutex mutex;
+	vector<string> rendered[2];
+	render_comments(tus, CommentFormat::HTML,
+					[&](size_t tu_index, const char *data, size_t size) {
+						lock_guard<std::mutex> lock(mutex);
+						rendered[tu_index].emplace_back(data, size);
+					}, TraversalOptions(), 2);
+	for ( const auto &strings : rendered ) {
+		assert(strings.size() == 2);
+		assert(strings[0].find("Adds two numbers.") != string::npos);
+		assert(strings[1].find("<b>zero</b>") != string::npos);
+	}
+
+	// an exception thrown by the sink reaches the caller
+	try {
+		render_comments({tu}, CommentFormat::XML,
+						[](size_t, const char *, size_t) { throw runtime_error("full"); });
+		assert(false);
+	}
+	catch ( const runtime_error &error ) {
+		assert(string(error.what()) == "full");
+	}
+}
@@ -0,0 +1,50 @@
+#include <cassert>
+#include <cstdint>
+#include "clang-cpp/CursorMap.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+CXCursor make_cursor(CXCursorKind kind, uintptr_t data0, uintptr_t data1 = 0)
+{
+	CXCursor cx_cursor{};
+	cx_cursor.kind = kind;
+	cx_cursor.data[0] = reinterpret_cast<const void *>(data0);
+	cx_cursor.data[1] = reinterpret_cast<const void *>(data1);
+	return cx_cursor;
+}
+
+
+int main()
+{
+	// declarations ignore data[1], like clang_equalCursors()
+	assert(CXCursorEqual()(make_cursor(CXCursor_FunctionDecl, 8, 1),
+						   make_cursor(CXCursor_FunctionDecl, 8, 0)));
+	assert(!CXCursorEqual()(make_cursor(CXCursor_CallExpr, 8, 16),
+							make_cursor(CXCursor_CallExpr, 8, 24)));
+
+	CursorMap<int> map;
+	for ( uintptr_t i{1}; i <= 1000; ++i ) {
+		assert(map.insert(make_cursor(CXCursor_CallExpr, 8, i * 8), int(i)).second);
+	}
+	assert(map.size() == 1000);
+	assert(!map.insert(make_cursor(CXCursor_CallExpr, 8, 8), 0).second);
+	assert(*map.find(make_cursor(CXCursor_CallExpr, 8, 80)) == 10);
+	assert(!map.find(make_cursor(CXCursor_DeclRefExpr, 8, 80)));
+
+	for ( uintptr_t i{1}; i <= 1000; i += 2 ) {
+		assert(map.erase(make_cursor(CXCursor_CallExpr, 8, i * 8)));
+	}
+	assert(map.size() == 500);
+	for ( uintptr_t i{1}; i <= 1000; ++i ) {
+		const int *value = map.find(make_cursor(CXCursor_CallExpr, 8, i * 8));
+		assert((i % 2 == 0) ? (value && *value == int(i)) : !value);
+	}
+
+	CursorSet set;
+	assert(set.insert(make_cursor(CXCursor_ClassDecl, 16)));
+	assert(!set.insert(make_cursor(CXCursor_ClassDecl, 16, 1)));
+	assert(set.contains(make_cursor(CXCursor_ClassDecl, 16)));
+	assert(set.erase(make_cursor(CXCursor_ClassDecl, 16)));
+	assert(set.empty());
+}
@@ -0,0 +1,56 @@
+#include <cassert>
+#include <string>
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+const string inputs_dir("../vendor/clang/bindings/python/tests/cindex/INPUTS");
+
+
+int main()
+{
+	auto index = Index::create();
+	auto tu = index->parse(inputs_dir + "/include.cpp");
+
+	const File header1 = tu->get_file(inputs_dir + "/header1.h");
+	const File header3 = tu->get_file(inputs_dir + "/header3.h");
+	assert(header1 != header3);
+	assert(header1.is_multiple_include_guarded());
+	assert(!header3.is_multiple_include_guarded());
+	assert(*header3.try_name() == header3.name());
+	assert(tu->file_table().size() == 2);
+	assert(tu->file_table().find(header3.unique_id()) == header3.id());
+	assert(tu->file_table().find(inputs_dir + "/header1.h") == header1.id());
+
+	// names are copies: they outlive the table entries
+	const string name = header3.name();
+	tu->reparse();
+	assert(tu->file_table().size() == 0);
+	assert(name == inputs_dir + "/header3.h");
+
+	// the old Files report the reparse instead of reading a cleared entry
+	assert(header3.try_name().status() == Status::Unknown);
+	assert(header3.try_is_multiple_include_guarded().status() == Status::Unknown);
+	bool thrown = false;
+	try {
+		header3.name();
+	}
+	catch ( const LogicError & ) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	const File reparsed = tu->get_file(inputs_dir + "/header3.h");
+	assert(reparsed == header3);
+	assert(reparsed.name() == inputs_dir + "/header3.h");
+	assert(!reparsed.is_multiple_include_guarded());
+	assert(tu->file_table().size() == 1);
+	assert(tu->file_table().find(reparsed.unique_id()) == reparsed.id());
+
+	// the id of header1 now names header3, which the old File detects
+	assert(reparsed.id() == header1.id());
+	assert(header1.try_name().status() == Status::Unknown);
+	assert(header3.try_name().status() == Status::Unknown);
+}
@@ -0,0 +1,48 @@
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/HeaderDeduplicator.hpp"
+#include "clang-cpp/Index.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+void write_file(const string &path, const string &text)
+{
+	ofstream out(path);
+	out << text;
+}
+
+vector<string> top_level_names(const TranslationUnit &tu, HeaderDeduplicator &deduplicator)
+{
+	vector<string> names;
+	deduplicator.visit(tu.cursor(), [&](const Cursor &cursor, const Cursor &) {
+			names.push_back(cursor.spelling());
+			return CXChildVisit_Continue;
+		});
+	return names;
+}
+
+
+int main()
+{
+	write_file("dedup_guarded.h", "#ifndef DEDUP_GUARDED_H\n#define DEDUP_GUARDED_H\nint g();\n#endif\n");
+	write_file("dedup_unguarded.h", "int h();\n");
+	write_file("dedup_a.cpp", "#include \"dedup_guarded.h\"\n#include \"dedup_unguarded.h\"\nint a();\n");
+	write_file("dedup_b.cpp", "#include \"dedup_guarded.h\"\n#include \"dedup_unguarded.h\"\nint b();\n");
+
+	auto index = Index::create();
+	auto tu_a = index->parse("dedup_a.cpp");
+	auto tu_b = index->parse("dedup_b.cpp");
+
+	HeaderDeduplicator deduplicator;
+	assert(top_level_names(*tu_a, deduplicator) == (vector<string>{"g", "h", "a"}));
+	assert(deduplicator.size() == 1);
+	// the guarded header is skipped, the unguarded one is visited again
+	assert(top_level_names(*tu_b, deduplicator) == (vector<string>{"h", "b"}));
+	assert(deduplicator.is_processed(tu_a->get_file("dedup_guarded.h").unique_id()));
+
+	deduplicator.clear();
+	assert(top_level_names(*tu_b, deduplicator) == (vector<string>{"g", "h", "b"}));
+}
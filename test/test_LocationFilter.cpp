@@ -0,0 +1,52 @@
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/TraversalOptions.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+const string inputs_dir("../vendor/clang/bindings/python/tests/cindex/INPUTS");
+
+vector<string> top_level_names(const TranslationUnit &tu, const TraversalOptions &options)
+{
+	vector<string> names;
+	for ( const auto &cursor : tu.cursor().get_children(options) ) {
+		names.push_back(cursor.spelling());
+	}
+	return names;
+}
+
+
+int main()
+{
+	auto index = Index::create();
+	// include.cpp includes header3.h (unguarded, declares f) twice
+	auto tu = index->parse(inputs_dir + "/include.cpp");
+
+	TraversalOptions options;
+	assert(!options.filters_locations());
+	assert(top_level_names(*tu, options) == (vector<string>{"f", "f", "main"}));
+
+	options.main_file_only = true;
+	assert(top_level_names(*tu, options) == vector<string>{"main"});
+
+	options.main_file_only = false;
+	options.allowed_files.insert(tu->get_file(inputs_dir + "/header3.h").unique_id());
+	assert(top_level_names(*tu, options) == (vector<string>{"f", "f"}));
+
+	options.allowed_files.clear();
+	options.exclude_system_headers = true;
+	assert(top_level_names(*tu, options) == (vector<string>{"f", "f", "main"}));
+
+	ofstream("location_filter.cpp") << "#include <header3.h>\nint main() { }\n";
+	const vector<string> args{"-isystem", inputs_dir};
+	auto system_tu = index->parse("location_filter.cpp", &args);
+	assert(top_level_names(*system_tu, options) == vector<string>{"main"});
+
+	// a null cursor has no children, whatever the options
+	const Cursor f = tu->cursor().get_children().front();
+	assert(f.get_definition().get_children(options).empty());
+}
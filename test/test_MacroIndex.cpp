@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/MacroIndex.hpp"
+#include "clang-cpp/TranslationUnit.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+
+int main()
+{
+	ofstream("macros.h") <<
+		"#pragma once\n"
+		"#define SQUARE(x) ((x) * (x))\n"
+		"#define LIMIT 10\n";
+	ofstream("macros_a.cpp") <<
+		"#include \"macros.h\"\n"
+		"int a = SQUARE(LIMIT);\n";
+	ofstream("macros_b.cpp") <<
+		"#include \"macros.h\"\n"
+		"#define LOCAL 1\n"
+		"int b = SQUARE(2) + LOCAL;\n";
+
+	MacroIndex index;
+	auto tu = index.parse("macros_a.cpp");
+	assert(tu);
+	index.parse("macros_b.cpp");
+
+	const auto definitions = index.definitions("SQUARE");
+	// the shared header is recorded once
+	assert(definitions.size() == 1);
+	assert(definitions[0].filename.find("macros.h") != string::npos);
+	assert(definitions[0].line == 2 && definitions[0].column == 9);
+
+	auto expansions = index.expansions("SQUARE");
+	assert(expansions.size() == 2);
+	sort(expansions.begin(), expansions.end(),
+		 [](const MacroIndex::Location &lhs, const MacroIndex::Location &rhs) {
+			 return lhs.filename < rhs.filename;
+		 });
+	assert(expansions[0].filename.find("macros_a.cpp") != string::npos);
+	assert(expansions[0].line == 2 && expansions[0].column == 9);
+	assert(expansions[1].filename.find("macros_b.cpp") != string::npos);
+	assert(expansions[1].line == 3 && expansions[1].column == 9);
+
+	assert(index.expansions("LIMIT").size() == 1);
+	assert(index.definitions("LOCAL").size() == 1 && index.expansions("LOCAL").size() == 1);
+	assert(index.definitions("UNDEFINED").empty());
+
+	auto names = index.names();
+	assert(find(names.begin(), names.end(), "SQUARE") != names.end());
+	assert(find(names.begin(), names.end(), "LOCAL") != names.end());
+	assert(index.size() == names.size());
+
+	// adding a translation unit again does not duplicate its sites
+	index.add(*tu);
+	assert(index.expansions("SQUARE").size() == 2);
+
+	index.clear();
+	assert(index.size() == 0 && index.definitions("SQUARE").empty());
+	index.add({tu}, 1);
+	assert(index.definitions("SQUARE").size() == 1);
+	assert(index.expansions("SQUARE").size() == 1);
+}
@@ -0,0 +1,103 @@
+#include <cassert>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <sys/stat.h>
+#include <utime.h>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Module.hpp"
+#include "clang-cpp/ModuleCache.hpp"
+#include "clang-cpp/ModuleMap.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+void write_module(const string &path, size_t size, time_t age)
+{
+	ofstream(path) << string(size, 'x');
+	const time_t when = time(nullptr) - age;
+	const utimbuf times{when, when};
+	assert(utime(path.c_str(), &times) == 0);
+}
+
+bool exists(const string &path)
+{
+	struct stat status;
+	return stat(path.c_str(), &status) == 0;
+}
+
+//! @return the first ModuleImportDecl under @a root, or @a root if there is none.
+Cursor find_import(const Cursor &root)
+{
+	for ( const auto &child : root.get_children() ) {
+		if ( clang_getCursorKind(child.native_handle()) == CXCursor_ModuleImportDecl ) {
+			return child;
+		}
+	}
+	return root;
+}
+
+
+int main()
+{
+	const string directory("module_cache");
+	mkdir(directory.c_str(), 0755);
+	mkdir((directory + "/config").c_str(), 0755);
+	write_module(directory + "/oldest.pcm", 100, 3000);
+	write_module(directory + "/config/older.pcm", 100, 2000);
+	write_module(directory + "/old.pcm", 100, 1000);
+	write_module(directory + "/recent.pcm", 100, 0);
+	ofstream(directory + "/modules.idx") << string(1000, 'x');
+
+	ModuleCache unlimited(directory);
+	assert(unlimited.arguments()
+		   == (vector<string>{"-fmodules", "-fmodules-cache-path=" + directory}));
+	assert(unlimited.size() == 400);
+	assert(unlimited.prune() == 0);
+
+	// least recently used first; recent files are kept even over the limit
+	ModuleCache cache(directory, 250, 2);
+	assert(cache.prune() == 200);
+	assert(!exists(directory + "/oldest.pcm") && !exists(directory + "/config/older.pcm"));
+	assert(exists(directory + "/old.pcm") && exists(directory + "/recent.pcm"));
+
+	ModuleCache small(directory, 50, 2);
+	small.note_parse();
+	assert(exists(directory + "/old.pcm"));
+	small.note_parse();
+	assert(!exists(directory + "/old.pcm") && exists(directory + "/recent.pcm"));
+	assert(small.size() == 100);
+
+	// module files loaded by a live translation unit are kept, however old
+	mkdir("module_cache_fw", 0755);
+	mkdir("module_cache_fw/Bar.framework", 0755);
+	mkdir("module_cache_fw/Bar.framework/Headers", 0755);
+	mkdir("module_cache_fw/Bar.framework/Modules", 0755);
+	ModuleMap module_map;
+	module_map.set_framework_module_name("Bar").set_umbrella_header("Bar.h");
+	module_map.write("module_cache_fw/Bar.framework/Modules/module.modulemap");
+	ofstream("module_cache_fw/Bar.framework/Headers/Bar.h") << "int bar_value(void);\n";
+	ofstream("module_cache_import.m") << "@import Bar;\nint main(void) { return bar_value(); }\n";
+
+	const string used_directory("module_cache_used");
+	auto used = make_shared<ModuleCache>(used_directory, 1);
+	auto index = Index::create();
+	index->set_module_cache(used);
+	const vector<string> args{"-F", "module_cache_fw"};
+	auto tu = index->parse("module_cache_import.m", &args);
+	const string pcm = Module::from_import(find_import(tu->cursor())).ast_file().name();
+	assert(exists(pcm));
+	const time_t when = time(nullptr) - 3000;
+	const utimbuf times{when, when};
+	assert(utime(pcm.c_str(), &times) == 0);
+
+	assert(used->prune() == 0);
+	assert(exists(pcm));
+	tu->reparse();
+	assert(used->prune() == 0);
+	tu.reset();
+	assert(used->prune() > 0);
+	assert(!exists(pcm));
+}
@@ -0,0 +1,76 @@
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Module.hpp"
+#include "clang-cpp/ModuleCache.hpp"
+#include "clang-cpp/ModuleMap.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+bool has_suffix(const string &name, const string &suffix)
+{
+	return name.size() >= suffix.size()
+		&& name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+//! @return the first ModuleImportDecl under @a root, or @a root if there is none.
+Cursor find_import(const Cursor &root)
+{
+	for ( const auto &child : root.get_children() ) {
+		if ( clang_getCursorKind(child.native_handle()) == CXCursor_ModuleImportDecl ) {
+			return child;
+		}
+	}
+	return root;
+}
+
+
+int main()
+{
+	ModuleMap module_map;
+	module_map.set_framework_module_name("Foo").set_umbrella_header("Foo.h");
+	const string text = module_map.str();
+	assert(text.find("framework module Foo") != string::npos);
+	assert(text.find("umbrella header \"Foo.h\"") != string::npos);
+
+	const ModuleMap moved(std::move(module_map));
+	moved.write("module.modulemap");
+	ifstream input("module.modulemap");
+	ostringstream written;
+	written << input.rdbuf();
+	assert(written.str() == text);
+
+	// import the framework through the written module map
+	mkdir("module_map_fw", 0755);
+	mkdir("module_map_fw/Foo.framework", 0755);
+	mkdir("module_map_fw/Foo.framework/Headers", 0755);
+	mkdir("module_map_fw/Foo.framework/Modules", 0755);
+	moved.write("module_map_fw/Foo.framework/Modules/module.modulemap");
+	ofstream("module_map_fw/Foo.framework/Headers/Foo.h") << "int foo_value(void);\n";
+	ofstream("module_map_import.m") << "@import Foo;\nint main(void) { return foo_value(); }\n";
+	ofstream("module_map_include.cpp") << "#include <Foo/Foo.h>\nint main() { return foo_value(); }\n";
+
+	auto index = Index::create();
+	index->set_module_cache(make_shared<ModuleCache>("module_map_cache"));
+	const vector<string> args{"-F", "module_map_fw"};
+
+	auto imported = index->parse("module_map_import.m", &args);
+	const Module foo = Module::from_import(find_import(imported->cursor()));
+	assert(foo && foo.full_name() == "Foo" && !foo.parent());
+	assert(has_suffix(foo.ast_file().name(), ".pcm"));
+	assert(foo.ast_file().name().find("module_map_cache/") != string::npos);
+
+	auto included = index->parse("module_map_include.cpp", &args);
+	const Module header_module = Module::from_file(
+		included->get_file("module_map_fw/Foo.framework/Headers/Foo.h"));
+	assert(header_module && header_module.name() == "Foo");
+	assert(has_suffix(header_module.ast_file().name(), ".pcm"));
+	assert(!Module::from_file(included->get_file("module_map_include.cpp")));
+	assert(index->module_cache()->size() > 0);
+}
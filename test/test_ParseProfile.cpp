@@ -0,0 +1,59 @@
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/ParseProfile.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+vector<string> headers(int first, int last)
+{
+	vector<string> result;
+	for ( int i = first; i < last; ++i ) {
+		result.push_back("/include/header" + to_string(i) + ".h");
+	}
+	return result;
+}
+
+
+int main()
+{
+	const auto signature = ParseProfile::signature(headers(0, 100));
+	assert(ParseProfile::similarity(signature, signature) == 1.0);
+	// the signature does not depend on the order of the includes
+	const auto forward = headers(0, 100);
+	const vector<string> reversed(forward.rbegin(), forward.rend());
+	assert(ParseProfile::signature(reversed) == signature);
+	assert(ParseProfile::similarity(signature, ParseProfile::signature(headers(100, 200))) < 0.2);
+	// 50 shared out of 150: Jaccard similarity 1/3
+	const double half = ParseProfile::similarity(signature, ParseProfile::signature(headers(50, 150)));
+	assert(half > 0.05 && half < 0.7);
+
+	ParseProfile profile;
+	assert(!profile.load("no_such_profile.tsv"));
+	assert(profile.size() == 0);
+
+	profile.record("a.cpp", 0.25, headers(0, 10));
+	profile.record("b.cpp", 1.5, headers(5, 15));
+	profile.record("a.cpp", 0.5, headers(0, 10));
+	assert(profile.size() == 2);
+	ParseProfile::Entry entry;
+	assert(profile.find("a.cpp", entry));
+	assert(entry.seconds == 0.5 && entry.signature == ParseProfile::signature(headers(0, 10)));
+	assert(!profile.find("c.cpp", entry));
+
+	profile.save("profile.tsv");
+	{
+		ofstream append("profile.tsv", ios::app);
+		append << "malformed line\n" << "c.cpp\tnot a number\n";
+	}
+	ParseProfile loaded;
+	loaded.record("stale.cpp", 1, {});
+	assert(loaded.load("profile.tsv"));
+	assert(loaded.size() == 2);
+	assert(!loaded.find("stale.cpp", entry));
+	assert(loaded.find("b.cpp", entry));
+	assert(entry.seconds == 1.5 && entry.signature == ParseProfile::signature(headers(5, 15)));
+}
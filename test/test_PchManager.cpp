@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "clang-cpp/BatchParser.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/PchManager.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+const string inputs_dir("../vendor/clang/bindings/python/tests/cindex/INPUTS");
+
+string pch_of(const ParseJob &job)
+{
+	const auto found = find(job.args.begin(), job.args.end(), "-include-pch");
+	return (found == job.args.end()) ? string() : *(found + 1);
+}
+
+string read_file(const string &path)
+{
+	ifstream input(path);
+	ostringstream text;
+	text << input.rdbuf();
+	return text.str();
+}
+
+bool has_temporary_files(const string &directory)
+{
+	DIR *dir = opendir(directory.c_str());
+	assert(dir);
+	bool result = false;
+	while ( const dirent *entry = readdir(dir) ) {
+		result = result || string(entry->d_name).find(".tmp") != string::npos;
+	}
+	closedir(dir);
+	return result;
+}
+
+bool parses_cleanly(Index &index, const ParseJob &job)
+{
+	auto tu = index.parse(job.filename, &job.args);
+	return clang_getNumDiagnostics(tu->native_handle()) == 0;
+}
+
+
+int main()
+{
+	assert(PchManager::leading_includes(inputs_dir + "/include.cpp")
+		   == (vector<string>{"\"header1.h\"", "\"header2.h\"", "\"header1.h\""}));
+	ofstream("pch_leading.cpp") <<
+		"// comment\n"
+		"#pragma once\n"
+		"/* block\n   comment */ #include <vector>\n"
+		"  #  include \"a.h\" // trailing\n"
+		"#include MACRO\n"
+		"#include \"b.h\"\n";
+	assert(PchManager::leading_includes("pch_leading.cpp")
+		   == (vector<string>{"<vector>", "\"a.h\""}));
+	assert(PchManager::leading_includes("no_such_file.cpp").empty());
+
+	ofstream("pch_guarded.h") << "#pragma once\nconst int guarded_value = 1;\n";
+	ofstream("pch_unguarded.h") << "int unguarded_value = 2;\n";
+	for ( const char *name : {"pch_a.cpp", "pch_b.cpp"} ) {
+		ofstream(name) <<
+			"#include \"pch_guarded.h\"\n"
+			"#include \"pch_unguarded.h\"\n"
+			"int " << name[4] << "() { return guarded_value + unguarded_value; }\n";
+	}
+	ofstream("pch_c.cpp") << "#include \"pch_unguarded.h\"\n";
+
+	mkdir("pch", 0755);
+	PchManager manager("pch");
+	auto index = Index::create();
+	vector<ParseJob> original(3);
+	original[0].filename = "pch_a.cpp";
+	original[1].filename = "pch_b.cpp";
+	original[2].filename = "pch_c.cpp";
+	vector<ParseJob> jobs(original);
+	manager.prepare(jobs, index, 2);
+
+	// the shared prefix stops before the unguarded header, so the sources
+	// can still include it
+	const string pch = pch_of(jobs[0]);
+	assert(!pch.empty() && pch == pch_of(jobs[1]));
+	assert(read_file(pch.substr(0, pch.size() - 4) + ".h") == "#include \"pch_guarded.h\"\n");
+	assert(pch_of(jobs[2]).empty() && jobs[2].args.empty());
+	assert(parses_cleanly(*index, jobs[0]) && parses_cleanly(*index, jobs[1]));
+
+	// reused while up to date, rebuilt after a dependency changes
+	struct stat built;
+	assert(stat(pch.c_str(), &built) == 0);
+	jobs = original;
+	manager.prepare(jobs, index, 2);
+	struct stat reused;
+	assert(pch_of(jobs[0]) == pch && stat(pch.c_str(), &reused) == 0);
+	assert(reused.st_mtim.tv_sec == built.st_mtim.tv_sec && reused.st_mtim.tv_nsec == built.st_mtim.tv_nsec);
+
+	ofstream("pch_guarded.h") << "#pragma once\nconst int guarded_value = 3;\n";
+	jobs = original;
+	manager.prepare(jobs, index, 2);
+	struct stat rebuilt;
+	assert(pch_of(jobs[0]) == pch && stat(pch.c_str(), &rebuilt) == 0);
+	assert(rebuilt.st_mtim.tv_sec != built.st_mtim.tv_sec || rebuilt.st_mtim.tv_nsec != built.st_mtim.tv_nsec);
+	assert(parses_cleanly(*index, jobs[1]));
+
+	// concurrent prepares of a stale PCH all get the rebuilt one
+	ofstream("pch_guarded.h") << "#pragma once\nconst int guarded_value = 4;\n";
+	vector<vector<ParseJob>> concurrent(4, original);
+	vector<thread> threads;
+	for ( size_t i = 0; i < concurrent.size(); ++i ) {
+		threads.emplace_back([&, i] { manager.prepare(concurrent[i], index, 1); });
+	}
+	for ( auto &thread : threads ) {
+		thread.join();
+	}
+	for ( const auto &concurrent_jobs : concurrent ) {
+		assert(pch_of(concurrent_jobs[0]) == pch && pch_of(concurrent_jobs[1]) == pch);
+		assert(parses_cleanly(*index, concurrent_jobs[0]));
+	}
+	assert(!has_temporary_files("pch"));
+
+	// different arguments give a different PCH; a lone job gets none
+	jobs = original;
+	jobs[1].args.push_back("-DOTHER");
+	manager.prepare(jobs, index, 2);
+	assert(pch_of(jobs[0]).empty() && pch_of(jobs[1]).empty());
+
+	manager.invalidate();
+	struct stat removed;
+	assert(stat(pch.c_str(), &removed) != 0);
+}
@@ -0,0 +1,96 @@
+#include <cassert>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Query.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+vector<string> names(const vector<Cursor> &cursors)
+{
+	vector<string> result;
+	for ( const auto &cursor : cursors ) {
+		result.push_back(cursor.spelling());
+	}
+	return result;
+}
+
+bool compiles(const string &selector)
+{
+	try {
+		Query::compile(selector);
+		return true;
+	}
+	catch ( const QuerySyntaxError & ) {
+		return false;
+	}
+}
+
+
+int main()
+{
+	assert(compiles("ClassDecl > CXXMethod[static][name^=\"get\"]"));
+	assert(compiles("CLASS_DECL *"));
+	assert(!compiles(""));
+	assert(!compiles("NoSuchKind"));
+	assert(!compiles("ClassDecl[static"));
+	assert(!compiles("ClassDecl[name~=\"x\"]"));
+	assert(Query::compile("* > FieldDecl").selector() == "* > FieldDecl");
+
+	ofstream("query.cpp") <<
+		"class Widget {\n"
+		"  static int get_count();\n"
+		"  int get_size() const;\n"
+		"  virtual void draw() = 0;\n"
+		"  int width : 4;\n"
+		"};\n"
+		"namespace ns { struct Other { static int get(); }; }\n"
+		"int global;\n"
+		"int get_free() { int local = Widget::get_count(); return local; }\n";
+	auto index = Index::create();
+	auto tu = index->parse("query.cpp");
+	const Cursor root = tu->cursor();
+
+	assert(names(Query::compile("ClassDecl > CXXMethod[static][name^=\"get\"]").match(root))
+		   == vector<string>{"get_count"});
+	assert(names(Query::compile("CXXMethod[static][name^=\"get\"]").match(root))
+		   == (vector<string>{"get_count", "get"}));
+	assert(names(Query::compile("CXXMethod[const]").match(root)) == vector<string>{"get_size"});
+	assert(names(Query::compile("CXXMethod[virtual][pure]").match(root)) == vector<string>{"draw"});
+	assert(names(Query::compile("FieldDecl[bitfield]").match(root)) == vector<string>{"width"});
+	assert(names(Query::compile("Namespace StructDecl").match(root)) == vector<string>{"Other"});
+	// function bodies are searched only when a step can match inside them
+	assert(names(Query::compile("VarDecl").match(root)) == vector<string>{"global"});
+	assert(names(Query::compile("FunctionDecl[definition] CompoundStmt VarDecl").match(root))
+		   == vector<string>{"local"});
+	assert(names(Query::compile("*[name$=\"_size\"]").match(root)) == vector<string>{"get_size"});
+	assert(Query::compile("Namespace > CXXMethod").match(root).empty());
+
+	// FriendDecl is newer than the vendored header: its subtree is searched
+	ofstream("query_friend.cpp") << "struct Host { friend int befriended(int); };\n";
+	const Cursor friend_root = index->parse("query_friend.cpp")->cursor();
+	assert(names(Query::compile("FunctionDecl").match(friend_root)) == vector<string>{"befriended"});
+	assert(names(Query::compile("StructDecl > * > FunctionDecl").match(friend_root))
+		   == vector<string>{"befriended"});
+
+	const auto per_tu = Query::compile("CXXMethod").match({tu, tu}, 2);
+	assert(per_tu.size() == 2 && per_tu[0].size() == 4 && per_tu[1].size() == 4);
+
+	// an exception thrown by the callback stops the walk and reaches the caller
+	int calls{0};
+	try {
+		Query::compile("CXXMethod").match(root, [&calls](const Cursor &) {
+				++calls;
+				throw runtime_error("stop");
+			});
+		assert(false);
+	}
+	catch ( const runtime_error &error ) {
+		assert(string(error.what()) == "stop");
+	}
+	assert(calls == 1);
+}
@@ -0,0 +1,84 @@
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/ReparseScheduler.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+vector<UnsavedFile> contents(const string &text)
+{
+	vector<UnsavedFile> unsaved_files(1);
+	unsaved_files[0].filename = "scheduler.cpp";
+	unsaved_files[0].contents.reset(new istringstream(text));
+	return unsaved_files;
+}
+
+
+int main()
+{
+	ofstream("scheduler.cpp") << "int v0;\n";
+	auto index = Index::create();
+	auto tu = index->parse("scheduler.cpp");
+
+	ReparseScheduler::Options options;
+	options.min_delay = chrono::milliseconds(20);
+	options.max_delay = chrono::milliseconds(200);
+	ReparseScheduler scheduler(tu, options);
+	assert(scheduler.ready_version() == 0 && scheduler.failed_version() == 0);
+	assert(scheduler.delay() >= options.min_delay && scheduler.delay() <= options.max_delay);
+
+	mutex mutex;
+	condition_variable called;
+	vector<ReparseScheduler::Version> reparsed;
+	scheduler.set_callback([&](ReparseScheduler::Version version, exception_ptr error) {
+			assert(!error);
+			lock_guard<std::mutex> lock(mutex);
+			reparsed.push_back(version);
+			called.notify_all();
+		});
+
+	// keystrokes faster than the delay are coalesced into few reparses
+	ReparseScheduler::Version last = 0;
+	for ( int i = 1; i <= 50; ++i ) {
+		last = scheduler.update(contents("int v" + to_string(i) + ";\n"));
+		assert(last == ReparseScheduler::Version(i));
+	}
+	assert(scheduler.wait(last) == last);
+	assert(scheduler.ready_version() == last && scheduler.failed_version() == 0);
+	scheduler.access([&](TranslationUnit &translation_unit, ReparseScheduler::Version version) {
+			assert(version == last);
+			assert(translation_unit.cursor().get_children().front().spelling() == "v50");
+		});
+
+	const auto stats = scheduler.stats();
+	assert(stats.updates == 50 && stats.failures == 0);
+	assert(stats.reparses < stats.updates && stats.superseded > 0);
+	assert(stats.reparses + stats.superseded == stats.updates);
+	{
+		// the callback runs after the version is made ready
+		unique_lock<std::mutex> lock(mutex);
+		called.wait(lock, [&] { return !reparsed.empty() && reparsed.back() == last; });
+		assert(reparsed.size() == stats.reparses);
+		for ( size_t i = 1; i < reparsed.size(); ++i ) {
+			assert(reparsed[i - 1] < reparsed[i]);
+		}
+	}
+
+	// an update arriving after the pause is reparsed on its own
+	last = scheduler.update(contents("int w;\n"));
+	assert(scheduler.wait(last) == last);
+	assert(scheduler.stats().reparses == stats.reparses + 1);
+	assert(scheduler.delay() >= options.min_delay && scheduler.delay() <= options.max_delay);
+
+	// the destructor drops a pending update instead of waiting for it
+	scheduler.update(contents("int x;\n"));
+}
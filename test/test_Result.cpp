@@ -0,0 +1,85 @@
+#include <cassert>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Result.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+
+int main()
+{
+	{
+		Result<string> value(string("abc"));
+		assert(value && value.status() == Status::OK);
+		assert(*value == "abc" && value->size() == 3);
+		assert(value.value_or("x") == "abc");
+
+		Result<string> failed(Status::NotFound);
+		assert(!failed && failed.status() == Status::NotFound);
+		assert(failed.value_or("x") == "x");
+
+		Result<string> copied(value);
+		assert(*copied == "abc" && *value == "abc");
+		Result<string> moved(std::move(copied));
+		assert(*moved == "abc");
+
+		moved = failed;
+		assert(!moved && moved.status() == Status::NotFound);
+		moved = value;
+		assert(moved && *moved == "abc");
+		moved = Result<string>(Status::NoString);
+		assert(moved.status() == Status::NoString);
+
+		Result<shared_ptr<int>> pointer(make_shared<int>(3));
+		const weak_ptr<int> watcher(*pointer);
+		pointer = Status::OutOfMemory;
+		assert(watcher.expired());
+	}
+
+	assert(string(name(Status::OK)) == "OK");
+	assert(string(name(Status::NotFound)) == "NotFound");
+	assert(string(name(Status::OutOfMemory)) == "OutOfMemory");
+
+	ofstream("result.cpp") << "int declared();\n"
+						   << "int defined(int x) { return declared() + x; }\n";
+	auto index = Index::create();
+	auto translation_unit = index->parse("result.cpp");
+	const auto root = translation_unit->cursor();
+	const auto children = root.get_children();
+	assert(children.size() == 2);
+	const Cursor &declared = children[0];
+	const Cursor &defined = children[1];
+
+	CursorKind::s_initialize();
+	assert(*declared.try_kind() == declared.kind());
+	// the spelling is memoized: the same string is returned again
+	const auto spelling = defined.try_spelling();
+	assert(spelling && **spelling == "defined");
+	assert(*defined.try_spelling() == *spelling);
+	assert(**defined.try_displayname() == "defined(int)");
+	assert(*defined.try_get_usr() == defined.get_usr());
+	assert(*defined.try_get_definition() == defined);
+	assert(*declared.try_canonical() == declared);
+	assert(*defined.try_semantic_parent() == root);
+	assert(*defined.try_lexical_parent() == root);
+
+	assert(declared.try_get_definition().status() == Status::NotFound);
+	// a missing referenced cursor is memoized too
+	const Cursor body = defined.get_children().back();
+	assert(body.try_referenced().status() == Status::NotFound);
+	assert(body.try_referenced().status() == Status::NotFound);
+
+	const Cursor null = declared.get_definition();
+	assert(!null);
+	assert(null.try_spelling().status() == Status::Null);
+	assert(null.try_displayname().status() == Status::Null);
+	assert(null.try_get_usr().status() == Status::Null);
+	assert(null.try_get_definition().status() == Status::Null);
+	assert(null.try_canonical().status() == Status::Null);
+	assert(null.try_semantic_parent().status() == Status::Null);
+	assert(null.try_lexical_parent().status() == Status::Null);
+	assert(null.try_referenced().status() == Status::Null);
+}
@@ -0,0 +1,51 @@
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Query.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+Cursor find(const TranslationUnit &tu, const string &selector)
+{
+	const auto cursors = Query::compile(selector).match(tu.cursor());
+	assert(cursors.size() == 1);
+	return cursors.front();
+}
+
+
+int main()
+{
+	ofstream("scope_names.cpp") <<
+		"void f();\n"
+		"namespace a {\n"
+		"  namespace { struct S { void m(); }; }\n"
+		"  struct T { void n(); };\n"
+		"}\n"
+		"void a::T::n() { }\n";
+	auto index = Index::create();
+	auto tu = index->parse("scope_names.cpp");
+
+	const Cursor f = find(*tu, "FunctionDecl[name=\"f\"]");
+	assert(f.qualified_name() == "f");
+	assert(f.scope_path().empty());
+
+	const Cursor m = find(*tu, "CXXMethod[name=\"m\"]");
+	assert(m.qualified_name() == "a::(anonymous namespace)::S::m");
+	assert(m.scope_path() == (vector<string>{"a", "(anonymous namespace)", "S"}));
+
+	// the out-of-line definition is named after its semantic parent
+	const Cursor n = find(*tu, "CXXMethod[name=\"n\"][definition]");
+	assert(n.qualified_name() == "a::T::n");
+	assert(n.scope_path() == (vector<string>{"a", "T"}));
+
+	// a null cursor has no name
+	const Cursor null = f.get_definition();
+	assert(null.qualified_name().empty());
+	assert(null.scope_path().empty());
+
+	tu->reparse();
+	assert(find(*tu, "CXXMethod[name=\"m\"]").qualified_name() == "a::(anonymous namespace)::S::m");
+}
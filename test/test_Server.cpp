@@ -0,0 +1,100 @@
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "clang-cpp/Client.hpp"
+#include "clang-cpp/Exception.hpp"
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Server.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+bool fails(const function<void()> &request)
+{
+	try {
+		request();
+		return false;
+	}
+	catch ( const RuntimeError & ) {
+		return true;
+	}
+}
+
+
+int main()
+{
+	ofstream("server_a.cpp") <<
+		"int add(int a, int b) { return a + b; }\n"
+		"int main() { return add(1, 2) + add(3, 4); }\n";
+	ofstream("server_b.cpp") << "int b;\n";
+	ofstream("server_c.cpp") << "int c;\n";
+
+	Server server("server.sock", Index::create(), 2, 2);
+	server.start();
+	{
+		Client client("server.sock");
+		client.parse("server_a.cpp");
+		assert(server.translation_unit_count() == 1);
+
+		const auto info = client.cursor_at("server_a.cpp", "", 2, 21);
+		assert(info.kind == "DeclRefExpr" && info.spelling == "add");
+		assert(info.referenced_usr == "c:@F@add#I#I#");
+		assert(info.definition.line == 1 && info.definition.column == 5);
+
+		const auto references = client.references("server_a.cpp", "c:@F@add#I#I#");
+		assert(references.size() >= 2);
+
+		const auto completions = client.complete("server_a.cpp", 2, 14);
+		bool has_add = false;
+		for ( const auto &completion : completions ) {
+			has_add = has_add || completion.typed_text == "add";
+		}
+		assert(has_add);
+
+		// a reparse sees the unsaved contents
+		client.reparse("server_a.cpp", {{"server_a.cpp", "int sub(int a, int b) { return a - b; }\n"}});
+		assert(client.cursor_at("server_a.cpp", "", 1, 5).spelling == "sub");
+
+		// requests from several clients at once
+		vector<thread> threads;
+		for ( int i = 0; i < 4; ++i ) {
+			threads.emplace_back([] {
+					Client other("server.sock");
+					for ( int j = 0; j < 10; ++j ) {
+						other.reparse("server_a.cpp");
+					}
+				});
+		}
+		for ( auto &thread : threads ) {
+			thread.join();
+		}
+
+		// above the limit, the least recently used idle translation unit is
+		// dropped; give the workers time to finish after their replies
+		client.parse("server_b.cpp");
+		this_thread::sleep_for(chrono::milliseconds(100));
+		client.parse("server_c.cpp");
+		assert(server.translation_unit_count() == 2);
+		assert(fails([&] { client.cursor_at("server_a.cpp", "", 1, 5); }));
+		assert(client.cursor_at("server_c.cpp", "", 1, 5).spelling == "c");
+
+		// requests for unknown files and failed parses keep no session, so
+		// they evict no parsed translation unit
+		assert(fails([&] { client.cursor_at("not_parsed.cpp", "", 1, 1); }));
+		assert(fails([&] { client.reparse("not_parsed.cpp"); }));
+		assert(fails([&] { client.parse("no_such_file.cpp"); }));
+		assert(server.translation_unit_count() == 2);
+		assert(client.cursor_at("server_b.cpp", "", 1, 5).spelling == "b");
+		assert(client.cursor_at("server_c.cpp", "", 1, 5).spelling == "c");
+	}
+
+	// closed connections do not keep the server from stopping
+	for ( int i = 0; i < 20; ++i ) {
+		Client("server.sock").parse("server_b.cpp");
+	}
+	server.stop();
+}
@@ -0,0 +1,81 @@
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "clang-cpp/ServerProtocol.hpp"
+
+using namespace clangxx;
+using namespace clangxx::protocol;
+using namespace std;
+
+bool decodes(const string &data)
+{
+	try {
+		Decoder decoder(data.data(), data.size());
+		decoder.get_strings();
+		return true;
+	}
+	catch ( const runtime_error & ) {
+		return false;
+	}
+}
+
+
+int main()
+{
+	Encoder encoder;
+	encoder.put(uint8_t(7));
+	encoder.put(uint32_t(0xdeadbeef));
+	encoder.put(string("hello"));
+	encoder.put(vector<string>{"-std=c++11", "", "-DX"});
+	encoder.put(UnsavedContents{{"a.cpp", "int a;"}});
+	Location location;
+	location.filename = "b.h";
+	location.line = 3;
+	location.column = 14;
+	encoder.put(location);
+
+	Decoder decoder(encoder.data().data(), encoder.data().size());
+	assert(decoder.get_u8() == 7);
+	assert(decoder.get_u32() == 0xdeadbeef);
+	assert(decoder.get_string() == "hello");
+	assert(decoder.get_strings() == (vector<string>{"-std=c++11", "", "-DX"}));
+	const auto unsaved = decoder.get_unsaved();
+	assert(unsaved.size() == 1 && unsaved[0].first == "a.cpp" && unsaved[0].second == "int a;");
+	const Location decoded = decoder.get_location();
+	assert(decoded.filename == "b.h" && decoded.line == 3 && decoded.column == 14);
+	try {
+		decoder.get_u8();
+		assert(false);
+	}
+	catch ( const runtime_error & ) {
+	}
+
+	// truncated payloads and huge counts are rejected before allocating
+	Encoder strings;
+	strings.put(vector<string>{"abc", "def"});
+	for ( size_t size = 0; size < strings.data().size(); ++size ) {
+		assert(!decodes(strings.data().substr(0, size)));
+	}
+	assert(decodes(strings.data()));
+	Encoder huge;
+	huge.put(uint32_t(0xffffffff));
+	assert(!decodes(huge.data()));
+
+	int descriptors[2];
+	assert(socketpair(AF_UNIX, SOCK_STREAM, 0, descriptors) == 0);
+	write_frame(descriptors[0], MessageType::Parse, 42, encoder.data());
+	write_frame(descriptors[0], MessageType::Reply, 43, string());
+	close(descriptors[0]);
+	FrameHeader header;
+	string payload;
+	assert(read_frame(descriptors[1], header, payload));
+	assert(header.type == MessageType::Parse && header.request_id == 42 && payload == encoder.data());
+	assert(read_frame(descriptors[1], header, payload));
+	assert(header.type == MessageType::Reply && header.request_id == 43 && payload.empty());
+	assert(!read_frame(descriptors[1], header, payload));
+	close(descriptors[1]);
+}
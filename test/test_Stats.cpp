@@ -0,0 +1,86 @@
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Stats.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+const string inputs_dir("../vendor/clang/bindings/python/tests/cindex/INPUTS");
+
+const stats::Entry &entry(const vector<stats::Entry> &entries, stats::Counter counter)
+{
+	return entries[static_cast<size_t>(counter)];
+}
+
+uint64_t histogram_total(const stats::Entry &entry)
+{
+	uint64_t total = 0;
+	for ( auto bucket : entry.histogram ) {
+		total += bucket;
+	}
+	return total;
+}
+
+
+int main()
+{
+	assert(string(stats::name(stats::Counter::Cursor_spelling)) == "Cursor::spelling");
+	assert(string(stats::name(stats::Counter::TranslationUnit_save)) == "TranslationUnit::save");
+	assert(string(stats::name(stats::Counter::count)) == "");
+
+	if ( !stats::enabled() ) {
+		stats::detail::record_call(stats::Counter::Cursor_spelling, 100);
+		assert(stats::snapshot().empty());
+		ostringstream ostream;
+		stats::write(ostream);
+		assert(ostream.str().find("Cursor::spelling") == string::npos);
+		return 0;
+	}
+
+	auto entries = stats::snapshot();
+	assert(entries.size() == static_cast<size_t>(stats::Counter::count));
+	for ( size_t i = 0; i < entries.size(); ++i ) {
+		assert(string(entries[i].name) == stats::name(static_cast<stats::Counter>(i)));
+	}
+
+	// the calls and their latencies are summed over the threads
+	stats::reset();
+	stats::detail::record_call(stats::Counter::File_name, 0);
+	stats::detail::record_call(stats::Counter::File_name, 5);
+	thread([] { stats::detail::record_call(stats::Counter::File_name, 1000); }).join();
+	stats::detail::record_memo(stats::Counter::File_name, true);
+	stats::detail::record_memo(stats::Counter::File_name, false);
+	stats::detail::record_memo(stats::Counter::File_name, false);
+	entries = stats::snapshot();
+	const auto &file_name = entry(entries, stats::Counter::File_name);
+	assert(file_name.calls == 3);
+	assert(file_name.total_nanoseconds == 1005);
+	assert(file_name.hits == 1 && file_name.misses == 2);
+	assert(file_name.histogram[0] == 1);	// 0
+	assert(file_name.histogram[2] == 1);	// [4, 8)
+	assert(file_name.histogram[9] == 1);	// [512, 1024)
+	assert(histogram_total(file_name) == 3);
+
+	ostringstream ostream;
+	stats::write(ostream);
+	assert(ostream.str().find("File::name") != string::npos);
+	assert(ostream.str().find("File::time") == string::npos);
+
+	// a memoized spelling is a miss, then a hit
+	stats::reset();
+	assert(entry(stats::snapshot(), stats::Counter::File_name).calls == 0);
+	auto index = Index::create();
+	auto translation_unit = index->parse(inputs_dir + "/hello.cpp");
+	auto cursor = translation_unit->cursor().get_children().back();
+	cursor.spelling();
+	cursor.spelling();
+	entries = stats::snapshot();
+	const auto &spelling = entry(entries, stats::Counter::Cursor_spelling);
+	assert(spelling.calls == 2 && spelling.misses == 1 && spelling.hits == 1);
+	assert(histogram_total(spelling) == 2);
+	assert(entry(entries, stats::Counter::TranslationUnit_from_source).calls == 1);
+	assert(entry(entries, stats::Counter::Cursor_get_children).calls == 1);
+}
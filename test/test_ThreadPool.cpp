@@ -0,0 +1,50 @@
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <thread>
+#include "clang-cpp/ThreadPool.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+
+int main()
+{
+	atomic<int> count{0};
+	{
+		ThreadPool pool(4);
+		assert(pool.thread_count() == 4);
+		for ( int i = 0; i < 1000; ++i ) {
+			pool.submit([&count] { ++count; });
+		}
+		pool.wait_idle();
+		assert(count == 1000);
+
+		// an escaping exception is discarded; the worker keeps running
+		pool.submit([] { throw runtime_error("lost"); });
+		pool.submit([&count] { ++count; });
+		pool.wait_idle();
+		assert(count == 1001);
+
+		// the destructor runs the tasks still queued
+		for ( int i = 0; i < 100; ++i ) {
+			pool.submit([&count] {
+					this_thread::yield();
+					++count;
+				});
+		}
+	}
+	assert(count == 1101);
+
+	ThreadPool single(1);
+	int order = 0;
+	for ( int i = 0; i < 100; ++i ) {
+		single.submit([&order, i] {
+				assert(order == i);
+				++order;
+			});
+	}
+	single.wait_idle();
+	assert(order == 100);
+	assert(ThreadPool().thread_count() > 0);
+}
@@ -0,0 +1,68 @@
+#include <cassert>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Trace.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+const string inputs_dir("../vendor/clang/bindings/python/tests/cindex/INPUTS");
+
+string written()
+{
+	ostringstream ostream;
+	trace::write(ostream);
+	return ostream.str();
+}
+
+size_t count(const string &text, const string &pattern)
+{
+	size_t result = 0;
+	for ( auto found = text.find(pattern); found != string::npos; found = text.find(pattern, found + 1) ) {
+		++result;
+	}
+	return result;
+}
+
+
+int main()
+{
+	assert(!trace::enabled());
+	{
+		trace::Span span("test", "disabled");
+		assert(!span);
+	}
+	assert(written().find("disabled") == string::npos);
+
+	trace::enable();
+	assert(trace::enabled());
+	{
+		trace::Span outer("test", "outer", "a\"b\\c\n.cpp");
+		assert(outer);
+		trace::Span inner("test", "inner");
+		inner.set_argument("argument");
+	}
+	thread([] { trace::Span span("test", "other_thread"); }).join();
+	auto index = Index::create();
+	index->parse(inputs_dir + "/hello.cpp")->cursor().get_children();
+	trace::enable(false);
+
+	const string json = written();
+	assert(json.compare(0, 1, "{") == 0 && json.find("\"traceEvents\":[") != string::npos);
+	assert(count(json, "\"ph\":\"X\"") >= 4);
+	assert(json.find("\"name\":\"outer\",") != string::npos);
+	// arguments are escaped
+	assert(json.find("\"args\":{\"name\":\"a\\\"b\\\\c\\u000a.cpp\"}") != string::npos);
+	assert(json.find("\"args\":{\"name\":\"argument\"}") != string::npos);
+	// one thread_name record per thread
+	assert(count(json, "\"thread_name\"") == 2);
+	// the library traces its own phases
+	assert(json.find("\"cat\":\"parse\"") != string::npos);
+	assert(json.find("\"name\":\"get_children\"") != string::npos);
+
+	trace::clear();
+	assert(written().find("\"ph\":\"X\"") == string::npos);
+	trace::write("trace.json");
+}
@@ -0,0 +1,52 @@
+#include <cassert>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/VirtualFileSystem.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+
+int main()
+{
+	char cwd[4096];
+	assert(getcwd(cwd, sizeof(cwd)));
+	const string real_header(string(cwd) + "/vfs_real.h");
+	ofstream(real_header) << "int vfs_value();\n";
+
+	VirtualFileSystem vfs;
+	assert(vfs.arguments().empty());
+	vfs.map_file("/virtual/include/vfs.h", real_header);
+	vfs.add_file("/virtual/main.cpp",
+				 "#include \"/virtual/include/vfs.h\"\n"
+				 "int main() { return vfs_value(); }\n");
+	assert(vfs.yaml().find("/virtual/include") != string::npos);
+	assert(vfs.unsaved_files().size() == 1);
+
+	const auto args = vfs.arguments();
+	assert(!args.empty());
+	// an in-memory overlay is not inherited by child processes
+	const string fd_prefix("/proc/self/fd/");
+	if ( args.back().compare(0, fd_prefix.size(), fd_prefix) == 0 ) {
+		const int descriptor = stoi(args.back().substr(fd_prefix.size()));
+		assert(fcntl(descriptor, F_GETFD) & FD_CLOEXEC);
+	}
+	const auto unsaved_files = vfs.unsaved_files();
+	auto index = Index::create();
+	auto tu = index->parse("/virtual/main.cpp", &args, &unsaved_files);
+	vector<string> names;
+	for ( const auto &cursor : tu->cursor().get_children() ) {
+		names.push_back(cursor.spelling());
+	}
+	assert(names == (vector<string>{"vfs_value", "main"}));
+
+	// the overlay stays usable after the object is moved
+	VirtualFileSystem moved(std::move(vfs));
+	const auto moved_unsaved_files = moved.unsaved_files();
+	tu->reparse(&moved_unsaved_files);
+	assert(tu->cursor().get_children().size() == 2);
+}
@@ -0,0 +1,94 @@
+#include <cassert>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include "clang-cpp/Index.hpp"
+#include "clang-cpp/Watcher.hpp"
+
+using namespace clangxx;
+using namespace std;
+
+mutex reparses_mutex;
+map<const TranslationUnit *, int> reparses;
+
+int reparses_of(const shared_ptr<TranslationUnit> &tu)
+{
+	lock_guard<mutex> lock(reparses_mutex);
+	return reparses[tu.get()];
+}
+
+
+int main()
+{
+	mkdir("watched", 0755);
+	ofstream("watched/dep.h") << "int dep();\n";
+	ofstream("watched/new.h") << "int added();\n";
+	ofstream("watched/main.cpp") << "#include \"dep.h\"\n";
+	ofstream("watched/other.cpp") << "int other();\n";
+	auto index = Index::create();
+	auto main_tu = index->parse("watched/main.cpp");
+	auto other_tu = index->parse("watched/other.cpp");
+
+	Watcher::Options options;
+	options.debounce = chrono::milliseconds(50);
+	options.max_delay = chrono::milliseconds(1000);
+	options.thread_count = 2;
+	Watcher watcher(options);
+	watcher.watch(main_tu);
+	watcher.watch(other_tu);
+	watcher.watch(other_tu);
+	assert(watcher.watched_count() == 2);
+	watcher.set_callback([](const shared_ptr<TranslationUnit> &tu, exception_ptr error) {
+			assert(!error);
+			lock_guard<mutex> lock(reparses_mutex);
+			++reparses[tu.get()];
+		});
+	watcher.start();
+
+	// a burst of changes reparses each dependent translation unit once
+	for ( int i = 0; i < 20; ++i ) {
+		watcher.notify("watched/dep.h");
+		watcher.notify("./watched/../watched/dep.h");
+	}
+	watcher.wait_idle();
+	assert(reparses_of(main_tu) == 1 && reparses_of(other_tu) == 0);
+
+	watcher.notify("watched/unrelated.h");
+	watcher.wait_idle();
+	assert(reparses_of(main_tu) == 1 && reparses_of(other_tu) == 0);
+
+	// the dependencies follow the sources after a reparse
+	ofstream("watched/main.cpp") << "#include \"new.h\"\n";
+	watcher.notify("watched/main.cpp");
+	watcher.wait_idle();
+	assert(reparses_of(main_tu) == 2);
+	watcher.notify("watched/dep.h");
+	watcher.wait_idle();
+	assert(reparses_of(main_tu) == 2);
+	watcher.notify("watched/new.h");
+	watcher.wait_idle();
+	assert(reparses_of(main_tu) == 3);
+
+	watcher.unwatch(other_tu);
+	assert(watcher.watched_count() == 1);
+	watcher.notify("watched/other.cpp");
+	watcher.wait_idle();
+	assert(reparses_of(other_tu) == 0);
+
+#if defined __linux__
+	// a directory added after start() is watched too
+	watcher.add_directory("watched", false);
+	ofstream("watched/new.h") << "int added(int);\n";
+	for ( int i = 0; i < 500 && reparses_of(main_tu) < 4; ++i ) {
+		this_thread::sleep_for(chrono::milliseconds(10));
+	}
+	assert(reparses_of(main_tu) == 4);
+#endif
+	watcher.stop();
+}